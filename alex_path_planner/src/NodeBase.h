@@ -44,6 +44,9 @@ public:
         nh_private.param<std::string>("map_frame", m_map_frame, "map");
 
         m_TrajectoryDisplayer = TrajectoryDisplayerHelper(m_node_handle, &m_display_pub, m_CoordinateConverter, m_map_frame);
+        double displayTolerance;
+        nh_private.param("display_tolerance", displayTolerance, 0.5);
+        m_TrajectoryDisplayer.setTolerance(displayTolerance);
         
 
     }
@@ -98,15 +101,21 @@ public:
 
         geographic_visualization_msgs::GeoVizItem geoVizItem;
 
+        // convert all the ends in one go
+        std::vector<State> ends;
         for (const auto& r : ribbonManager.get()) {
+            ends.push_back(r.startAsState());
+            ends.push_back(r.endAsState());
+        }
+        auto points = m_TrajectoryDisplayer.convertToLatLong(ends);
+        for (size_t i = 0; i + 1 < points.size(); i += 2) {
             geographic_visualization_msgs::GeoVizPointList displayPoints;
             displayPoints.color.r = 1;
             displayPoints.color.b = 0.5;
             displayPoints.color.a = 0.6;
             displayPoints.size = 15;
-            geographic_msgs::GeoPoint point;
-            displayPoints.points.push_back(convertToLatLong(r.startAsState()));
-            displayPoints.points.push_back(convertToLatLong(r.endAsState()));
+            displayPoints.points.push_back(points[i]);
+            displayPoints.points.push_back(points[i + 1]);
             geoVizItem.lines.push_back(displayPoints);
         }
         geoVizItem.id = "ribbons";
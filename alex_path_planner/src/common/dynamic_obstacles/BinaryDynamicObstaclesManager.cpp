@@ -1,5 +1,6 @@
 #include <tuple>        // std::forward_as_tuple
 #include "BinaryDynamicObstaclesManager.h"
+#include <cfloat>
 
 double BinaryDynamicObstaclesManager::collisionExists(double x, double y, double time, bool strict) const {
     double sum = 0;
@@ -21,6 +22,21 @@ double BinaryDynamicObstaclesManager::collisionExists(double x, double y, double
     return sum;
 }
 
+double BinaryDynamicObstaclesManager::timeToPossibleCollision(double x, double y, double time, double speed) const {
+    double min = DBL_MAX;
+    for (auto o : m_Obstacles) {
+        auto& obstacle = o.second;
+        obstacle.project(time);
+        // anything outside the circle around the (strict) rectangle is clear, and we can close on it no faster than
+        // both speeds combined
+        auto radius = sqrt((obstacle.Length + 2) * (obstacle.Length + 2) + (obstacle.Width + 2) * (obstacle.Width + 2)) / 2;
+        auto distance = sqrt((x - obstacle.X) * (x - obstacle.X) + (y - obstacle.Y) * (y - obstacle.Y));
+        auto gap = fmax(distance - radius, 0), closingSpeed = speed + fabs(obstacle.Speed);
+        min = fmin(min, gap == 0? 0 : closingSpeed > 0? gap / closingSpeed : DBL_MAX);
+    }
+    return min;
+}
+
 void BinaryDynamicObstaclesManager::update(uint32_t mmsi, double x, double y, double heading, double speed, double time,
         double width, double length) {
     if (!isIgnored(mmsi)) {
@@ -31,11 +47,12 @@ void BinaryDynamicObstaclesManager::update(uint32_t mmsi, double x, double y, do
         if (!result.second) {
             result.first->second = Obstacle(x, y, heading, speed, time, width, length);
         }
+        bumpVersion();
     }
 }
 
 void BinaryDynamicObstaclesManager::forget(uint32_t mmsi) {
-    m_Obstacles.erase(mmsi);
+    if (m_Obstacles.erase(mmsi)) bumpVersion();
 }
 
 const std::unordered_map<uint32_t, BinaryDynamicObstaclesManager::Obstacle>& BinaryDynamicObstaclesManager::get() const {
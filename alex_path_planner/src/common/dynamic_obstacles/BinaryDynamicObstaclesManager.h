@@ -32,6 +32,8 @@ public:
 
     double collisionExists(double x, double y, double time, bool strict) const override;
 
+    double timeToPossibleCollision(double x, double y, double time, double speed) const override;
+
     const std::unordered_map<uint32_t, Obstacle>& get() const;
 
 private:
@@ -63,4 +63,12 @@ double Distribution::density(double x, double y) const {
 
 double Distribution::heading() const {
     return m_Heading;
+}
+
+double Distribution::width() const {
+    return m_Width;
+}
+
+double Distribution::length() const {
+    return m_Length;
 }
\ No newline at end of file
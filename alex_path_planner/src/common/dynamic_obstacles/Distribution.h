@@ -47,6 +47,10 @@ public:
 
     double time() const;
 
+    double width() const;
+
+    double length() const;
+
     const double (&mean() const) [2];
 
 private:
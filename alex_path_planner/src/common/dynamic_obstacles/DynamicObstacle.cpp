@@ -1,3 +1,5 @@
+#include <stdexcept>
+#include <algorithm>
 #include "DynamicObstacle.h"
 
 double DynamicObstacle::distanceToEdge(double x, double y, double speed, double time) const {
@@ -6,39 +8,83 @@ double DynamicObstacle::distanceToEdge(double x, double y, double speed, double
 }
 
 double DynamicObstacle::collisionDensityAt(double x, double y, double time) const {
-    // find the highest time lower than the desired time with a binary search
-    unsigned long lower = 0, upper = m_Distributions.size() - 1;
-    auto i = upper / 2;
-    while (lower + 1 < upper){
-        if (m_Distributions[i].time() <= time) {
-            lower = i;
-        } else {
-            upper = i;
+    if (m_Times.empty()) return 0;
+    auto i = intervalAt(time);
+    auto dt = time - m_Times[i];
+    double meanX = m_MeanX[i], meanY = m_MeanY[i], heading = m_Heading[i];
+    if (std::isnan(m_SlopeX[i])) {
+        if (dt != 0) {
+            throw std::logic_error("Cannot interpolate between or extrapolate from two distributions with the same time stamp");
         }
-        i = (lower + upper) / 2;
+    } else {
+        meanX += m_SlopeX[i] * dt;
+        meanY += m_SlopeY[i] * dt;
+        heading += m_HeadingRate[i] * dt;
+    }
+    // same footprint test as Distribution::density
+    auto theta = M_PI_2 - heading;
+    auto c = cos(theta), s = sin(theta);
+    auto translatedX = x - meanX;
+    auto translatedY = y - meanY;
+    auto rotatedX = translatedX * c - translatedY * s;
+    auto rotatedY = translatedX * s + translatedY * c;
+    if (fabs(rotatedX) < m_HalfWidth[i] && fabs(rotatedY) < m_HalfLength[i]) return 1;
+    else return 0;
+}
+
+unsigned long DynamicObstacle::intervalAt(double time) const {
+    if (m_Times.size() < 2 || time < m_Times[0]) return 0;
+    auto last = m_Times.size() - 2;
+    auto bucket = (unsigned long)std::min((time - m_Times[0]) / m_BucketWidth, (double)(m_Buckets.size() - 1));
+    auto i = m_Buckets[bucket];
+    // buckets are no wider than the shortest interval so this is at most a step or two (unless we capped the buckets)
+    while (i < last && m_Times[i + 1] <= time) i++;
+    // in case rounding put us in the next bucket over
+    while (i > 0 && m_Times[i] > time) i--;
+    return i;
+}
+
+void DynamicObstacle::index(const std::vector<Distribution>& distributions) {
+    auto n = distributions.size();
+    for (auto v : {&m_Times, &m_MeanX, &m_MeanY, &m_Heading, &m_SlopeX, &m_SlopeY, &m_HeadingRate, &m_HalfWidth,
+                   &m_HalfLength}) {
+        v->resize(n);
+    }
+    double shortest = 0;
+    for (unsigned long i = 0; i < n; i++) {
+        const auto& d = distributions[i];
+        m_Times[i] = d.time();
+        m_MeanX[i] = d.mean()[0];
+        m_MeanY[i] = d.mean()[1];
+        m_Heading[i] = d.heading();
+        m_HalfWidth[i] = d.width() / 2;
+        m_HalfLength[i] = d.length() / 2;
+        m_SlopeX[i] = m_SlopeY[i] = m_HeadingRate[i] = NAN;
+        if (i == 0) continue;
+        auto timeDiff = m_Times[i] - m_Times[i - 1];
+        if (timeDiff == 0) continue;
+        m_SlopeX[i - 1] = (m_MeanX[i] - m_MeanX[i - 1]) / timeDiff;
+        m_SlopeY[i - 1] = (m_MeanY[i] - m_MeanY[i - 1]) / timeDiff;
+        m_HeadingRate[i - 1] = (m_Heading[i] - m_Heading[i - 1]) / timeDiff;
+        if (timeDiff > 0 && (shortest == 0 || timeDiff < shortest)) shortest = timeDiff;
+    }
+
+    m_Buckets.clear();
+    if (n < 2 || shortest == 0) {
+        m_Buckets.push_back(0);
+        m_BucketWidth = 1;
+        return;
+    }
+    auto span = m_Times[n - 1] - m_Times[0];
+    m_BucketWidth = std::max(shortest, span / (c_MaxBuckets - 1));
+    auto count = (unsigned long)(span / m_BucketWidth) + 1;
+    m_Buckets.resize(count);
+    unsigned long i = 0;
+    for (unsigned long b = 0; b < count; b++) {
+        auto t = m_Times[0] + b * m_BucketWidth;
+        while (i < n - 2 && m_Times[i + 1] <= t) i++;
+        m_Buckets[b] = i;
     }
-    auto interpolated = m_Distributions[lower].interpolate(m_Distributions[upper], time);
-    // could this all be done any faster?
-    // calculate the distance from the test point to the mean
-//    auto dx = x - interpolated.mean()[0];
-//    auto dy = y - interpolated.mean()[1];
-//    auto d = sqrt(dx*dx + dy*dy);
-//    // convert the distance to be in terms of our length and width (because we're rotated by our heading)
-//    auto beta = atan2(dy, dx);
-//    auto alpha = beta + interpolated.heading(); // I think this is right because we're using heading not yaw
-//    auto dl = d * sin(alpha);
-//    auto dw = d * cos(alpha);
-//    // check if the test point is inside our rectangle
-//    if (dl < m_Length / 2 && dw < m_Width / 2) {
-//        return interpolated.density(interpolated.mean()); // it is, so just return the density at the mean
-//    }
-//    // move us toward the mean of the distribution by an amount dictated by our size and orientation
-//    auto dInner = m_Length / (2 * sin(alpha));
-//    x -= dInner * cos(beta);
-//    y -= dInner * sin(beta);
-
-    // return the density at the translated test point
-    return interpolated.density(x, y);
 }
 
 DynamicObstacle::DynamicObstacle(const std::vector<Distribution>& distributions)
@@ -47,9 +93,9 @@ DynamicObstacle::DynamicObstacle(const std::vector<Distribution>& distributions)
 DynamicObstacle::DynamicObstacle(const std::vector<Distribution>& distributions, double length, double width) {
     m_Length = length;
     m_Width = width;
-    m_Distributions = distributions;
+    index(distributions);
 }
 
 void DynamicObstacle::update(const std::vector<Distribution>& distributions) {
-    m_Distributions = distributions;
+    index(distributions);
 }
@@ -8,6 +8,10 @@
 /**
  * Models information about a dynamic obstacle. Specifically it holds a time series of distributions describing the
  * obstacle's position and heading.
+ *
+ * The distributions are unpacked into columns when they're set, along with the interpolation slopes for each interval
+ * and a table of uniform time buckets, so a query is a bucket lookup and some arithmetic instead of a binary search
+ * and building an interpolated Distribution.
  */
 class DynamicObstacle {
 public:
@@ -52,9 +56,35 @@ public:
     double collisionDensityAt(double x, double y, double time) const;
 
 private:
-    std::vector<Distribution> m_Distributions;
+    // the track, one entry per distribution. Interval i runs from m_Times[i] to m_Times[i + 1], and the slopes
+    // (per second) at i are for that interval, so the last ones are unused unless there's only one distribution.
+    // Slopes are NaN for intervals of zero length.
+    std::vector<double> m_Times, m_MeanX, m_MeanY, m_Heading;
+    std::vector<double> m_SlopeX, m_SlopeY, m_HeadingRate;
+    std::vector<double> m_HalfWidth, m_HalfLength;
+
+    // m_Buckets[b] is the interval in effect at m_Times[0] + b * m_BucketWidth
+    std::vector<unsigned long> m_Buckets;
+    double m_BucketWidth = 1;
+
     double m_Length, m_Width;
 
+    static constexpr unsigned long c_MaxBuckets = 4096;
+
+    /**
+     * Unpack the distributions into the columns and build the bucket table.
+     * @param distributions sorted by time
+     */
+    void index(const std::vector<Distribution>& distributions);
+
+    /**
+     * Find the interval to interpolate (or extrapolate) in for the given time. This is the last one starting at or
+     * before the time, or the first one if the time is before the track starts.
+     * @param time
+     * @return
+     */
+    unsigned long intervalAt(double time) const;
+
     static constexpr double c_DefaultWidth = 3, c_DefaultLength = 3;
 
 };
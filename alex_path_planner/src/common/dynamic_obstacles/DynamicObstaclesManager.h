@@ -2,6 +2,8 @@
 #define SRC_DYNAMICOBSTACLESMANAGER_H
 
 #include <memory>
+#include <cfloat>
+#include <cmath>
 #include <alex_path_planner_common/State.h>
 
 /**
@@ -27,6 +29,66 @@ public:
         return collisionExists(s.x(), s.y(), s.time(), strict);
     };
 
+    /**
+     * Integrate collisionExists (strict) over time for something moving at constant velocity from (x, y) at time t0
+     * until t1. By default this is done with Gauss-Legendre quadrature, which only suits smooth penalties (see
+     * smoothPenalty), but managers that can do better should.
+     * @param x
+     * @param y
+     * @param vx
+     * @param vy
+     * @param t0
+     * @param t1
+     * @return time integral of collisionExists
+     */
+    virtual double integratedCollisionExists(double x, double y, double vx, double vy, double t0, double t1) const {
+        // three point rule on pieces of about a second
+        static const double nodes[3] = {-0.7745966692414834, 0, 0.7745966692414834};
+        static const double weights[3] = {5.0 / 9, 8.0 / 9, 5.0 / 9};
+        int pieces = (int)std::ceil(t1 - t0);
+        double sum = 0;
+        for (int i = 0; i < pieces; i++) {
+            double a = t0 + (t1 - t0) * i / pieces, b = t0 + (t1 - t0) * (i + 1) / pieces;
+            for (int j = 0; j < 3; j++) {
+                double t = (a + b) / 2 + nodes[j] * (b - a) / 2;
+                sum += weights[j] * (b - a) / 2 * collisionExists(x + vx * (t - t0), y + vy * (t - t0), t, true);
+            }
+        }
+        return sum;
+    }
+
+    /**
+     * Whether collisionExists changes smoothly enough for the planner to integrate it along edges (see
+     * integratedCollisionExists) rather than sample it every collision checking increment. Managers that switch the
+     * penalty on and off inside boxes shouldn't, as quadrature points a good fraction of a second apart step right over
+     * a quick crossing.
+     * @return
+     */
+    virtual bool smoothPenalty() const { return false; }
+
+    /**
+     * Conservative bound on how long until something moving no faster than the given speed, starting at (x, y) at the
+     * given time, could possibly get a non-zero result from collisionExists. Callers can skip checking until then.
+     * @param x
+     * @param y
+     * @param time
+     * @param speed
+     * @return time (s) until a collision is possible, or DBL_MAX if it never is
+     */
+    virtual double timeToPossibleCollision(double x, double y, double time, double speed) const { return DBL_MAX; }
+
+    // convenience overload
+    double timeToPossibleCollision(const State& s) const {
+        return timeToPossibleCollision(s.x(), s.y(), s.time(), s.speed());
+    }
+
+    /**
+     * Identifies the current set of obstacles. This changes whenever an obstacle is added, updated or forgotten, so
+     * penalties computed against one version can be re-used as long as it stays the same.
+     * @return
+     */
+    virtual unsigned long version() const { return 0; }
+
 
 };
 
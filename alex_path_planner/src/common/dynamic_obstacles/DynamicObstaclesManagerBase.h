@@ -23,11 +23,19 @@ public:
         m_Ignored.erase(mmsi);
     };
 
+    unsigned long version() const override { return m_Version; }
+
 protected:
     bool isIgnored(uint32_t mmsi) { return m_Ignored.find(mmsi) != m_Ignored.end(); }
 
+    /**
+     * Call this whenever the obstacles change.
+     */
+    void bumpVersion() { m_Version++; }
+
 private:
     std::unordered_set<uint32_t> m_Ignored;
+    unsigned long m_Version = 1;
 };
 
 #endif //SRC_DYNAMICOBSTACLESMANAGERBASE_H
@@ -0,0 +1,57 @@
+#include "FleetObstaclesManager.h"
+
+std::atomic<unsigned long> FleetObstaclesManager::s_NextVersion(1);
+
+FleetObstaclesManager::FleetObstaclesManager(const DynamicObstaclesManager& obstacles,
+                                             const std::vector<Vessel>& vessels) : m_Obstacles(obstacles) {
+    for (const auto& vessel : vessels) {
+        if (vessel.Plan.empty()) continue;
+        Track track;
+        track.Samples = vessel.Plan.getHalfSecondSamples();
+        if (track.Samples.empty()) continue;
+        track.Width = vessel.Width;
+        track.Length = vessel.Length;
+        for (const auto& s : track.Samples) track.MaxSpeed = fmax(track.MaxSpeed, s.speed());
+        m_Tracks.push_back(std::move(track));
+    }
+}
+
+double FleetObstaclesManager::collisionExists(double x, double y, double time, bool strict) const {
+    double sum = m_Obstacles.collisionExists(x, y, time, strict);
+    for (const auto& track : m_Tracks) {
+        const auto& s = track.at(time);
+        auto width = track.Width, length = track.Length;
+        if (strict) {
+            width += 2;
+            length += 2;
+        }
+        // into the vessel's frame
+        auto dx = x - s.x(), dy = y - s.y(), yaw = s.yaw();
+        auto along = dx * cos(yaw) + dy * sin(yaw);
+        auto across = -dx * sin(yaw) + dy * cos(yaw);
+        if (fabs(along) < length / 2 && fabs(across) < width / 2) sum++;
+    }
+    return sum;
+}
+
+double FleetObstaclesManager::timeToPossibleCollision(double x, double y, double time, double speed) const {
+    double min = m_Obstacles.timeToPossibleCollision(x, y, time, speed);
+    for (const auto& track : m_Tracks) {
+        // same as the binary obstacles, except the vessel can go no faster than it does anywhere on its plan, and it
+        // jumps from one sample to the next, which can put it a sample's worth of distance ahead of that
+        const auto& s = track.at(time);
+        auto radius = sqrt((track.Length + 2) * (track.Length + 2) + (track.Width + 2) * (track.Width + 2)) / 2 +
+                track.MaxSpeed * DubinsPlan::planTimeDensity();
+        auto distance = sqrt((x - s.x()) * (x - s.x()) + (y - s.y()) * (y - s.y()));
+        auto gap = fmax(distance - radius, 0), closingSpeed = speed + track.MaxSpeed;
+        min = fmin(min, gap == 0? 0 : closingSpeed > 0? gap / closingSpeed : DBL_MAX);
+    }
+    return min;
+}
+
+const State& FleetObstaclesManager::Track::at(double time) const {
+    auto i = std::round((time - Samples.front().time()) / DubinsPlan::planTimeDensity());
+    if (i <= 0) return Samples.front();
+    if (i >= (double)(Samples.size() - 1)) return Samples.back();
+    return Samples[(size_t)i];
+}
@@ -0,0 +1,64 @@
+#ifndef SRC_FLEETOBSTACLESMANAGER_H
+#define SRC_FLEETOBSTACLESMANAGER_H
+
+#include <atomic>
+#include <vector>
+#include <alex_path_planner_common/DubinsPlan.h>
+#include "DynamicObstaclesManager.h"
+
+/**
+ * Obstacles for one vessel in a fleet: the obstacles everyone sees, plus the other vessels following their plans. The
+ * other vessels are boxes like the binary obstacles, but they go where their plans say instead of in a straight line.
+ * Before its plan starts a vessel is taken to be at the start of it, and after the plan ends at the end of it.
+ *
+ * Nothing changes once it's made, so a whole fleet can plan against their managers (and the shared obstacles) at once.
+ */
+class FleetObstaclesManager : public DynamicObstaclesManager {
+public:
+    typedef std::shared_ptr<FleetObstaclesManager> SharedPtr;
+
+    struct Vessel {
+        DubinsPlan Plan;
+        double Width, Length;
+        Vessel(DubinsPlan plan, double width, double length) : Plan(std::move(plan)), Width(width), Length(length) {}
+    };
+
+    /**
+     * @param obstacles obstacles everyone sees, which have to outlive this
+     * @param vessels the other vessels
+     */
+    FleetObstaclesManager(const DynamicObstaclesManager& obstacles, const std::vector<Vessel>& vessels);
+
+    ~FleetObstaclesManager() override = default;
+
+    double collisionExists(double x, double y, double time, bool strict) const override;
+
+    double timeToPossibleCollision(double x, double y, double time, double speed) const override;
+
+    unsigned long version() const override { return m_Version; }
+
+private:
+    /**
+     * A vessel sampled along its plan every DubinsPlan::planTimeDensity().
+     */
+    struct Track {
+        std::vector<State> Samples;
+        double Width, Length, MaxSpeed = 0;
+
+        /**
+         * @param time
+         * @return the sample nearest the given time
+         */
+        const State& at(double time) const;
+    };
+
+    const DynamicObstaclesManager& m_Obstacles;
+    std::vector<Track> m_Tracks;
+
+    // every manager is different from every other one, so penalties cached against another one don't get re-used
+    unsigned long m_Version = s_NextVersion++;
+    static std::atomic<unsigned long> s_NextVersion;
+};
+
+
+#endif //SRC_FLEETOBSTACLESMANAGER_H
@@ -1,4 +1,5 @@
 #include "GaussianDynamicObstaclesManager.h"
+#include <cfloat>
 
 double GaussianDynamicObstaclesManager::collisionExists(double x, double y, double time, bool strict) const {
     double sum = 0;
@@ -8,7 +9,59 @@ double GaussianDynamicObstaclesManager::collisionExists(double x, double y, doub
         sum += obstacle.pdf(Eigen::Vector2d(x, y));
     }
     // questionable
-    if (sum < 1e-5) return 0;
+    if (sum < c_NegligibleDensity) return 0;
+    return sum;
+}
+
+double GaussianDynamicObstaclesManager::timeToPossibleCollision(double x, double y, double time, double speed) const {
+    if (m_Obstacles.empty()) return DBL_MAX;
+    // if every obstacle's density is below its share of the threshold the sum is too
+    auto share = c_NegligibleDensity / m_Obstacles.size();
+    double min = DBL_MAX;
+    for (auto o : m_Obstacles) {
+        auto& obstacle = o.second;
+        obstacle.project(time);
+        // density falls off at least as fast as it does along the widest axis of the covariance
+        const auto& c = obstacle.covariance;
+        auto halfTrace = (c(0, 0) + c(1, 1)) / 2;
+        auto widest = halfTrace + sqrt(halfTrace * halfTrace - c.determinant());
+        auto norm = 1.0 / (2 * M_PI) / std::sqrt(c.determinant());
+        auto radius = norm > share? sqrt(2 * widest * log(norm / share)) : 0;
+        auto distance = sqrt((x - obstacle.X) * (x - obstacle.X) + (y - obstacle.Y) * (y - obstacle.Y));
+        auto gap = fmax(distance - radius, 0), closingSpeed = speed + fabs(obstacle.Speed);
+        min = fmin(min, gap == 0? 0 : closingSpeed > 0? gap / closingSpeed : DBL_MAX);
+    }
+    return min;
+}
+
+double GaussianDynamicObstaclesManager::integratedCollisionExists(double x, double y, double vx, double vy, double t0,
+                                                                  double t1) const {
+    if (t1 <= t0) return 0;
+    auto duration = t1 - t0;
+    double sum = 0;
+    for (auto o : m_Obstacles) {
+        auto& obstacle = o.second;
+        obstacle.project(t0);
+        // relative position is a + b * tau for tau in [0, duration], so the quadratic form is A tau^2 + 2B tau + C
+        Eigen::Vector2d a(x - obstacle.X, y - obstacle.Y);
+        Eigen::Vector2d b(vx - obstacle.Speed * cos(obstacle.Yaw), vy - obstacle.Speed * sin(obstacle.Yaw));
+        Eigen::Matrix2d inverse = obstacle.covariance.inverse();
+        double A = b.transpose() * inverse * b;
+        double B = a.transpose() * inverse * b;
+        double C = a.transpose() * inverse * a;
+        auto norm = 1.0 / (2 * M_PI) / std::sqrt(obstacle.covariance.determinant());
+        if (A < 1e-12) {
+            // moving together, so the density doesn't change
+            sum += norm * exp(-0.5 * C) * duration;
+            continue;
+        }
+        // complete the square: A (tau + B/A)^2 + C - B^2/A
+        auto scale = std::sqrt(A / 2);
+        auto lo = scale * (B / A), hi = scale * (duration + B / A);
+        // use erfc out in the tails so we don't lose everything to cancellation
+        auto area = lo > 0? erfc(lo) - erfc(hi) : hi < 0? erfc(-hi) - erfc(-lo) : erf(hi) - erf(lo);
+        sum += norm * exp(-0.5 * (C - B * B / A)) * std::sqrt(M_PI / (2 * A)) * area;
+    }
     return sum;
 }
 
@@ -23,12 +76,13 @@ void GaussianDynamicObstaclesManager::update(uint32_t mmsi, double x, double y,
         if (!result.second) {
             result.first->second = Obstacle(x, y, heading, speed, time);
         }
+        bumpVersion();
         // std::cerr << "DEBUG: GaussianDynamicObstaclesManager.update(): FINAL size is " << m_Obstacles.size() << std::endl;
     }
 }
 
 void GaussianDynamicObstaclesManager::forget(uint32_t mmsi) {
-    m_Obstacles.erase(mmsi);
+    if (m_Obstacles.erase(mmsi)) bumpVersion();
 }
 
 const std::unordered_map<uint32_t, GaussianDynamicObstaclesManager::Obstacle>& GaussianDynamicObstaclesManager::get() const {
@@ -59,6 +113,7 @@ void GaussianDynamicObstaclesManager::update(uint32_t mmsi, double x, double y,
         if (!result.second) {
             result.first->second = Obstacle(x, y, heading, speed, time, covariance);
         }
+        bumpVersion();
     }
 }
 
@@ -58,6 +58,16 @@ public:
 
     double collisionExists(double x, double y, double time, bool strict) const override;
 
+    double timeToPossibleCollision(double x, double y, double time, double speed) const override;
+
+    /**
+     * Closed form integral of the summed densities along straight, constant velocity motion, using the error function.
+     * Unlike collisionExists this doesn't throw away small sums.
+     */
+    double integratedCollisionExists(double x, double y, double vx, double vy, double t0, double t1) const override;
+
+    bool smoothPenalty() const override { return true; }
+
     void update(uint32_t mmsi, double x, double y, double heading, double speed, double time);
 
     void update(uint32_t mmsi, double x, double y, double heading, double speed, double time, Eigen::Matrix<double, 2, 2> covariance);
@@ -72,6 +82,9 @@ public:
 
 private:
     std::unordered_map<uint32_t, Obstacle> m_Obstacles;
+
+    // summed densities below this are treated as no collision
+    static constexpr double c_NegligibleDensity = 1e-5;
 };
 
 
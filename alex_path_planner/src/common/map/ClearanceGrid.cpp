@@ -0,0 +1,35 @@
+#include <algorithm>
+#include "ClearanceGrid.h"
+
+constexpr int ClearanceGrid::c_Max;
+
+ClearanceGrid::ClearanceGrid(int width, int height, const std::function<bool(int, int)>& blocked)
+    : m_Width(width), m_Height(height), m_Cells((size_t)width * height) {
+    // off the edge is blocked, so it's zero
+    auto at = [&] (int x, int y) -> int {
+        if (x < 0 || y < 0 || x >= m_Width || y >= m_Height) return 0;
+        return m_Cells[(size_t)y * m_Width + x];
+    };
+    // the first pass brings distances from below and to the left, the second from above and to the right
+    for (int y = 0; y < m_Height; y++) {
+        for (int x = 0; x < m_Width; x++) {
+            int d = 0;
+            if (!blocked(x, y)) {
+                d = std::min({at(x - 1, y), at(x - 1, y - 1), at(x, y - 1), at(x + 1, y - 1)}) + 1;
+            }
+            m_Cells[(size_t)y * m_Width + x] = (uint8_t)std::min(d, c_Max);
+        }
+    }
+    for (int y = m_Height - 1; y >= 0; y--) {
+        for (int x = m_Width - 1; x >= 0; x--) {
+            auto& cell = m_Cells[(size_t)y * m_Width + x];
+            if (cell == 0) continue;
+            int d = std::min({at(x + 1, y), at(x + 1, y + 1), at(x, y + 1), at(x - 1, y + 1)}) + 1;
+            cell = (uint8_t)std::min({(int)cell, d, c_Max});
+        }
+    }
+}
+
+size_t ClearanceGrid::memoryUsage() const {
+    return sizeof(ClearanceGrid) + m_Cells.capacity();
+}
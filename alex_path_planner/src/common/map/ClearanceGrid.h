@@ -0,0 +1,50 @@
+#ifndef SRC_CLEARANCEGRID_H
+#define SRC_CLEARANCEGRID_H
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+/**
+ * How many cells it is from each cell of a grid that never changes to the nearest blocked one, for the maps loaded from
+ * files. It's the chessboard distance (diagonal steps count as one), worked out in two passes when the map is loaded.
+ * That's never more than the real distance so clearances made from it are conservative, and it fits in a byte a cell,
+ * which matters for big charts. Use DistanceField for grids that change.
+ */
+class ClearanceGrid {
+public:
+    /**
+     * An empty grid, where everywhere is zero cells from something blocked.
+     */
+    ClearanceGrid() = default;
+
+    /**
+     * Work out the distances. Everything outside the grid counts as blocked.
+     * @param width cells
+     * @param height cells
+     * @param blocked whether the cell at (x, y) is blocked
+     */
+    ClearanceGrid(int width, int height, const std::function<bool(int, int)>& blocked);
+
+    /**
+     * @param x
+     * @param y
+     * @return chessboard distance (cells) from the cell to the nearest blocked one, saturating at c_Max, or 0 outside
+     * the grid
+     */
+    int cells(int x, int y) const {
+        if (x < 0 || y < 0 || x >= m_Width || y >= m_Height) return 0;
+        return m_Cells[(size_t)y * m_Width + x];
+    }
+
+    size_t memoryUsage() const;
+
+    static constexpr int c_Max = UINT8_MAX;
+
+private:
+    int m_Width = 0, m_Height = 0;
+    std::vector<uint8_t> m_Cells;
+};
+
+
+#endif //SRC_CLEARANCEGRID_H
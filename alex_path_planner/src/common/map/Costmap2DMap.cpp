@@ -1,54 +1,130 @@
+#include <algorithm>
+#include <cmath>
 #include "Costmap2DMap.h"
 
+constexpr double Costmap2DMap::max_clearance_;
+
 Costmap2DMap::Costmap2DMap(std::shared_ptr<costmap_2d::Costmap2DROS> costmap):costmap_(costmap)
 {
-  auto c = costmap_->getCostmap();
-  double x1 = c->getOriginX();
-  double x2 = x1 + c->getSizeInCellsX()*c->getResolution();
-  double y1 = c->getOriginY();
-  double y2 = y2 + c->getSizeInCellsY()*c->getResolution();
+  refresh();
+}
+
+double Costmap2DMap::resolution() const
+{
+  return resolution_;
+}
+
+unsigned long Costmap2DMap::version() const
+{
+  return version_;
+}
+
+bool Costmap2DMap::live() const
+{
+  return costmap_ != nullptr;
+}
+
+std::shared_ptr<Map> Costmap2DMap::snapshot() const
+{
+  std::shared_ptr<Costmap2DMap> copy(new Costmap2DMap());
+  copy->blocked_threshold_ = blocked_threshold_;
+  copy->blocked_ = blocked_;
+  copy->size_x_ = size_x_;
+  copy->size_y_ = size_y_;
+  copy->resolution_ = resolution_;
+  copy->origin_x_ = origin_x_;
+  copy->origin_y_ = origin_y_;
+  copy->version_ = version_;
+  std::copy(m_Extremes, m_Extremes + 4, copy->m_Extremes);
+  return copy;
+}
 
-  if(x1 < x2)
+void Costmap2DMap::refresh()
+{
+  if(!costmap_)
+    return;
+  auto c = costmap_->getCostmap();
+  boost::unique_lock<costmap_2d::Costmap2D::mutex_t> lock(*(c->getMutex()));
+  bool changed = false;
+  if(!distance_field_ || c->getSizeInCellsX() != size_x_ || c->getSizeInCellsY() != size_y_ ||
+     c->getResolution() != resolution_)
   {
-    m_Extremes[0] = x1;
-    m_Extremes[1] = x2;
+    // new (or resized) costmap, so start from scratch
+    size_x_ = c->getSizeInCellsX();
+    size_y_ = c->getSizeInCellsY();
+    resolution_ = c->getResolution();
+    blocked_.assign(size_x_*size_y_, 0);
+    distance_field_.reset(new DistanceField(size_x_, size_y_, max_clearance_/resolution_));
+    changed = true;
   }
   else
   {
-    m_Extremes[0] = x2;
-    m_Extremes[1] = x1;
-  }
-  if(y1 < y2)
-  {
-    m_Extremes[2] = y1;
-    m_Extremes[3] = y2;
+    // a rolling window moves in whole cells; move our snapshot along with it
+    int dx = (int)std::round((c->getOriginX() - origin_x_)/resolution_);
+    int dy = (int)std::round((c->getOriginY() - origin_y_)/resolution_);
+    if(dx != 0 || dy != 0)
+    {
+      distance_field_->shift(dx, dy);
+      std::vector<unsigned char> shifted(blocked_.size(), 0);
+      for(int y = 0; y < (int)size_y_; y++)
+        for(int x = 0; x < (int)size_x_; x++)
+          if(x + dx >= 0 && x + dx < (int)size_x_ && y + dy >= 0 && y + dy < (int)size_y_)
+            shifted[y*size_x_ + x] = blocked_[(y + dy)*size_x_ + x + dx];
+      blocked_.swap(shifted);
+      changed = true;
+    }
   }
-  else
+  origin_x_ = c->getOriginX();
+  origin_y_ = c->getOriginY();
+
+  // only the cells that changed go to the distance field
+  auto costs = c->getCharMap();
+  for(unsigned int i = 0; i < size_x_*size_y_; i++)
   {
-    m_Extremes[2] = y2;
-    m_Extremes[3] = y1;
+    unsigned char blocked = costs[i] >= blocked_threshold_;
+    if(blocked != blocked_[i])
+    {
+      blocked_[i] = blocked;
+      distance_field_->set(i % size_x_, i / size_x_, blocked);
+      changed = true;
+    }
   }
-}
+  lock.unlock();
+  distance_field_->update();
 
-double Costmap2DMap::resolution() const
-{
-  return costmap_->getCostmap()->getResolution();
+  m_Extremes[0] = origin_x_;
+  m_Extremes[1] = origin_x_ + size_x_*resolution_;
+  m_Extremes[2] = origin_y_;
+  m_Extremes[3] = origin_y_ + size_y_*resolution_;
+  if(changed)
+    version_ = nextVersion();
 }
 
 bool Costmap2DMap::isBlocked(double x, double y) const
 {
-  auto c = costmap_->getCostmap();
-
-  unsigned int mx, my;
-  if(c->worldToMap(x, y, mx, my))
-  {
-    //ROS_INFO_STREAM("isBlocked? " << x << ", " << y << " cost: " << int(c->getCost(mx, my)));
-
-    if(c->getCost(mx, my) < blocked_threshold_)
-      return false;
-  }
-  //else
-    //ROS_INFO_STREAM("isBlocked? " << x << ", " << y << " outside map bounds!");
+  if(x < origin_x_ || y < origin_y_)
+    return true;
+  auto mx = (unsigned int)((x - origin_x_)/resolution_);
+  auto my = (unsigned int)((y - origin_y_)/resolution_);
+  if(mx >= size_x_ || my >= size_y_)
+    return true;
+  return blocked_[my*size_x_ + mx];
+}
 
-  return true;
+double Costmap2DMap::clearance(double x, double y) const
+{
+  if(!distance_field_ || isBlocked(x, y))
+    return 0;
+  auto mx = (int)((x - origin_x_)/resolution_);
+  auto my = (int)((y - origin_y_)/resolution_);
+  auto cells = distance_field_->distance(mx, my);
+  if(std::isinf(cells))
+    cells = distance_field_->maxDistance();
+  // the distance is between cell centres, and the point and the obstacle could be anywhere in their cells, so take a
+  // cell's diagonal off. Take another cell off for the brushfire sometimes settling on a slightly further obstacle
+  auto clear = (cells - M_SQRT2 - 1)*resolution_;
+  // outside the costmap is blocked too
+  clear = std::fmin(clear, std::fmin(x - origin_x_, m_Extremes[1] - x));
+  clear = std::fmin(clear, std::fmin(y - origin_y_, m_Extremes[3] - y));
+  return std::fmax(clear, 0);
 }
@@ -1,9 +1,17 @@
 #ifndef SRC_COSTMAP2DMAP_H
 #define SRC_COSTMAP2DMAP_H
 
+#include <memory>
+#include <vector>
 #include "Map.h"
+#include "DistanceField.h"
 #include <costmap_2d/costmap_2d_ros.h>
 
+/**
+ * Map backed by a live costmap. The costmap keeps changing as the sensors update it, so we plan against a snapshot of
+ * which cells are blocked, taken by refresh() between planning cycles. Each refresh only passes the cells that changed
+ * on to a distance field, so clearance stays available without rebuilding it every cycle, even for big rolling windows.
+ */
 class Costmap2DMap : public Map {
 public:
     Costmap2DMap(std::shared_ptr<costmap_2d::Costmap2DROS> costmap);
@@ -14,9 +22,54 @@ public:
 
     double resolution() const override;
 
+    /**
+     * Clearance from the distance field. Outside the costmap counts as blocked, like it does for isBlocked.
+     * @param x
+     * @param y
+     * @return
+     */
+    double clearance(double x, double y) const override;
+
+    /**
+     * Take a new snapshot of the costmap, following it if it's a rolling window.
+     */
+    void refresh() override;
+
+    /**
+     * @return true, except for snapshots
+     */
+    bool live() const override;
+
+    /**
+     * Copy which cells are blocked as of the last refresh. The copy leaves out the distance field, since copying it
+     * every cycle would cost more than it saves, so it says there's no clearance anywhere (which is always safe).
+     * @return
+     */
+    std::shared_ptr<Map> snapshot() const override;
+
+    /**
+     * Changes whenever a refresh finds cells that have become blocked or clear (or the window has moved), so checks
+     * against the snapshot can be re-used until then.
+     * @return
+     */
+    unsigned long version() const override;
+
 private:
+    // for snapshots, which have no costmap to refresh from
+    Costmap2DMap() = default;
+
     std::shared_ptr<costmap_2d::Costmap2DROS> costmap_;
     unsigned char blocked_threshold_ = costmap_2d::LETHAL_OBSTACLE;
+
+    // the snapshot: which cells were blocked, and where the costmap was, as of the last refresh
+    std::vector<unsigned char> blocked_;
+    unsigned int size_x_ = 0, size_y_ = 0;
+    double resolution_ = 0, origin_x_ = 0, origin_y_ = 0;
+    std::unique_ptr<DistanceField> distance_field_;
+    unsigned long version_ = nextVersion();
+
+    // how far (m) to work out clearance to. Nothing needs to know about obstacles further off than this
+    static constexpr double max_clearance_ = 50;
 };
 
 
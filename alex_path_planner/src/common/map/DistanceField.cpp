@@ -0,0 +1,136 @@
+#include <stdexcept>
+#include "DistanceField.h"
+
+constexpr int32_t DistanceField::c_None;
+
+DistanceField::DistanceField(int width, int height, double maxDistance)
+        : m_Width(width), m_Height(height), m_MaxDistance(maxDistance) {
+    if (width < 0 || height < 0) throw std::invalid_argument("Distance field can't have a negative size");
+    m_Cells.resize((size_t)width * height);
+}
+
+void DistanceField::set(int x, int y, bool occupied) {
+    if (x < 0 || y < 0 || x >= m_Width || y >= m_Height) return;
+    auto i = index(x, y);
+    if (isOccupied(i) == occupied) return;
+    auto& cell = m_Cells[i];
+    if (occupied) {
+        cell.Obstacle = i;
+        cell.Distance = 0;
+        cell.ToRaise = false;
+    } else {
+        clear(i);
+        cell.ToRaise = true;
+    }
+    m_Open.emplace(0, i);
+}
+
+unsigned long DistanceField::update() {
+    unsigned long visited = 0;
+    while (!m_Open.empty()) {
+        auto i = m_Open.top().second;
+        m_Open.pop();
+        visited++;
+        if (m_Cells[i].ToRaise) raise(i);
+        else if (isOccupied(m_Cells[i].Obstacle)) lower(i);
+        // otherwise it's been cleared since it was queued
+    }
+    return visited;
+}
+
+void DistanceField::shift(int dx, int dy) {
+    if (dx == 0 && dy == 0) return;
+    // queued waves refer to cells where they are now
+    update();
+    auto wasInside = [&] (int x, int y) {
+        return x + dx >= 0 && x + dx < m_Width && y + dy >= 0 && y + dy < m_Height;
+    };
+    std::vector<Cell> cells(m_Cells.size());
+    std::vector<int32_t> orphans;
+    for (int y = 0; y < m_Height; y++) {
+        for (int x = 0; x < m_Width; x++) {
+            if (!wasInside(x, y)) continue;
+            auto& cell = cells[index(x, y)];
+            cell = m_Cells[index(x + dx, y + dy)];
+            if (cell.Obstacle == c_None) continue;
+            auto ox = cell.Obstacle % m_Width - dx, oy = cell.Obstacle / m_Width - dy;
+            if (ox >= 0 && ox < m_Width && oy >= 0 && oy < m_Height) {
+                cell.Obstacle = index(ox, oy);
+            } else {
+                // its obstacle's gone
+                cell.Obstacle = c_None;
+                orphans.push_back(index(x, y));
+            }
+        }
+    }
+    m_Cells.swap(cells);
+    // cells that lost their obstacle get cleared and filled back in from around them, like when an obstacle is freed
+    for (auto i : orphans) {
+        auto distance = m_Cells[i].Distance;
+        clear(i);
+        m_Cells[i].ToRaise = true;
+        m_Open.emplace(distance, i);
+    }
+    // and the cells that have just come in get filled in from the ones next to them that were already here
+    for (int y = 0; y < m_Height; y++) {
+        for (int x = 0; x < m_Width; x++) {
+            auto i = index(x, y);
+            if (!wasInside(x, y) || m_Cells[i].Obstacle == c_None) continue;
+            bool edge = false;
+            forNeighbours(i, [&] (int32_t n) { edge = edge || !wasInside(n % m_Width, n / m_Width); });
+            if (edge) m_Open.emplace(m_Cells[i].Distance, i);
+        }
+    }
+}
+
+double DistanceField::distance(int x, int y) const {
+    if (x < 0 || y < 0 || x >= m_Width || y >= m_Height) return INFINITY;
+    return m_Cells[index(x, y)].Distance;
+}
+
+bool DistanceField::occupied(int x, int y) const {
+    if (x < 0 || y < 0 || x >= m_Width || y >= m_Height) return false;
+    return isOccupied(index(x, y));
+}
+
+float DistanceField::distanceBetween(int32_t a, int32_t b) const {
+    auto dx = a % m_Width - b % m_Width, dy = a / m_Width - b / m_Width;
+    return sqrtf((float)(dx * dx + dy * dy));
+}
+
+void DistanceField::clear(int32_t i) {
+    m_Cells[i].Distance = INFINITY;
+    m_Cells[i].Obstacle = c_None;
+}
+
+void DistanceField::raise(int32_t i) {
+    forNeighbours(i, [&] (int32_t n) {
+        auto& cell = m_Cells[n];
+        if (cell.Obstacle == c_None || cell.ToRaise) return;
+        if (!isOccupied(cell.Obstacle)) {
+            // nearest to an obstacle that's gone, so pass the clearing on
+            auto distance = cell.Distance;
+            clear(n);
+            cell.ToRaise = true;
+            m_Open.emplace(distance, n);
+        } else {
+            // still good, so it can fill in what's been cleared
+            m_Open.emplace(cell.Distance, n);
+        }
+    });
+    m_Cells[i].ToRaise = false;
+}
+
+void DistanceField::lower(int32_t i) {
+    auto obstacle = m_Cells[i].Obstacle;
+    forNeighbours(i, [&] (int32_t n) {
+        auto& cell = m_Cells[n];
+        if (cell.ToRaise) return;
+        auto distance = distanceBetween(obstacle, n);
+        if (distance < cell.Distance && distance <= m_MaxDistance) {
+            cell.Distance = distance;
+            cell.Obstacle = obstacle;
+            m_Open.emplace(distance, n);
+        }
+    });
+}
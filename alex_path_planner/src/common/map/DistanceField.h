@@ -0,0 +1,119 @@
+#ifndef SRC_DISTANCEFIELD_H
+#define SRC_DISTANCEFIELD_H
+
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <vector>
+
+/**
+ * Distance from each cell of a grid to the nearest occupied cell, kept up to date as cells change rather than rebuilt.
+ * This is the dynamic brushfire of Lau, Sprunk and Burgard: each cell remembers which obstacle it's nearest to, newly
+ * occupied cells send out a wave lowering their neighbours' distances, and freed cells send out a wave clearing
+ * everything that was nearest to them, which the surrounding obstacles' waves then fill back in. Only the cells near
+ * a change get touched, so it's cheap to keep up with a map that's being updated by sensors.
+ *
+ * Distances are only worked out up to a maximum. Anything further from every obstacle than that is just "far", which
+ * keeps each wave small.
+ *
+ * The grid can also be shifted, for maps that are a window rolling along with the vessel.
+ */
+class DistanceField {
+public:
+    /**
+     * Make a field with nothing occupied.
+     * @param width cells
+     * @param height cells
+     * @param maxDistance how far (cells) to work distances out to
+     */
+    DistanceField(int width, int height, double maxDistance);
+
+    /**
+     * Mark a cell occupied or free. This doesn't take effect until the next update().
+     * @param x
+     * @param y
+     * @param occupied
+     */
+    void set(int x, int y, bool occupied);
+
+    /**
+     * Spread the changes since last time.
+     * @return how many cells were visited doing it
+     */
+    unsigned long update();
+
+    /**
+     * Move the grid so the cell that was at (dx, dy) is now at (0, 0). Cells that come into the grid are free and
+     * obstacles that go out of it are forgotten. Like set(), this is finished off by the next update().
+     * @param dx
+     * @param dy
+     */
+    void shift(int dx, int dy);
+
+    /**
+     * @param x
+     * @param y
+     * @return distance (cells, centre to centre) from the cell to the nearest occupied one, or infinity if that's
+     * further than the maximum distance (or outside the grid)
+     */
+    double distance(int x, int y) const;
+
+    /**
+     * @param x
+     * @param y
+     * @return whether the cell is occupied (as of the last update)
+     */
+    bool occupied(int x, int y) const;
+
+    int width() const { return m_Width; }
+    int height() const { return m_Height; }
+    double maxDistance() const { return m_MaxDistance; }
+
+private:
+    static constexpr int32_t c_None = -1;
+
+    struct Cell {
+        // distance to the nearest obstacle, and which cell that is
+        float Distance = INFINITY;
+        int32_t Obstacle = c_None;
+        bool ToRaise = false;
+    };
+
+    int m_Width, m_Height;
+    double m_MaxDistance;
+    std::vector<Cell> m_Cells;
+    // (distance, cell) queue of the waves still spreading, nearest first
+    typedef std::pair<float, int32_t> Entry;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> m_Open;
+
+    int32_t index(int x, int y) const { return y * m_Width + x; }
+
+    bool isOccupied(int32_t i) const { return i != c_None && m_Cells[i].Obstacle == i; }
+
+    float distanceBetween(int32_t a, int32_t b) const;
+
+    void clear(int32_t i);
+
+    void raise(int32_t i);
+
+    void lower(int32_t i);
+
+    /**
+     * Call visit(n) for each of the (up to) eight neighbours of cell i.
+     */
+    template<typename F>
+    void forNeighbours(int32_t i, const F& visit) const {
+        auto x = i % m_Width, y = i / m_Width;
+        for (int b = -1; b <= 1; b++) {
+            if (y + b < 0 || y + b >= m_Height) continue;
+            for (int a = -1; a <= 1; a++) {
+                if ((a == 0 && b == 0) || x + a < 0 || x + a >= m_Width) continue;
+                visit(index(x + a, y + b));
+            }
+        }
+    }
+};
+
+
+#endif //SRC_DISTANCEFIELD_H
@@ -2,6 +2,7 @@
 #include <iostream>
 #include <ogr_spatialref.h>
 #include <cfloat>
+#include <cmath>
 #include <queue>
 #include "GeoTiffMap.h"
 
@@ -103,6 +104,14 @@ GeoTiffMap::GeoTiffMap(const std::string& path, double originLongitude, double o
 //    }
 
     std::cerr << blockedCount << " out of " << rasterCols*rasterRows << " cells blocked" << std::endl;
+
+    // only for north-up charts; a rotated one's pixels aren't a box so just leave it with no clearance
+    if (geoTransform[2] == 0 && geoTransform[4] == 0) {
+        m_PixelSize = fmin(fabs(geoTransform[1]), fabs(geoTransform[5]));
+        m_Clearance = ClearanceGrid(rasterCols, rasterRows, [this] (int x, int y) {
+            return m_Data[y][x] <= c_MinimumDepth;
+        });
+    }
 //
 //    while (!brushFireQueue.empty()) {
 //        auto& cell = brushFireQueue.front();
@@ -118,18 +127,9 @@ GeoTiffMap::GeoTiffMap(const std::string& path, double originLongitude, double o
     delete[] geoTransform;
 }
 
-float GeoTiffMap::getDepth(double x, double y) const {
-    auto xi = m_InverseGeoTransform[0] + x * m_InverseGeoTransform[1] + y * m_InverseGeoTransform[2];
-    auto yi = m_InverseGeoTransform[3] + x * m_InverseGeoTransform[4] + y * m_InverseGeoTransform[5];
-    // bad: using exceptions for control flow
-    try {
-        return m_Data.at((int)yi).at((int)xi);
-    } catch(std::out_of_range&) {
-        return 0;
-    }
-
-}
-
-bool GeoTiffMap::isBlocked(double x, double y) const {
-    return getDepth(x, y) <= c_MinimumDepth;
+size_t GeoTiffMap::memoryUsage() const {
+    size_t bytes = sizeof(GeoTiffMap) + m_InverseGeoTransform.capacity() * sizeof(double);
+    for (const auto& row : m_Data) bytes += sizeof(row) + row.capacity() * sizeof(float);
+    for (const auto& row : m_Distances) bytes += sizeof(row) + row.capacity() * sizeof(double);
+    return bytes + m_Clearance.memoryUsage() - sizeof(ClearanceGrid);
 }
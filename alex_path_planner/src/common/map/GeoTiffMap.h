@@ -4,6 +4,7 @@
 #include <gdal_priv.h>
 #include <string>
 #include "Map.h"
+#include "ClearanceGrid.h"
 
 /**
  * Represent a map loaded from a GeoTiff.
@@ -21,9 +22,26 @@ public:
 
     ~GeoTiffMap() override = default;
 
-    float getDepth(double x, double y) const;
+    // these two are here rather than in the .cpp so edge evaluation can inline them (see Edge::evaluate)
+    float getDepth(double x, double y) const {
+        auto xi = (int)(m_InverseGeoTransform[0] + x * m_InverseGeoTransform[1] + y * m_InverseGeoTransform[2]);
+        auto yi = (int)(m_InverseGeoTransform[3] + x * m_InverseGeoTransform[4] + y * m_InverseGeoTransform[5]);
+        if (yi < 0 || yi >= (int)m_Data.size() || xi < 0 || xi >= (int)m_Data[yi].size()) return 0;
+        return m_Data[yi][xi];
+    }
 
-    bool isBlocked(double x, double y) const override;
+    bool isBlocked(double x, double y) const override {
+        return getDepth(x, y) <= c_MinimumDepth;
+    }
+
+    double clearance(double x, double y) const override {
+        auto xi = (int)(m_InverseGeoTransform[0] + x * m_InverseGeoTransform[1] + y * m_InverseGeoTransform[2]);
+        auto yi = (int)(m_InverseGeoTransform[3] + x * m_InverseGeoTransform[4] + y * m_InverseGeoTransform[5]);
+        auto cells = m_Clearance.cells(xi, yi);
+        return cells > 1? (cells - 1) * m_PixelSize : 0;
+    }
+
+    size_t memoryUsage() const override;
 
     // TODO! -- to be useful in PF planner, override resolution function to allow querying at the right intervals
 
@@ -32,6 +50,9 @@ private:
     std::vector<std::vector<float>> m_Data;
     std::vector<std::vector<double>> m_Distances;
     std::vector<double> m_InverseGeoTransform;
+    // chessboard distances to the shallows, and the smaller side of a pixel (m) to turn them into clearances
+    ClearanceGrid m_Clearance;
+    double m_PixelSize = 0;
     double m_XOrigin, m_YOrigin;
     static constexpr double c_MinimumDepth = 0;
 };
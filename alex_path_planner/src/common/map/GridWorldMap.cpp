@@ -63,6 +63,8 @@ GridWorldMap::GridWorldMap(const std::string& path) {
         }
     }
 
+    m_Clearance = ClearanceGrid(cols, rows, [this] (int x, int y) { return m_Blocked[y][x]; });
+
     // prints out the map (upside down)
 //    for (int y = 0; y < rows; y++) {
 //        for (int x = 0; x < cols; x++) {
@@ -81,17 +83,6 @@ GridWorldMap::GridWorldMap(const std::string& path) {
 //    }
 }
 
-bool GridWorldMap::isBlocked(double x, double y) const {
-    if (x < 0 || x / m_Resolution >= m_Blocked.front().size()) return true;
-    if (y < 0 || y / m_Resolution >= m_Blocked.size()) return true;
-//    try {
-        return m_Blocked.at(y / m_Resolution).at(x / m_Resolution);
-//    }
-//    catch (std::out_of_range&) {
-//        return true;
-//    }
-}
-
 const double* GridWorldMap::extremes() const {
     return m_Extremes;
 }
@@ -99,3 +90,9 @@ const double* GridWorldMap::extremes() const {
 double GridWorldMap::resolution() const {
     return m_Resolution;
 }
+
+size_t GridWorldMap::memoryUsage() const {
+    size_t bytes = sizeof(GridWorldMap);
+    for (const auto& row : m_Blocked) bytes += sizeof(row) + row.capacity() / 8;
+    return bytes + m_Clearance.memoryUsage() - sizeof(ClearanceGrid);
+}
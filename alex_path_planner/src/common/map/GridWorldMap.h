@@ -3,6 +3,7 @@
 
 #include <vector>
 #include "Map.h"
+#include "ClearanceGrid.h"
 
 /**
  * Represent a map loaded from a grid-world text file.
@@ -17,14 +18,29 @@ public:
 
     ~GridWorldMap() override = default;
 
-    bool isBlocked(double x, double y) const override;
+    // here rather than in the .cpp so edge evaluation can inline it (see Edge::evaluate)
+    bool isBlocked(double x, double y) const override {
+        if (x < 0 || x / m_Resolution >= m_Blocked.front().size()) return true;
+        if (y < 0 || y / m_Resolution >= m_Blocked.size()) return true;
+        return m_Blocked[(size_t)(y / m_Resolution)][(size_t)(x / m_Resolution)];
+    }
+
+    // anything within a cell's chessboard distance less one is clear of it, wherever in the cell we are
+    double clearance(double x, double y) const override {
+        if (x < 0 || y < 0) return 0;
+        auto cells = m_Clearance.cells((int)(x / m_Resolution), (int)(y / m_Resolution));
+        return cells > 1? (cells - 1) * m_Resolution : 0;
+    }
 
     const double* extremes() const override;
 
     double resolution() const override;
 
+    size_t memoryUsage() const override;
+
 private:
     std::vector<std::vector<bool>> m_Blocked;
+    ClearanceGrid m_Clearance;
     double m_Resolution;
     double m_Extremes[4];
 };
@@ -1,4 +1,5 @@
 #include <cfloat>
+#include <atomic>
 #include "Map.h"
 
 bool Map::isBlocked(double x, double y) const {
@@ -12,3 +13,31 @@ const double* Map::extremes() const {
 double Map::resolution() const {
     return 0;
 }
+
+double Map::clearance(double x, double y) const {
+    return 0;
+}
+
+void Map::refresh() {
+}
+
+bool Map::live() const {
+    return false;
+}
+
+std::shared_ptr<Map> Map::snapshot() const {
+    return nullptr;
+}
+
+unsigned long Map::version() const {
+    return m_Version;
+}
+
+size_t Map::memoryUsage() const {
+    return sizeof(Map);
+}
+
+unsigned long Map::nextVersion() {
+    static std::atomic<unsigned long> s_NextVersion(1);
+    return s_NextVersion++;
+}
@@ -30,8 +30,59 @@ public:
 
     virtual double resolution() const;
 
+    /**
+     * How far it is from a point to anything blocked, so whole areas can be checked at once. Maps that don't keep track
+     * say 0, which is always safe.
+     * @param x
+     * @param y
+     * @return distance (m) within which everything is sure to be clear
+     */
+    virtual double clearance(double x, double y) const;
+
+    /**
+     * Bring the map up to date with whatever it's drawn from. The planning thread calls this between cycles, when
+     * nothing is checking against the map. Maps loaded from files never change so by default this does nothing.
+     */
+    virtual void refresh();
+
+    /**
+     * Whether refresh() can change the map. Work that reads the map for a long time in the background (like building a
+     * roadmap) can only be done on maps that don't, since nothing stops a refresh in the middle of it.
+     * @return false by default
+     */
+    virtual bool live() const;
+
+    /**
+     * A copy of the map as it is now, which refresh() won't change, for reading from another thread while the planning
+     * thread carries on refreshing this one. Only live maps need one.
+     * @return the copy, or null for maps that aren't live
+     */
+    virtual std::shared_ptr<Map> snapshot() const;
+
+    /**
+     * Identifies the contents of the map, so collision checks done against it can be cached. Maps loaded from a file
+     * never change, so by default this is just unique to each map object. Maps that can change underneath us should
+     * return a new value whenever they might have.
+     * @return
+     */
+    virtual unsigned long version() const;
+
+    /**
+     * Roughly how much memory the map takes up, for caching.
+     * @return bytes
+     */
+    virtual size_t memoryUsage() const;
+
 protected:
     double m_Extremes[4] = {-DBL_MAX, DBL_MAX, -DBL_MAX, DBL_MAX};
+
+    /**
+     * @return a version number no map has used before
+     */
+    static unsigned long nextVersion();
+
+private:
+    unsigned long m_Version = nextVersion();
 };
 
 
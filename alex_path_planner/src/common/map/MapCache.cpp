@@ -0,0 +1,46 @@
+#include <sys/stat.h>
+#include "MapCache.h"
+
+MapCache::MapCache(size_t capacity) : m_Capacity(capacity) {}
+
+Map::SharedPtr MapCache::get(const std::string& path, double latitude, double longitude,
+                             const std::function<Map::SharedPtr()>& load) {
+    struct stat info{};
+    if (stat(path.c_str(), &info) != 0) return load(); // let the loader complain about it
+    Key key(path, info.st_mtim.tv_sec, info.st_mtim.tv_nsec, latitude, longitude);
+
+    // loading under the lock makes anyone else after the same map wait for it instead of loading a second copy
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    auto it = m_Index.find(key);
+    if (it != m_Index.end()) {
+        m_Entries.splice(m_Entries.begin(), m_Entries, it->second);
+        return it->second->second;
+    }
+    auto map = load();
+    if (!map) return map;
+    m_Entries.emplace_front(key, map);
+    m_Index[key] = m_Entries.begin();
+    m_Size += map->memoryUsage();
+    while (m_Size > m_Capacity && m_Entries.size() > 1) {
+        const auto& oldest = m_Entries.back();
+        m_Size -= oldest.second->memoryUsage();
+        m_Index.erase(oldest.first);
+        m_Entries.pop_back();
+    }
+    return map;
+}
+
+size_t MapCache::size() const {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Size;
+}
+
+size_t MapCache::count() const {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Entries.size();
+}
+
+MapCache& MapCache::global() {
+    static MapCache s_Cache;
+    return s_Cache;
+}
@@ -0,0 +1,70 @@
+#ifndef SRC_MAPCACHE_H
+#define SRC_MAPCACHE_H
+
+#include <functional>
+#include <list>
+#include <map>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include "Map.h"
+
+/**
+ * Least recently used cache of maps loaded from files, so going back to a task in an area we've already loaded doesn't
+ * mean loading (and preprocessing) the whole map again. Maps are keyed by path, file modification time and origin, so
+ * an edited file or a different origin gets loaded fresh.
+ *
+ * Cached maps are shared between everyone that asks for them, which is fine because maps from files never change once
+ * they're loaded. The cache only counts its own entries against its memory limit: a map that's still in use when it's
+ * evicted stays around until whoever has it is done with it.
+ */
+class MapCache {
+public:
+    /**
+     * @param capacity memory limit (bytes) on cached maps. The most recent map is always kept, even if it's bigger
+     */
+    explicit MapCache(size_t capacity = c_DefaultCapacity);
+
+    /**
+     * Get the map for a file, loading it if it isn't cached.
+     * @param path
+     * @param latitude origin latitude, ignored (pass 0) for maps that don't use it
+     * @param longitude origin longitude, likewise
+     * @param load loads the map if we need to. Any exception it throws is passed on and nothing is cached
+     * @return
+     */
+    Map::SharedPtr get(const std::string& path, double latitude, double longitude,
+                       const std::function<Map::SharedPtr()>& load);
+
+    /**
+     * @return the memory used by cached maps (bytes)
+     */
+    size_t size() const;
+
+    /**
+     * @return the number of cached maps
+     */
+    size_t count() const;
+
+    /**
+     * @return the cache shared across the whole process
+     */
+    static MapCache& global();
+
+    static constexpr size_t c_DefaultCapacity = 1ul << 30;
+
+private:
+    // path, modification time (s, ns), latitude, longitude
+    typedef std::tuple<std::string, long, long, double, double> Key;
+    typedef std::list<std::pair<Key, Map::SharedPtr>> Entries;
+
+    mutable std::mutex m_Mutex;
+    // most recently used first
+    Entries m_Entries;
+    std::map<Key, Entries::iterator> m_Index;
+    size_t m_Size = 0;
+    size_t m_Capacity;
+};
+
+
+#endif //SRC_MAPCACHE_H
@@ -0,0 +1,61 @@
+#include <cmath>
+#include "ContactIngestor.h"
+
+void ContactIngestor::report(uint32_t mmsi, const State& obstacle, double width, double length) {
+    std::lock_guard<std::mutex> lock(m_PendingMutex);
+    auto it = m_Pending.find(mmsi);
+    // messages can arrive out of order, so don't let an older report replace a newer one
+    if (it == m_Pending.end()) m_Pending.emplace(mmsi, Contact{mmsi, obstacle, width, length});
+    else if (it->second.Report.time() <= obstacle.time()) it->second = Contact{mmsi, obstacle, width, length};
+}
+
+ContactIngestor::Changes ContactIngestor::ingest(const State& vessel, double maxSpeed, double timeHorizon) {
+    std::unordered_map<uint32_t, Contact> pending;
+    {
+        std::lock_guard<std::mutex> lock(m_PendingMutex);
+        pending.swap(m_Pending);
+    }
+    for (const auto& p : pending) {
+        auto it = m_Tracks.find(p.first);
+        if (it == m_Tracks.end()) {
+            Track track;
+            track.Latest = p.second;
+            m_Tracks.emplace(p.first, track);
+        } else if (it->second.Latest.Report.time() <= p.second.Report.time()) {
+            it->second.Latest = p.second;
+            it->second.Fresh = true;
+        }
+    }
+
+    Changes changes;
+    for (auto it = m_Tracks.begin(); it != m_Tracks.end();) {
+        auto& track = it->second;
+        const auto& report = track.Latest.Report;
+        if (vessel.time() - report.time() > c_StaleAge) {
+            if (track.Relevant) changes.Forgotten.push_back(it->first);
+            it = m_Tracks.erase(it);
+            continue;
+        }
+        // Both of us could be heading straight for each other, so anything further away than we could both cover in
+        // the time horizon can't matter to this plan
+        auto projected = report.push(vessel.time() - report.time());
+        auto reach = (maxSpeed + fabs(report.speed())) * timeHorizon + c_RelevanceMargin;
+        bool relevant = projected.distanceTo(vessel) <= reach;
+        if (relevant && (track.Fresh || !track.Relevant)) changes.Updated.push_back(track.Latest);
+        else if (!relevant && track.Relevant) changes.Forgotten.push_back(it->first);
+        track.Relevant = relevant;
+        track.Fresh = false;
+        ++it;
+    }
+    return changes;
+}
+
+size_t ContactIngestor::tracked() const {
+    return m_Tracks.size();
+}
+
+size_t ContactIngestor::relevant() const {
+    size_t count = 0;
+    for (const auto& t : m_Tracks) if (t.second.Relevant) count++;
+    return count;
+}
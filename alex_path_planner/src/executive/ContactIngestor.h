@@ -0,0 +1,90 @@
+#ifndef SRC_CONTACTINGESTOR_H
+#define SRC_CONTACTINGESTOR_H
+
+#include <mutex>
+#include <vector>
+#include <unordered_map>
+#include <alex_path_planner_common/State.h>
+
+/**
+ * Class to sit between the contact reports coming in from ROS and the dynamic obstacle managers the planner uses.
+ *
+ * Reports just get buffered (latest wins per mmsi) so the callback never has to wait on the obstacle managers. Once
+ * per planning cycle the executive calls ingest, which folds the buffered reports into the tracks, expires tracks we
+ * haven't heard from in a while, and decides which tracks could possibly matter to the vessel within the time horizon.
+ * Only those ones get passed on to the obstacle managers, so a busy shipping lane full of far away contacts doesn't
+ * slow down the planner.
+ */
+class ContactIngestor {
+public:
+    /**
+     * A single contact report.
+     */
+    struct Contact {
+        uint32_t Mmsi;
+        State Report;
+        double Width, Length;
+    };
+
+    /**
+     * What the obstacle managers need to do after a cycle's ingest.
+     */
+    struct Changes {
+        // relevant contacts with a new report, or which have just become relevant
+        std::vector<Contact> Updated;
+        // contacts the managers know about that are stale or no longer relevant
+        std::vector<uint32_t> Forgotten;
+    };
+
+    /**
+     * Buffer a contact report. Safe to call from any thread. Only the latest report for each contact is kept until the
+     * next ingest.
+     * @param mmsi
+     * @param obstacle
+     * @param width
+     * @param length
+     */
+    void report(uint32_t mmsi, const State& obstacle, double width, double length);
+
+    /**
+     * Fold the buffered reports into the tracks, expire stale tracks, and work out which tracks are reachable from the
+     * vessel within the time horizon. Only call this from one thread (the planning thread).
+     * @param vessel the state the planner will start from
+     * @param maxSpeed the vessel's max speed
+     * @param timeHorizon
+     * @return what to update and forget in the obstacle managers
+     */
+    Changes ingest(const State& vessel, double maxSpeed, double timeHorizon);
+
+    /**
+     * @return the number of contacts being tracked (relevant or not)
+     */
+    size_t tracked() const;
+
+    /**
+     * @return the number of tracked contacts that were relevant as of the last ingest
+     */
+    size_t relevant() const;
+
+    // how long to keep a track without hearing from it. AIS class A reports every few minutes at anchor, so
+    // this allows for one missed report
+    static constexpr double c_StaleAge = 360;
+
+    // distance added to the reach of a contact to allow for its size and the spread of its distribution
+    static constexpr double c_RelevanceMargin = 200;
+
+private:
+    struct Track {
+        Contact Latest;
+        bool Fresh = true;
+        bool Relevant = false;
+    };
+
+    std::mutex m_PendingMutex;
+    std::unordered_map<uint32_t, Contact> m_Pending;
+
+    std::unordered_map<uint32_t, Track> m_Tracks;
+};
+
+
+#endif //SRC_CONTACTINGESTOR_H
@@ -0,0 +1,146 @@
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <malloc.h>
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include "RealTimeProfile.h"
+
+bool RealTimeProfile::enabled() const {
+    return !Cpus.empty() || Priority > 0 || LockMemory || PrefaultBytes > 0;
+}
+
+bool RealTimeProfile::applyToThisThread(bool realTime, std::ostream& output) const {
+    bool ok = true;
+    if (!Cpus.empty()) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (auto cpu : Cpus) if (cpu >= 0 && cpu < CPU_SETSIZE) CPU_SET(cpu, &set);
+        auto err = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        if (err != 0) {
+            output << "Couldn't pin thread to CPUs: " << strerror(err) << std::endl;
+            ok = false;
+        }
+    }
+    if (realTime && Priority > 0) {
+        sched_param param{};
+        param.sched_priority = Priority;
+        auto err = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+        if (err != 0) {
+            output << "Couldn't use SCHED_FIFO (priority " << Priority << "): " << strerror(err) << std::endl;
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+bool RealTimeProfile::lowerThisThreadPriority(std::ostream& output) {
+    // on Linux each thread has its own nice value, set through its thread id
+    if (setpriority(PRIO_PROCESS, (id_t)syscall(SYS_gettid), c_BackgroundNice) != 0) {
+        output << "Couldn't lower thread priority: " << strerror(errno) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool RealTimeProfile::prepareMemory(std::ostream& output) const {
+    bool ok = true;
+    if (LockMemory && mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+        output << "Couldn't lock memory: " << strerror(errno) << std::endl;
+        ok = false;
+    }
+    if (PrefaultBytes > 0) {
+        // keep freed memory in the heap instead of handing it back, so what we fault in now stays faulted in
+        mallopt(M_TRIM_THRESHOLD, -1);
+        mallopt(M_MMAP_MAX, 0);
+        auto buffer = (char*)malloc(PrefaultBytes);
+        if (buffer) {
+            // one write per page is enough
+            for (size_t i = 0; i < PrefaultBytes; i += 4096) buffer[i] = 1;
+            free(buffer);
+        } else {
+            output << "Couldn't pre-fault " << PrefaultBytes << " bytes" << std::endl;
+            ok = false;
+        }
+    }
+    if (LockMemory || PrefaultBytes > 0) {
+        // and some stack, which mlockall only locks as far as it's been used
+        volatile char stack[c_PrefaultStackBytes];
+        for (size_t i = 0; i < sizeof(stack); i += 4096) stack[i] = 1;
+    }
+    return ok;
+}
+
+std::vector<int> RealTimeProfile::parseCpus(const std::string& cpus) {
+    std::vector<int> result;
+    std::stringstream stream(cpus);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (item.empty()) continue;
+        auto dash = item.find('-');
+        try {
+            if (dash == std::string::npos) {
+                result.push_back(std::stoi(item));
+            } else {
+                for (int cpu = std::stoi(item.substr(0, dash)); cpu <= std::stoi(item.substr(dash + 1)); cpu++)
+                    result.push_back(cpu);
+            }
+        } catch (const std::logic_error&) {
+            throw std::invalid_argument("Couldn't parse CPU list \"" + cpus + "\"");
+        }
+    }
+    return result;
+}
+
+RealTimeProfile::JitterHistogram::JitterHistogram(double binWidth, int bins)
+    : m_BinWidth(binWidth), m_Bins(bins), m_Counts(2 * bins + 1, 0) {}
+
+void RealTimeProfile::JitterHistogram::record(double jitter) {
+    auto bin = (long)std::round(jitter / m_BinWidth);
+    if (bin < -m_Bins) bin = -m_Bins;
+    if (bin > m_Bins) bin = m_Bins;
+    m_Counts[bin + m_Bins]++;
+    m_Max = m_Count == 0? jitter : fmax(m_Max, jitter);
+    m_Count++;
+}
+
+unsigned long RealTimeProfile::JitterHistogram::count() const {
+    return m_Count;
+}
+
+double RealTimeProfile::JitterHistogram::percentile(double fraction) const {
+    if (m_Count == 0) return 0;
+    auto target = (unsigned long)std::ceil(fraction * (double)m_Count);
+    unsigned long sum = 0;
+    for (int i = 0; i < (int)m_Counts.size(); i++) {
+        sum += m_Counts[i];
+        if (sum >= target) return (i - m_Bins) * m_BinWidth;
+    }
+    return m_Bins * m_BinWidth;
+}
+
+double RealTimeProfile::JitterHistogram::max() const {
+    return m_Max;
+}
+
+void RealTimeProfile::JitterHistogram::clear() {
+    std::fill(m_Counts.begin(), m_Counts.end(), 0);
+    m_Count = 0;
+    m_Max = 0;
+}
+
+std::string RealTimeProfile::JitterHistogram::summary() const {
+    std::stringstream stream;
+    stream << std::fixed << std::setprecision(1) << "Cycle jitter over " << m_Count << " cycles (ms): median "
+           << percentile(0.5) * 1000 << ", 99th percentile " << percentile(0.99) * 1000 << ", max " << m_Max * 1000;
+    return stream.str();
+}
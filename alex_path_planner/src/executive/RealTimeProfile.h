@@ -0,0 +1,123 @@
+#ifndef SRC_REALTIMEPROFILE_H
+#define SRC_REALTIMEPROFILE_H
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+/**
+ * Opt-in settings for running the planner more like a real-time task, for computers that are shared with a lot of
+ * other nodes. Each one is optional: threads can be pinned to some CPUs, the planning thread can be run under
+ * SCHED_FIFO so other (normal priority) processes can't preempt it, and memory can be locked and pre-faulted so the
+ * planner doesn't stall on page faults mid-cycle.
+ *
+ * Most of this needs privileges (CAP_SYS_NICE for SCHED_FIFO, CAP_IPC_LOCK or a high enough memlock limit for locking).
+ * When we don't have them we say so and carry on without, since planning a bit late beats not planning at all.
+ */
+class RealTimeProfile {
+public:
+    // CPUs to pin to. Empty leaves them wherever the OS likes
+    std::vector<int> Cpus;
+    // SCHED_FIFO priority (1-99) for the planning thread, or 0 to keep normal scheduling
+    int Priority = 0;
+    // whether to lock the process's memory (now and in future) into RAM
+    bool LockMemory = false;
+    // how much heap (bytes) to fault in up front and keep hold of, on top of the stack
+    size_t PrefaultBytes = 0;
+
+    /**
+     * @return whether any of it is turned on
+     */
+    bool enabled() const;
+
+    /**
+     * Pin the calling thread to the CPUs and, if asked, give it the FIFO priority.
+     * @param realTime whether to use SCHED_FIFO. Background threads only get pinned
+     * @param output where to complain about anything that didn't work
+     * @return whether everything asked for worked
+     */
+    bool applyToThisThread(bool realTime, std::ostream& output) const;
+
+    /**
+     * Make the calling thread nicer than normal, for background work that shouldn't compete with the planning thread.
+     * This doesn't need any privileges so it works whether or not the profile is on.
+     * @param output where to complain if it doesn't work
+     * @return whether it worked
+     */
+    static bool lowerThisThreadPriority(std::ostream& output);
+
+    /**
+     * Lock and pre-fault memory, if asked. This is process-wide so it only needs to happen once.
+     * @param output
+     * @return whether everything asked for worked
+     */
+    bool prepareMemory(std::ostream& output) const;
+
+    /**
+     * Parse a list of CPUs like "2,3" or "2-5,7".
+     * @param cpus
+     * @return
+     */
+    static std::vector<int> parseCpus(const std::string& cpus);
+
+    /**
+     * Histogram of how far each planning cycle's period was from what it should have been.
+     */
+    class JitterHistogram {
+    public:
+        /**
+         * @param binWidth width of each bin (s)
+         * @param bins bins either side of zero. Anything further out goes in the end bins
+         */
+        explicit JitterHistogram(double binWidth = 0.001, int bins = 50);
+
+        /**
+         * @param jitter actual period minus the ideal one (s)
+         */
+        void record(double jitter);
+
+        /**
+         * @return number of cycles recorded
+         */
+        unsigned long count() const;
+
+        /**
+         * @param fraction 0 to 1
+         * @return the jitter (s) that fraction of cycles were at or under, to the nearest bin
+         */
+        double percentile(double fraction) const;
+
+        /**
+         * @return worst (largest) jitter recorded (s)
+         */
+        double max() const;
+
+        /**
+         * Forget everything recorded.
+         */
+        void clear();
+
+        /**
+         * @return one line summary for logging
+         */
+        std::string summary() const;
+
+    private:
+        double m_BinWidth;
+        int m_Bins;
+        // 2 * bins + 1 counts, the middle one centred on zero
+        std::vector<unsigned long> m_Counts;
+        unsigned long m_Count = 0;
+        double m_Max = 0;
+    };
+
+private:
+    // stack to fault in when preparing memory
+    static constexpr size_t c_PrefaultStackBytes = 256 * 1024;
+
+    // nice value for background threads
+    static constexpr int c_BackgroundNice = 10;
+};
+
+
+#endif //SRC_REALTIMEPROFILE_H
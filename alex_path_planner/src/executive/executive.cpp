@@ -8,8 +8,11 @@
 #include "../planner/AStarPlanner.h"
 #include "../common/map/GeoTiffMap.h"
 #include "../common/map/GridWorldMap.h"
+#include "../common/map/MapCache.h"
 #include "../planner/PotentialFieldPlanner.h"
 #include "../planner/BitStarPlanner.h"
+#include "../planner/LatticePlanner.h"
+#include "../planner/ContingencyPlanner.h"
 #include <iomanip> // readable log timestamps
 
 using namespace std;
@@ -18,13 +21,37 @@ Executive::Executive(TrajectoryPublisher *trajectoryPublisher)
 {
     m_TrajectoryPublisher = trajectoryPublisher;
     m_PlannerConfig.setNowFunction([&] { return m_TrajectoryPublisher->getTime(); });
+    // planners come and go each cycle but checks on the plan we're following can carry over
+    m_PlannerConfig.setCollisionCache(std::make_shared<CollisionCache>());
+    m_PlannerConfig.setMotionPrimitives(std::make_shared<MotionPrimitives>());
+    m_TourThread = thread(&Executive::tourLoop, this);
+    m_ContingencyThread = thread(&Executive::contingencyLoop, this);
+    m_RoadmapThread = thread(&Executive::roadmapLoop, this);
     // readable log timestamps instead of scientific notation
     cerr << fixed << showpoint << setprecision(9);
 }
 
 Executive::~Executive() {
     terminate();
-    m_PlanningFuture.wait_for(chrono::seconds(2));
+    if (m_PlanningFuture.valid()) m_PlanningFuture.wait_for(chrono::seconds(2));
+    {
+        std::lock_guard<std::mutex> lock(m_RibbonManagerMutex);
+        m_TourRunning = false;
+    }
+    m_TourCV.notify_all();
+    m_TourThread.join();
+    {
+        std::lock_guard<std::mutex> lock(m_ContingencyMutex);
+        m_ContingencyRunning = false;
+    }
+    m_ContingencyCV.notify_all();
+    m_ContingencyThread.join();
+    {
+        std::lock_guard<std::mutex> lock(m_RoadmapMutex);
+        m_RoadmapRunning = false;
+    }
+    m_RoadmapCV.notify_all();
+    m_RoadmapThread.join();
 }
 
 double Executive::getCurrentTime()
@@ -36,8 +63,9 @@ double Executive::getCurrentTime()
 
 void Executive::updateCovered(double x, double y, double speed, double heading, double t)
 {
+    // the tour thread reads the last state under the ribbon manager's lock too
+    std::lock_guard<std::mutex> lock(m_RibbonManagerMutex);
     if ((m_LastHeading - heading) / m_LastUpdateTime <= c_CoverageHeadingRateMax) {
-        std::lock_guard<std::mutex> lock(m_RibbonManagerMutex);
         m_RibbonManager.cover(x, y, false);
     }
     m_LastUpdateTime = t; m_LastHeading = heading;
@@ -49,12 +77,60 @@ void Executive::setPlanningTime(double planning_time)
     m_PlanningTimeIdeal = planning_time;
 }
 
+void Executive::setIntegrateObstaclePenalty(bool integrate)
+{
+    m_PlannerConfig.setIntegrateObstaclePenalty(integrate);
+}
+
+void Executive::setSearchMemoryLimit(size_t bytes)
+{
+    m_PlannerConfig.setSearchMemoryLimit(bytes);
+}
+
+void Executive::setFootprint(double length, double width)
+{
+    auto footprint = std::make_shared<Footprint>(length, width);
+    std::lock_guard<std::mutex> lock(m_FootprintMutex);
+    m_NewFootprint = footprint;
+}
+
+void Executive::setRoadmapNodes(int nodes)
+{
+    std::lock_guard<std::mutex> lock(m_RoadmapMutex);
+    m_RoadmapNodes = nodes;
+}
+
+void Executive::setRealTimeProfile(const RealTimeProfile& profile)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_ProfileMutex);
+        m_Profile = profile;
+        m_ProfileVersion++;
+    }
+}
+
+RealTimeProfile::JitterHistogram Executive::jitter()
+{
+    std::lock_guard<std::mutex> lock(m_ProfileMutex);
+    return m_Jitter;
+}
+
 void Executive::planLoop() {
     double trialStartTime = m_TrajectoryPublisher->getTime(), cumulativeCollisionPenalty = 0;
 
     try {
         cerr << "Initializing planner" << endl;
 
+        RealTimeProfile profile;
+        {
+            std::lock_guard<std::mutex> lock(m_ProfileMutex);
+            profile = m_Profile;
+        }
+        if (profile.enabled()) {
+            profile.prepareMemory(*m_PlannerConfig.output());
+            profile.applyToThisThread(true, *m_PlannerConfig.output());
+        }
+
         { // new scope to use RAII and not mess with later "lock" variable
             unique_lock<mutex> lock(m_PlannerStateMutex);
             m_CancelCV.wait_for(lock, chrono::seconds(2), [=] { return m_PlannerState != PlannerState::Cancelled; });
@@ -79,8 +155,20 @@ void Executive::planLoop() {
         // keep track of how many times in a row we fail to find a plan
         int failureCount = 0;
 
+        double lastStartTime = -1;
+
+        // what ribbons were last displayed and when, so they're only sent again when they change
+        uint64_t displayedRibbonsVersion = 0;
+        double displayedRibbonsTime = -1;
         while (true) {
             double startTime = m_TrajectoryPublisher->getTime();
+            if (lastStartTime != -1) {
+                std::lock_guard<std::mutex> lock(m_ProfileMutex);
+                m_Jitter.record(startTime - lastStartTime - m_PlanningTimeIdeal);
+                if (profile.enabled() && m_Jitter.count() % c_JitterReportInterval == 0)
+                    *m_PlannerConfig.output() << m_Jitter.summary() << endl;
+            }
+            lastStartTime = startTime;
             // logging time each time through the loop for making sure we're hitting the time bound
             // cerr << startTime << ": Executive.planLoop() starting " << std::endl;
 
@@ -99,6 +187,9 @@ void Executive::planLoop() {
                 case WhichPlanner::BitStar:
                     planner = std::unique_ptr<Planner>(new BitStarPlanner);
                     break;
+                case WhichPlanner::Lattice:
+                    planner = std::unique_ptr<Planner>(new LatticePlanner);
+                    break;
                 default:
                     throw invalid_argument("Unrecognized case for m_WhichPlanner.");
             }
@@ -124,7 +215,12 @@ void Executive::planLoop() {
             // display ribbons
             { // one more time
                 std::lock_guard<std::mutex> lock1(m_RibbonManagerMutex);
-                m_TrajectoryPublisher->displayRibbons(m_RibbonManager);
+                if (m_RibbonManager.version() != displayedRibbonsVersion ||
+                    startTime - displayedRibbonsTime >= c_DisplayRefreshInterval) {
+                    m_TrajectoryPublisher->displayRibbons(m_RibbonManager);
+                    displayedRibbonsVersion = m_RibbonManager.version();
+                    displayedRibbonsTime = startTime;
+                }
             }
 
             // if the state estimator returned an error naively do it ourselves
@@ -158,6 +254,19 @@ void Executive::planLoop() {
                     }
                 }
             }
+            // pick up a new footprint if it's been set
+            {
+                std::lock_guard<std::mutex> lock1(m_FootprintMutex);
+                if (m_NewFootprint) {
+                    m_PlannerConfig.setFootprint(*m_NewFootprint);
+                    m_NewFootprint = nullptr;
+                }
+            }
+            // catch up with any changes to a live map. The contingency thread has its own snapshot, so there's no
+            // waiting for it
+            m_PlannerConfig.map()->refresh();
+            // keep a roadmap ready for this map and survey
+            updateRoadmap();
 
             // TODOSJW: Do I need to change this to remove 1 Hz replanning?
             if (!c_ReusePlanEnabled) stats.Plan = DubinsPlan();
@@ -169,12 +278,18 @@ void Executive::planLoop() {
             // SJW: I think this is irrelevant to removing 1 Hz replanning for BIT*.
             // shrink turning radius (experimental)
             if (c_RadiusShrinkEnabled) {
-                m_PlannerConfig.setTurningRadius(m_PlannerConfig.turningRadius() - c_RadiusShrinkAmount);
+                setTurningRadius(m_PlannerConfig.turningRadius() - c_RadiusShrinkAmount);
                 m_PlannerConfig.setCoverageTurningRadius(
                         m_PlannerConfig.coverageTurningRadius() - c_RadiusShrinkAmount);
                 m_RadiusShrink += c_RadiusShrinkAmount;
             }
 
+            // bring the obstacle managers up to date with this cycle's contacts
+            ingestContacts(startState);
+
+            // get something safe ready in case planning fails
+            requestContingency(startState);
+
             // check for collision penalty
             double collisionPenalty = 0;
             if (m_UseGaussianDynamicObstacles) {
@@ -236,6 +351,11 @@ void Executive::planLoop() {
                         }
                         // If we have no plan, then do indeed plan.
                     default:
+                        // make room for about as much as last time up front, rather than growing into it mid-search
+                        if (profile.enabled()) {
+                            auto samplingBasedPlanner = dynamic_cast<SamplingBasedPlanner*>(planner.get());
+                            if (samplingBasedPlanner) samplingBasedPlanner->reserve(stats.PeakVertices, stats.Samples);
+                        }
                         double planning_time_actual_remaining = planning_time_actual - (m_TrajectoryPublisher->getTime() - startTime);
                         //cerr << m_TrajectoryPublisher->getTime() << ": Executive.planLoop() about to call planner.plan() with planning_time_actual_remaining " << planning_time_actual_remaining << endl;
                         stats = planner->plan(
@@ -281,6 +401,27 @@ void Executive::planLoop() {
 //                *m_PlannerConfig.output() << "Failed to meet real-time bound by " << -sleepTime << "ms" << endl;
 //            }
 
+            if (stats.Plan.empty()) {
+                cerr << m_TrajectoryPublisher->getTime() << ": Planner returned empty trajectory." << endl;
+                failureCount++;
+                if (failureCount > 2) {
+                    m_PlannerConfig.setTimeHorizon(m_PlannerConfig.timeHorizon() / 2);
+                    if (m_PlannerConfig.timeHorizon() < m_PlannerConfig.timeMinimum())
+                        // prevent from getting too small
+                        m_PlannerConfig.setTimeHorizon(m_PlannerConfig.timeMinimum());
+                    else {
+                        cerr << "Failed " << failureCount << " times in a row. Reducing time horizon to "
+                             << m_PlannerConfig.timeHorizon() << std::endl;
+                        failureCount = 0;
+                    }
+                }
+                // give the controller the contingency plan rather than nothing
+                stats.Plan = contingency(startState);
+                if (!stats.Plan.empty()) cerr << "Following the contingency plan." << endl;
+            } else {
+                failureCount = 0;
+            }
+
             // display the trajectory
             // cerr << "DEBUG: about to displayTrajectory" << endl;
             auto samples_for_display = stats.Plan.getHalfSecondSamples();
@@ -289,7 +430,6 @@ void Executive::planLoop() {
             // cerr << "DEBUG: just attempted to displayTrajectory" << endl;
 
             if (!stats.Plan.empty()) {
-                failureCount = 0;
                 // send trajectory to controller
                 try {
                     // cerr << "DEBUG: about to attempt to publish plan to controller" << endl;
@@ -324,7 +464,7 @@ void Executive::planLoop() {
 
                     // reset turning radius shrink because we can't follow original plan anymore
                     if (c_RadiusShrinkEnabled) {
-                        m_PlannerConfig.setTurningRadius(m_PlannerConfig.turningRadius() + m_RadiusShrink);
+                        setTurningRadius(m_PlannerConfig.turningRadius() + m_RadiusShrink);
                         m_PlannerConfig.setCoverageTurningRadius(
                                 m_PlannerConfig.coverageTurningRadius() + m_RadiusShrink);
                         m_RadiusShrink = 0;
@@ -336,20 +476,7 @@ void Executive::planLoop() {
                     lastPlanAchievable = true;
                 }
             } else {
-                cerr << m_TrajectoryPublisher->getTime() << ": Planner returned empty trajectory." << endl;
                 startState = State();
-                failureCount++;
-                if (failureCount > 2) {
-                    m_PlannerConfig.setTimeHorizon(m_PlannerConfig.timeHorizon() / 2);
-                    if (m_PlannerConfig.timeHorizon() < m_PlannerConfig.timeMinimum())
-                        // prevent from getting too small
-                        m_PlannerConfig.setTimeHorizon(m_PlannerConfig.timeMinimum());
-                    else {
-                        cerr << "Failed " << failureCount << " times in a row. Reducing time horizon to "
-                             << m_PlannerConfig.timeHorizon() << std::endl;
-                        failureCount = 0;
-                    }
-                }
             }
         }
     }
@@ -362,6 +489,11 @@ void Executive::planLoop() {
         cerr << "Unknown exception thrown in plan loop" << endl;
     }
 
+    {
+        std::lock_guard<std::mutex> lock(m_ProfileMutex);
+        if (m_Profile.enabled()) *m_PlannerConfig.output() << m_Jitter.summary() << endl;
+    }
+
     // task-level stats reporting
     auto trialEndTime = m_TrajectoryPublisher->getTime();
     auto wallClockTime = trialEndTime - trialStartTime;
@@ -379,6 +511,156 @@ void Executive::planLoop() {
     m_CancelCV.notify_all(); // do I need this?
 }
 
+void Executive::setTurningRadius(double turningRadius) {
+    std::lock_guard<std::mutex> lock(m_RibbonManagerMutex);
+    m_PlannerConfig.setTurningRadius(turningRadius);
+}
+
+void Executive::tourLoop() {
+    RibbonTour::SharedPtr tour;
+    auto version = m_RibbonsVersion - 1;
+    unsigned long profileVersion = 0;
+    std::unique_lock<std::mutex> lock(m_RibbonManagerMutex);
+    while (m_TourRunning) {
+        m_TourCV.wait_for(lock, chrono::duration<double>(c_TourPeriod),
+                          [&] { return !m_TourRunning || version != m_RibbonsVersion; });
+        if (!m_TourRunning) break;
+        {
+            // keep to the same CPUs as the planner, but it's background work so no real-time priority
+            std::lock_guard<std::mutex> profileLock(m_ProfileMutex);
+            if (profileVersion != m_ProfileVersion) {
+                profileVersion = m_ProfileVersion;
+                m_Profile.applyToThisThread(false, *m_PlannerConfig.output());
+            }
+        }
+        version = m_RibbonsVersion;
+        if (m_RibbonManager.done() || m_RibbonManager.heuristic() != RibbonManager::Heuristic::TourGuided) continue;
+        auto ribbons = m_RibbonManager.get();
+        auto start = m_LastState;
+        auto turningRadius = m_PlannerConfig.turningRadius();
+        lock.unlock();
+        // start from the last one (if any), which is usually most of the way there already
+        auto deadline = chrono::steady_clock::now() + chrono::duration<double>(c_TourImprovementTime);
+        auto next = RibbonTour::plan(ribbons, start, turningRadius, [&] {
+            return m_TourRunning && chrono::steady_clock::now() < deadline;
+        }, tour);
+        lock.lock();
+        // if ribbons were added or cleared in the meantime, this one's no good
+        if (version != m_RibbonsVersion) continue;
+        tour = next;
+        m_RibbonManager.setTour(tour);
+    }
+}
+
+void Executive::contingencyLoop() {
+    RealTimeProfile::lowerThisThreadPriority(*m_PlannerConfig.output());
+    std::unique_lock<std::mutex> lock(m_ContingencyMutex);
+    while (true) {
+        m_ContingencyCV.wait(lock, [&] { return !m_ContingencyRunning || m_ContingencyRequested; });
+        if (!m_ContingencyRunning) break;
+        m_ContingencyRequested = false;
+        auto start = m_ContingencyStart;
+        auto config = m_ContingencyConfig;
+        lock.unlock();
+        DubinsPlan plan;
+        try {
+            plan = ContingencyPlanner::plan(start, config, c_ContingencyDuration);
+        } catch (const std::exception& e) {
+            cerr << "Exception thrown while making contingency plan: " << e.what() << endl;
+        }
+        lock.lock();
+        // unless there's a newer request by now
+        if (!m_ContingencyRequested) m_Contingency = plan;
+    }
+}
+
+void Executive::roadmapLoop() {
+    RealTimeProfile::lowerThisThreadPriority(*m_PlannerConfig.output());
+    unsigned long built = 0;
+    std::unique_lock<std::mutex> lock(m_RoadmapMutex);
+    while (true) {
+        m_RoadmapCV.wait(lock, [&] { return !m_RoadmapRunning || m_RoadmapRequest != built; });
+        if (!m_RoadmapRunning) break;
+        unsigned long request = built = m_RoadmapRequest;
+        auto config = m_RoadmapConfig;
+        auto ribbons = m_RoadmapRibbons;
+        auto nodes = m_RoadmapNodes;
+        lock.unlock();
+        Roadmap::SharedPtr roadmap;
+        try {
+            roadmap = Roadmap::build(config.map(), ribbons, config.turningRadius(), config.coverageTurningRadius(),
+                                     config.footprint(), config.collisionCheckingIncrement(), nodes, [&] {
+                return m_RoadmapRunning && m_RoadmapRequest == request;
+            });
+        } catch (const std::exception& e) {
+            cerr << "Exception thrown while building roadmap: " << e.what() << endl;
+        }
+        lock.lock();
+        // unless there's a newer request by now
+        if (m_RoadmapRequest != request) continue;
+        m_Roadmap = roadmap;
+        if (m_Roadmap) {
+            cerr << "Built roadmap with " << m_Roadmap->nodes().size() << " poses and " << m_Roadmap->size() <<
+                 " connections" << endl;
+        }
+    }
+}
+
+void Executive::updateRoadmap() {
+    std::lock_guard<std::mutex> lock(m_RoadmapMutex);
+    const auto& map = *m_PlannerConfig.map();
+    if (m_RoadmapNodes <= 0 || map.live()) {
+        m_PlannerConfig.setRoadmap(nullptr);
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock1(m_RibbonManagerMutex);
+        auto key = std::make_tuple(map.version(), m_RibbonsVersion, m_RoadmapNodes, m_PlannerConfig.turningRadius(),
+                                   m_PlannerConfig.coverageTurningRadius(), m_PlannerConfig.footprint().length(),
+                                   m_PlannerConfig.footprint().width());
+        if (key != m_RoadmapKey) {
+            m_RoadmapKey = key;
+            m_RoadmapConfig = m_PlannerConfig;
+            m_RoadmapRibbons = m_RibbonManager;
+            m_Roadmap = nullptr;
+            m_RoadmapRequest++;
+            m_RoadmapCV.notify_all();
+        }
+    }
+    m_PlannerConfig.setRoadmap(m_Roadmap);
+}
+
+void Executive::requestContingency(const State& start) {
+    if (start.time() == -1) return;
+    auto config = m_PlannerConfig;
+    // the binary obstacles are cheap to copy and the planning thread keeps changing the real ones. The Gaussian ones
+    // get left out, but they're centred on the same contacts
+    if (m_IgnoreDynamicObstacles) config.setObstaclesManager(std::make_shared<DynamicObstaclesManager>());
+    else config.setObstaclesManager(std::make_shared<BinaryDynamicObstaclesManager>(*m_BinaryDynamicObstaclesManager));
+    // and a live map gets refreshed by the planning thread, so it gets a snapshot too
+    if (config.map() && config.map()->live()) config.setMap(config.map()->snapshot());
+    {
+        std::lock_guard<std::mutex> lock(m_ContingencyMutex);
+        m_ContingencyStart = start;
+        m_ContingencyConfig = config;
+        m_ContingencyRequested = true;
+        m_Contingency = DubinsPlan();
+    }
+    m_ContingencyCV.notify_all();
+}
+
+DubinsPlan Executive::contingency(const State& start) {
+    std::lock_guard<std::mutex> lock(m_ContingencyMutex);
+    if (m_ContingencyRequested || m_Contingency.empty() || m_ContingencyStart.time() != start.time() ||
+        !m_ContingencyStart.isCoLocated(start)) return DubinsPlan();
+    return m_Contingency;
+}
+
+RibbonTour::SharedPtr Executive::tour() {
+    std::lock_guard<std::mutex> lock(m_RibbonManagerMutex);
+    return m_RibbonManager.tour();
+}
+
 void Executive::terminate()
 {
     // cancel planner so thread can finish
@@ -386,23 +668,33 @@ void Executive::terminate()
 }
 
 void Executive::updateDynamicObstacle(uint32_t mmsi, State obstacle, double width, double length) {
-    cerr << "DEBUG: Executive.updateDynamicObstacle() called" << endl;
-//    m_DynamicObstaclesManager.update(mmsi, inventDistributions(obstacle));
-    m_BinaryDynamicObstaclesManager->update(mmsi, obstacle.x(), obstacle.y(), obstacle.heading(),
-            obstacle.speed(), obstacle.time(), width, length);
+    // just buffer it; the planning thread hands the relevant contacts to the obstacle managers once per cycle
+    m_ContactIngestor.report(mmsi, obstacle, width, length);
+}
+
+void Executive::ingestContacts(const State& vessel) {
+    auto changes = m_ContactIngestor.ingest(vessel, m_PlannerConfig.maxSpeed(), m_PlannerConfig.timeHorizon());
+    if (changes.Updated.empty() && changes.Forgotten.empty()) return;
+    for (const auto& c : changes.Updated) {
+        m_BinaryDynamicObstaclesManager->update(c.Mmsi, c.Report.x(), c.Report.y(), c.Report.heading(),
+                c.Report.speed(), c.Report.time(), c.Width, c.Length);
+    }
+    for (auto mmsi : changes.Forgotten) m_BinaryDynamicObstaclesManager->forget(mmsi);
     {
         std::lock_guard<std::mutex> lock(m_GaussianDynamicObstaclesManagerMutex);
-        // cerr << "DEBUG: Executive.updateDynamicObstacle() has acquired m_GaussianDynamicObstaclesManagerMutex" << endl;
-        // cerr << "DEBUG: Executive.updateDynamicObstacle(): PRIOR to update, m_GaussianDynamicObstaclesManager.size(): " << m_GaussianDynamicObstaclesManager->size() << endl;
-        m_GaussianDynamicObstaclesManager->update(
-            mmsi,
-            obstacle.x(),
-            obstacle.y(),
-            obstacle.heading(),
-            obstacle.speed(),
-            obstacle.time()
-        );
-        // cerr << "DEBUG: Executive.updateDynamicObstacle(): AFTER update, m_GaussianDynamicObstaclesManager.size(): " << m_GaussianDynamicObstaclesManager->size() << endl;
+        for (const auto& c : changes.Updated) {
+            m_GaussianDynamicObstaclesManager->update(c.Mmsi, c.Report.x(), c.Report.y(), c.Report.heading(),
+                    c.Report.speed(), c.Report.time());
+        }
+        for (auto mmsi : changes.Forgotten) m_GaussianDynamicObstaclesManager->forget(mmsi);
+    }
+    // reports come in several times a second, so only log when the counts change
+    if (m_ContactIngestor.tracked() != m_LoggedTrackedContacts ||
+            m_ContactIngestor.relevant() != m_LoggedRelevantContacts) {
+        m_LoggedTrackedContacts = m_ContactIngestor.tracked();
+        m_LoggedRelevantContacts = m_ContactIngestor.relevant();
+        *m_PlannerConfig.output() << "Tracking " << m_LoggedTrackedContacts << " contacts, "
+            << m_LoggedRelevantContacts << " of them relevant" << endl;
     }
 }
 
@@ -417,7 +709,7 @@ void Executive::refreshMap(const std::string& pathToMapFile, double latitude, do
     // Run asynchronously and headless. The ol' fire-off-and-pray method
     thread([this, pathToMapFile, latitude, longitude] {
         std::lock_guard<std::mutex> lock(m_MapMutex);
-        // skip re-loading if we've already loaded it
+        // MapCache takes care of not re-loading maps we already have
 //        if (m_CurrentMapPath != pathToMapFile) {
             if (pathToMapFile.empty()) {
                 m_NewMap = make_shared<Map>();
@@ -440,9 +732,14 @@ void Executive::refreshMap(const std::string& pathToMapFile, double latitude, do
                 if (pathToMapFile.find(".map") == -1) {
                     // don't try to display geotiff maps
                     m_TrajectoryPublisher->displayMap("");
-                    m_NewMap = make_shared<GeoTiffMap>(pathToMapFile, longitude, latitude);
+                    m_NewMap = MapCache::global().get(pathToMapFile, latitude, longitude, [&] {
+                        return make_shared<GeoTiffMap>(pathToMapFile, longitude, latitude);
+                    });
                 } else {
-                    m_NewMap = make_shared<GridWorldMap>(pathToMapFile);
+                    // gridworld maps don't have an origin
+                    m_NewMap = MapCache::global().get(pathToMapFile, 0, 0, [&] {
+                        return make_shared<GridWorldMap>(pathToMapFile);
+                    });
                     m_TrajectoryPublisher->displayMap(pathToMapFile);
                 }
                 m_CurrentMapPath = pathToMapFile;
@@ -466,6 +763,8 @@ void Executive::refreshMap(const std::string& pathToMapFile, double latitude, do
 void Executive::addRibbon(double x1, double y1, double x2, double y2) {
     std::lock_guard<std::mutex> lock(m_RibbonManagerMutex);
     m_RibbonManager.add(x1, y1, x2, y2);
+    m_RibbonsVersion++;
+    m_TourCV.notify_all();
     std::cerr << "Executive::addRibbon: " << x1 << ", " << y1 << " - " << x2 << ", " << y2 << std::endl;
 }
 
@@ -485,6 +784,8 @@ void Executive::addRibbon(double x1, double y1, double x2, double y2) {
 void Executive::clearRibbons() {
     std::lock_guard<std::mutex> lock(m_RibbonManagerMutex);
     m_RibbonManager = RibbonManager(RibbonManager::Heuristic::TspPointRobotNoSplitKRibbons, m_PlannerConfig.turningRadius(), 2);
+    m_RibbonsVersion++;
+    m_TourCV.notify_all();
 }
 
 void Executive::setConfiguration(double turningRadius, double coverageTurningRadius, double maxSpeed, double slowSpeed,
@@ -492,7 +793,7 @@ void Executive::setConfiguration(double turningRadius, double coverageTurningRad
                                  double collisionCheckingIncrement, int initialSamples, bool useBrownPaths,
                                  bool useGaussianDynamicObstacles, bool ignoreDynamicObstacles,
                                  WhichPlanner whichPlanner) {
-    m_PlannerConfig.setTurningRadius(turningRadius);
+    setTurningRadius(turningRadius);
     m_PlannerConfig.setCoverageTurningRadius(coverageTurningRadius);
     m_PlannerConfig.setMaxSpeed(maxSpeed);
     m_PlannerConfig.setSlowSpeed(slowSpeed);
@@ -505,6 +806,7 @@ void Executive::setConfiguration(double turningRadius, double coverageTurningRad
         case 2: m_RibbonManager.setHeuristic(RibbonManager::Heuristic::MaxDistance); break;
         case 3: m_RibbonManager.setHeuristic(RibbonManager::Heuristic::TspDubinsNoSplitAllRibbons); break;
         case 4: m_RibbonManager.setHeuristic(RibbonManager::Heuristic::TspDubinsNoSplitKRibbons); break;
+        case 5: m_RibbonManager.setHeuristic(RibbonManager::Heuristic::TourGuided); break;
         default: *m_PlannerConfig.output() << "Unknown heuristic. Ignoring." << endl; break;
     }
     m_PlannerConfig.setTimeHorizon(timeHorizon);
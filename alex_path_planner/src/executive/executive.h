@@ -1,14 +1,18 @@
 #ifndef SRC_EXECUTIVE_H
 #define SRC_EXECUTIVE_H
 
+#include <atomic>
 #include <condition_variable>
 #include "../planner/utilities/RibbonManager.h"
 #include "../trajectory_publisher.h"
 #include "../planner/Planner.h"
 #include "../common/dynamic_obstacles/BinaryDynamicObstaclesManager.h"
 #include "../common/dynamic_obstacles/GaussianDynamicObstaclesManager.h"
+#include "ContactIngestor.h"
+#include "RealTimeProfile.h"
 #include <future>
 #include <fstream>
+#include <tuple>
 
 /**
  * Class calls the planner and manages associated configurations and other data.
@@ -57,7 +61,8 @@ public:
     void clearRibbons();
 
     /**
-     * Update information about a dynamic obstacle.
+     * Update information about a dynamic obstacle. The report is buffered and only reaches the planner at the start of
+     * the next planning cycle, and only if the obstacle could matter within the time horizon.
      * @param mmsi
      * @param obstacle
      */
@@ -90,6 +95,12 @@ public:
      */
     static double getCurrentTime();
 
+    /**
+     * Get the latest global tour of the ribbons from the background thread. Public for testing.
+     * @return the tour, or null if there isn't one (yet)
+     */
+    RibbonTour::SharedPtr tour();
+
     /**
      * Enum to represent which planner to use. Passed to setConfiguration.
      * 
@@ -99,6 +110,7 @@ public:
         AStar, // Real-Time BIT* (RBPC) by Alex Brown
         PotentialField, // Alex Brown
         BitStar, // BIT* implementation by Stephen Wissow
+        Lattice, // state lattice with precomputed motion primitives
     };
 
     /**
@@ -124,6 +136,47 @@ public:
 
     void setPlanningTime(double planning_time);
 
+    /**
+     * Choose whether the planner integrates the dynamic obstacle penalty along edges in closed form (where the obstacles
+     * allow it) instead of sampling it every collision checking increment.
+     * @param integrate
+     */
+    void setIntegrateObstaclePenalty(bool integrate);
+
+    /**
+     * Limit the memory the search holds onto in vertices. When it gets close the search drops its worst open vertices.
+     * @param bytes the limit, or 0 for no limit
+     */
+    void setSearchMemoryLimit(size_t bytes);
+
+    /**
+     * Set the size of the vessel, so plans keep the whole hull off the map's obstacles rather than just its position.
+     * Takes effect from the next planning cycle.
+     * @param length metres, or 0 (along with width) to treat the vessel as a point
+     * @param width metres
+     */
+    void setFootprint(double length, double width);
+
+    /**
+     * Have a low priority background thread build a roadmap of this many poses over the survey area whenever the map
+     * or the ribbons change, and have the A* planner search it once it's ready. Only maps that don't change on their
+     * own get a roadmap; with a live map planning goes on sampling as usual.
+     * @param nodes how many poses, or 0 not to use a roadmap
+     */
+    void setRoadmapNodes(int nodes);
+
+    /**
+     * Set the real-time profile. It applies from the next time the planner starts (and to the tour thread as soon as
+     * it wakes up).
+     * @param profile
+     */
+    void setRealTimeProfile(const RealTimeProfile& profile);
+
+    /**
+     * @return a copy of the planning cycle jitter recorded so far
+     */
+    RealTimeProfile::JitterHistogram jitter();
+
 private:
 
     /**
@@ -148,6 +201,44 @@ private:
     double m_LastHeading = 0; // TODO! -- use moving average or something
     State m_LastState;
 
+    // global ribbon tour, kept improving in the background when the heuristic is TourGuided. The tour thread waits on
+    // m_TourCV with m_RibbonManagerMutex, and m_RibbonsVersion (also under that mutex) changes when ribbons are added
+    // or cleared so it knows to re-plan. It plans from m_LastState with the planner's turning radius, so both are only
+    // written under that mutex
+    std::thread m_TourThread;
+    std::atomic<bool> m_TourRunning{true};
+    std::condition_variable m_TourCV;
+    unsigned long m_RibbonsVersion = 0;
+
+    // contingency plan, kept ready by a low priority background thread so there's something safe to follow straight
+    // away when planning fails. Each cycle the planning thread posts the state it's planning from (with a config
+    // holding a snapshot of the obstacles, and of the map if it's live) and the contingency thread answers with a plan
+    // from that state, all under m_ContingencyMutex
+    std::thread m_ContingencyThread;
+    bool m_ContingencyRunning = true;
+    std::mutex m_ContingencyMutex;
+    std::condition_variable m_ContingencyCV;
+    bool m_ContingencyRequested = false;
+    State m_ContingencyStart;
+    PlannerConfig m_ContingencyConfig = PlannerConfig(&std::cerr);
+    DubinsPlan m_Contingency;
+
+    // static roadmap over the survey area, built by a low priority background thread for the planner to search. The
+    // planning thread asks for a new one (with a snapshot of the config and ribbons) whenever the map, the ribbons or
+    // anything else it depends on changes, and installs it in the planner config once it's ready, all under
+    // m_RoadmapMutex. Each request bumps m_RoadmapRequest so a build that's been overtaken knows to give up
+    std::thread m_RoadmapThread;
+    std::atomic<bool> m_RoadmapRunning{true};
+    std::mutex m_RoadmapMutex;
+    std::condition_variable m_RoadmapCV;
+    std::atomic<unsigned long> m_RoadmapRequest{0};
+    int m_RoadmapNodes = 0;
+    // map version, ribbons version, poses, turning radii and footprint the last request was for
+    std::tuple<unsigned long, unsigned long, int, double, double, double, double> m_RoadmapKey;
+    PlannerConfig m_RoadmapConfig = PlannerConfig(&std::cerr);
+    RibbonManager m_RoadmapRibbons;
+    Roadmap::SharedPtr m_Roadmap;
+
     // TODO! -- use ROS_INFO
     PlannerConfig m_PlannerConfig = PlannerConfig(&std::cerr);
 
@@ -172,11 +263,21 @@ private:
     // synchronize to Gaussian dynamic obstacles data
     std::mutex m_GaussianDynamicObstaclesManagerMutex;
 
+    // buffers contact reports between cycles and decides which ones the obstacle managers get
+    ContactIngestor m_ContactIngestor;
+    // contact counts last logged, so we only say something when they change
+    size_t m_LoggedTrackedContacts = 0, m_LoggedRelevantContacts = 0;
+
     // map info (start with no new map)
     std::shared_ptr<Map> m_NewMap = nullptr;
     std::string m_CurrentMapPath = "";
     std::mutex m_MapMutex;
 
+    // footprint info (start with no new footprint). The planning thread copies its config all over the place, so a new
+    // footprint is only applied there, at the start of a cycle
+    std::shared_ptr<Footprint> m_NewFootprint = nullptr;
+    std::mutex m_FootprintMutex;
+
     // hold onto the thread doing planning, for elegant error handling and shutdown I guess
     std::future<void> m_PlanningFuture;
 
@@ -201,8 +302,28 @@ private:
     //static constexpr double c_PlanningTimeSeconds = 0.85;
     static constexpr double c_PlanningTimeOverhead = 0.15;
 
+    // how often to work on the tour, and for how long (s)
+    static constexpr double c_TourPeriod = 1;
+    static constexpr double c_TourImprovementTime = 0.2;
+
+    // the ribbons are only redisplayed when they change, or this often (s) so anyone who starts watching late sees them
+    static constexpr double c_DisplayRefreshInterval = 5;
+
     double m_PlanningTimeIdeal = 1.0;
 
+    // real-time profile, with a version so the tour thread knows when to re-apply it, and the cycle jitter so far, all
+    // under the profile mutex
+    std::mutex m_ProfileMutex;
+    RealTimeProfile m_Profile;
+    unsigned long m_ProfileVersion = 0;
+    RealTimeProfile::JitterHistogram m_Jitter;
+
+    // how often (cycles) to log the jitter when the profile is on
+    static constexpr int c_JitterReportInterval = 60;
+
+    // how far ahead (s) the contingency plan is judged on the obstacles
+    static constexpr double c_ContingencyDuration = 10;
+
     /**
      * Make sure the threads can exit and kill the planner (if it's running).
      */
@@ -213,6 +334,55 @@ private:
      */
     void planLoop();
 
+    /**
+     * Set the planner's turning radius under the ribbon manager's lock, since the tour thread reads it.
+     * @param turningRadius
+     */
+    void setTurningRadius(double turningRadius);
+
+    /**
+     * Keep improving the global ribbon tour from wherever we are, handing it to the ribbon manager so the planner can
+     * follow it. Runs in its own thread until the executive is destroyed.
+     */
+    void tourLoop();
+
+    /**
+     * Keep making contingency plans from the states the planning thread posts. Runs in its own thread until the
+     * executive is destroyed.
+     */
+    void contingencyLoop();
+
+    /**
+     * Build roadmaps as the planning thread asks for them. Runs in its own thread until the executive is destroyed.
+     */
+    void roadmapLoop();
+
+    /**
+     * Ask for a new roadmap if what the current one was built for has changed, and give the planner config the one
+     * that's ready (if any).
+     */
+    void updateRoadmap();
+
+    /**
+     * Post the state we're about to plan from so the contingency thread can get a plan ready from it.
+     * @param start
+     */
+    void requestContingency(const State& start);
+
+    /**
+     * Get the contingency plan from the given start, without waiting.
+     * @param start
+     * @return the plan, or an empty one if it isn't ready or couldn't be made
+     */
+    DubinsPlan contingency(const State& start);
+
+    /**
+     * Pass the contacts reported since last cycle on to the obstacle managers, forgetting ones that are stale or can't
+     * reach the vessel within the time horizon.
+     * @param vessel the state we're about to plan from
+     */
+    void ingestContacts(const State& vessel);
+
     /**
      * Nothing provides the distributions for dynamic obstacles yet so the executive invents them.
      * @param obstacle
@@ -31,6 +31,23 @@ public:
     {
         m_Executive = new Executive(this);
 
+        // real-time profile, all off by default
+        ros::NodeHandle privateNodeHandle("~");
+        RealTimeProfile profile;
+        std::string cpus;
+        int prefaultMB = 0;
+        privateNodeHandle.param("realtime_cpus", cpus, cpus);
+        privateNodeHandle.param("realtime_priority", profile.Priority, profile.Priority);
+        privateNodeHandle.param("realtime_lock_memory", profile.LockMemory, profile.LockMemory);
+        privateNodeHandle.param("realtime_prefault_mb", prefaultMB, prefaultMB);
+        try {
+            profile.Cpus = RealTimeProfile::parseCpus(cpus);
+        } catch (const std::invalid_argument& e) {
+            ROS_ERROR_STREAM(e.what() << ". Not pinning the planner to any CPUs.");
+        }
+        profile.PrefaultBytes = prefaultMB > 0? (size_t)prefaultMB << 20 : 0;
+        m_Executive->setRealTimeProfile(profile);
+
     m_contact_sub = m_node_handle.subscribe("contact", 10, &PathPlanner::contactCallback, this);
     m_origin_sub = m_node_handle.subscribe("project11/origin", 1, &PathPlanner::originCallback, this);
 
@@ -221,6 +238,10 @@ public:
                                       config.use_brown_paths,
                                       config.dynamic_obstacles == 1, config.ignore_dynamic_obstacles,
                                       which_planner);
+        m_Executive->setIntegrateObstaclePenalty(config.integrate_obstacle_penalty);
+        m_Executive->setSearchMemoryLimit((size_t)config.search_memory_limit << 20);
+        m_Executive->setFootprint(config.vessel_length, config.vessel_width);
+        m_Executive->setRoadmapNodes(config.roadmap_nodes);
         m_Executive->setPlannerVisualization(config.dump_visualization, config.visualization_file);
     }
 
@@ -403,6 +424,9 @@ public:
         statsMsg.plan_time_penalty = stats.PlanTimePenalty;
         statsMsg.plan_h_value = stats.PlanHValue;
         statsMsg.plan_depth = stats.PlanDepth;
+        statsMsg.peak_vertices = stats.PeakVertices;
+        statsMsg.peak_bytes = stats.PeakBytes;
+        statsMsg.dropped = stats.Dropped;
         statsMsg.collision_penalty = collisionPenalty;
         statsMsg.cpu_time = cpuTime;
         statsMsg.last_plan_achievable = lastPlanAchievable;
@@ -1,4 +1,5 @@
 #include <project11_navigation/interfaces/task_to_task_workflow.h>
+#include <tuple>
 #include "executive/executive.h"
 #include "trajectory_publisher.h"
 #include <alex_path_planner_common/Stats.h>
@@ -66,6 +67,7 @@ public:
     transformations_ = std::make_shared<project11::Transformations>(&context_->tfBuffer());
 
     nh.param("step_size", step_size_, step_size_);
+    nh.param("display_tolerance", display_tolerance_, display_tolerance_);
 
     nh.param("output_task_type", output_task_type_, output_task_type_);
     nh.param("output_task_name", output_task_name_, output_task_name_);
@@ -84,12 +86,33 @@ public:
     nh.param("heuristic", heuristic_, heuristic_);
     nh.param("gaussian_dynamic_obstacles", gaussian_dynamic_obstacles_, gaussian_dynamic_obstacles_);
     nh.param("ignore_dynamic_obstacles", ignore_dynamic_obstacles_, ignore_dynamic_obstacles_);
+    nh.param("integrate_obstacle_penalty", integrate_obstacle_penalty_, integrate_obstacle_penalty_);
+    nh.param("search_memory_limit", search_memory_limit_, search_memory_limit_);
+    nh.param("vessel_length", vessel_length_, vessel_length_);
+    nh.param("vessel_width", vessel_width_, vessel_width_);
+    nh.param("roadmap_nodes", roadmap_nodes_, roadmap_nodes_);
     nh.param("planner", planner_, planner_);
 
     nh.param("planning_time", planning_time_, planning_time_);
 
     nh.param("display_local_map", display_local_map_, display_local_map_);
 
+    // real-time profile, all off by default
+    RealTimeProfile profile;
+    std::string realtime_cpus;
+    int realtime_prefault_mb = 0;
+    nh.param("realtime_cpus", realtime_cpus, realtime_cpus);
+    nh.param("realtime_priority", profile.Priority, profile.Priority);
+    nh.param("realtime_lock_memory", profile.LockMemory, profile.LockMemory);
+    nh.param("realtime_prefault_mb", realtime_prefault_mb, realtime_prefault_mb);
+    try {
+      profile.Cpus = RealTimeProfile::parseCpus(realtime_cpus);
+    } catch (const std::invalid_argument& e) {
+      ROS_ERROR_STREAM(e.what() << ". Not pinning the planner to any CPUs.");
+    }
+    profile.PrefaultBytes = realtime_prefault_mb > 0? (size_t)realtime_prefault_mb << 20 : 0;
+    executive_->setRealTimeProfile(profile);
+
     stats_pub_ = nh.advertise<alex_path_planner_common::Stats>("stats", 1);
     task_level_stats_pub_ = nh.advertise<alex_path_planner_common::TaskLevelStats>("task_level_stats", 1);
     // use a non-private node handle for the display output
@@ -170,6 +193,21 @@ public:
       bool ignore_dynamic_obstacles = ignore_dynamic_obstacles_;
       if(data["ignore_dynamic_obstacles"])
         ignore_dynamic_obstacles = data["ignore_dynamic_obstacles"].as<bool>();
+      bool integrate_obstacle_penalty = integrate_obstacle_penalty_;
+      if(data["integrate_obstacle_penalty"])
+        integrate_obstacle_penalty = data["integrate_obstacle_penalty"].as<bool>();
+      int search_memory_limit = search_memory_limit_;
+      if(data["search_memory_limit"])
+        search_memory_limit = data["search_memory_limit"].as<int>();
+      double vessel_length = vessel_length_;
+      if(data["vessel_length"])
+        vessel_length = data["vessel_length"].as<double>();
+      double vessel_width = vessel_width_;
+      if(data["vessel_width"])
+        vessel_width = data["vessel_width"].as<double>();
+      int roadmap_nodes = roadmap_nodes_;
+      if(data["roadmap_nodes"])
+        roadmap_nodes = data["roadmap_nodes"].as<int>();
       std::string planner = planner_;
       if(data["planner"])
         planner = data["planner"].as<std::string>();
@@ -179,6 +217,10 @@ public:
         planning_time_override_ = data["planning_time"].as<double>();
 
       executive_->setPlanningTime(planning_time_override_);
+      executive_->setIntegrateObstaclePenalty(integrate_obstacle_penalty);
+      executive_->setSearchMemoryLimit(search_memory_limit > 0? (size_t)search_memory_limit << 20 : 0);
+      executive_->setFootprint(vessel_length, vessel_width);
+      executive_->setRoadmapNodes(roadmap_nodes);
 
       Executive::WhichPlanner which_planner = Executive::AStar;
       if (planner == "AStarPlanner")
@@ -187,6 +229,8 @@ public:
         which_planner = Executive::PotentialField;
       else if (planner == "BitStar")
         which_planner = Executive::BitStar;
+      else if (planner == "Lattice")
+        which_planner = Executive::Lattice;
 
       executive_->setConfiguration(turning_radius, coverage_turning_radius,
                                    max_speed, slow_speed, line_width, branching_factor,
@@ -227,6 +271,7 @@ public:
       {
         ros::NodeHandle nh;
         trajectory_displayer_ = std::make_shared<TrajectoryDisplayerHelper>(nh, &display_pub_, *transformations_, odom.header.frame_id);
+        trajectory_displayer_->setTolerance(display_tolerance_);
       }
       executive_->updateCovered(
             odom.pose.pose.position.x,
@@ -316,21 +361,14 @@ public:
       if(data["dubins_sample_interval"])
         step_size = data["dubins_sample_interval"].as<double>();
 
-      project11_nav_msgs::CurvedTrajectory curved_trajectory;
-      curved_trajectory.start = msg.poses.front();
-      curved_trajectory.goal = msg.poses.back();
-      std::vector<geometry_msgs::PoseStamped> sampled_trajectory;
-
       for (const auto& d : plan.get())
       {
         auto path = d.unwrap();
 
         double total_distance = path.param[0] + path.param[1] + path.param[2];
         ros::Time current_start_time = ros::Time(d.getStartTime());
-        double speed = d.getSpeed();
         ros::Time current_end_time = ros::Time(d.getEndTime());
 
-        
         if(next_start_time >= current_start_time && next_start_time <= current_end_time)
         {
           if(current_end_time > current_start_time)
@@ -360,86 +398,31 @@ public:
 
           }
         }
+      }
 
-        if(curved_trajectory.curves.empty())
-        {
-          curved_trajectory.start.header.stamp = current_start_time;
-          curved_trajectory.start.pose.position.x = path.qi[0];
-          curved_trajectory.start.pose.position.y = path.qi[1];
-          tf2::Quaternion q(tf2::Vector3(0,0,1), path.qi[2]);
-          curved_trajectory.start.pose.orientation = tf2::toMsg(q);
-        }
-        curved_trajectory.goal.header.stamp = current_end_time;
-        curved_trajectory.goal.pose.position.x = path.qi[3];
-        curved_trajectory.goal.pose.position.y = path.qi[4];
-        tf2::Quaternion q(tf2::Vector3(0,0,1), path.qi[5]);
-        curved_trajectory.goal.pose.orientation = tf2::toMsg(q);
-
-        project11_nav_msgs::Curve c1;
-        c1.length = path.param[0];
-        c1.arrival_time = current_start_time + ros::Duration(c1.length/speed);
-        c1.radius = d.getRho();
-        switch(path.type)
-        {
-          case LSL:
-          case LSR:
-          case LRL:
-            c1.direction = c1.DIRECTION_LEFT;
-            break;
-          default:
-            c1.direction = c1.DIRECTION_RIGHT;
-        }
-        curved_trajectory.curves.push_back(c1);
-
-        project11_nav_msgs::Curve c2;
-        c2.length = path.param[1];
-        c2.arrival_time = c1.arrival_time + ros::Duration(c2.length/speed);
-        c2.radius = d.getRho();
-        switch(path.type)
-        {
-          case RLR:
-            c2.direction = c2.DIRECTION_LEFT;
-            break;
-          case LRL:
-            c2.direction = c2.DIRECTION_RIGHT;
-            break;
-          default:
-            c2.direction = c2.DIRECTION_STRAIGHT;
-        }
-        curved_trajectory.curves.push_back(c2);
-
-        project11_nav_msgs::Curve c3;
-        c3.length = path.param[2];
-        c3.arrival_time = c2.arrival_time + ros::Duration(c3.length/speed);
-        c3.radius = d.getRho();
-        switch(path.type)
-        {
-          case LSL:
-          case LRL:
-          case RSL:
-            c3.direction = c3.DIRECTION_LEFT;
-            break;
-          default:
-            c3.direction = c3.DIRECTION_RIGHT;
-        }
-        curved_trajectory.curves.push_back(c3);
-
-        if(step_size > 0.0)
-        {
-          SampleContext c;
-          c.pose_vector = &sampled_trajectory;
-          c.start_time = current_start_time;
-          c.speed = speed;
-          c.frame_id = curved_trajectory.start.header.frame_id;
-
-          int dubins_ret = dubins_path_sample_many(&path, step_size, buildPath, &c);
-          if(dubins_ret != 0)
-          {
-            ROS_ERROR_STREAM_THROTTLE(2.0, "Error sampling Dubin's path");
-          }
-        }
+      project11_nav_msgs::CurvedTrajectory curved_trajectory;
+      curved_trajectory.start = msg.poses.front();
+      curved_trajectory.goal = msg.poses.back();
+      if(!plan.empty())
+      {
+        const auto& first = plan.get().front().unwrap();
+        curved_trajectory.start.header.stamp = ros::Time(plan.get().front().getStartTime());
+        curved_trajectory.start.pose.position.x = first.qi[0];
+        curved_trajectory.start.pose.position.y = first.qi[1];
+        tf2::Quaternion q(tf2::Vector3(0,0,1), first.qi[2]);
+        curved_trajectory.start.pose.orientation = tf2::toMsg(q);
+
+        const auto& last = plan.get().back().unwrap();
+        curved_trajectory.goal.header.stamp = ros::Time(plan.get().back().getEndTime());
+        curved_trajectory.goal.pose.position.x = last.qi[3];
+        curved_trajectory.goal.pose.position.y = last.qi[4];
+        tf2::Quaternion q2(tf2::Vector3(0,0,1), last.qi[5]);
+        curved_trajectory.goal.pose.orientation = tf2::toMsg(q2);
       }
 
+      updateHandOff(plan, step_size, curved_trajectory.start.header.frame_id);
+      curved_trajectory.curves = handoff_curves_;
+
       for(auto t: input_task_->children().tasks())
         if(t->message().type == output_task_type_ && t->message().id == input_task_->getChildID(output_task_name_))
         {
@@ -454,7 +437,7 @@ public:
       auto out_msg = output_task_->message();
       out_msg.curved_trajectories.clear();
       out_msg.curved_trajectories.push_back(curved_trajectory);
-      out_msg.poses = sampled_trajectory;
+      out_msg.poses = handoff_poses_;
       output_task_->update(out_msg);
     }
     return ret;
@@ -506,6 +489,9 @@ public:
     statsMsg.plan_time_penalty = stats.PlanTimePenalty;
     statsMsg.plan_h_value = stats.PlanHValue;
     statsMsg.plan_depth = stats.PlanDepth;
+    statsMsg.peak_vertices = stats.PeakVertices;
+    statsMsg.peak_bytes = stats.PeakBytes;
+    statsMsg.dropped = stats.Dropped;
     statsMsg.collision_penalty = collisionPenalty;
     statsMsg.cpu_time = cpuTime;
     statsMsg.last_plan_achievable = lastPlanAchievable;
@@ -542,16 +528,23 @@ public:
     if(trajectory_displayer_)
     {
       geographic_visualization_msgs::GeoVizItem geoVizItem;
+      // convert all the ends in one go
+      std::vector<State> ends;
       for (const auto& r : ribbonManager.get())
+      {
+        ends.push_back(r.startAsState());
+        ends.push_back(r.endAsState());
+      }
+      auto points = trajectory_displayer_->convertToLatLong(ends);
+      for (size_t i = 0; i + 1 < points.size(); i += 2)
       {
         geographic_visualization_msgs::GeoVizPointList displayPoints;
         displayPoints.color.r = 1;
         displayPoints.color.b = 0.5;
         displayPoints.color.a = 0.6;
         displayPoints.size = 15;
-        geographic_msgs::GeoPoint point;
-        displayPoints.points.push_back(trajectory_displayer_->convertToLatLong(r.startAsState()));
-        displayPoints.points.push_back(trajectory_displayer_->convertToLatLong(r.endAsState()));
+        displayPoints.points.push_back(points[i]);
+        displayPoints.points.push_back(points[i + 1]);
         geoVizItem.lines.push_back(displayPoints);
       }
       geoVizItem.id = "ribbons";
@@ -592,6 +585,145 @@ public:
 
 
 private:
+  /// Everything that decides a plan segment's curves and samples. Like the collision cache key, plus the rest of the
+  /// path parameters so two segments from the same start to different places can't be mixed up
+  typedef std::tuple<double, double, double, double, double, double, int, double, double, double> SegmentKey;
+
+  static SegmentKey segmentKey(const DubinsWrapper& d)
+  {
+    const auto& path = d.unwrap();
+    return std::make_tuple(d.getStartTime(), path.qi[0], path.qi[1], path.qi[2], d.getRho(), d.getSpeed(),
+                           (int)path.type, path.param[0], path.param[1], path.param[2]);
+  }
+
+  /// Build one plan segment's three curves and its samples onto the end of the hand-off buffers
+  void appendSegment(const DubinsWrapper& d, double step_size, const std::string& frame_id)
+  {
+    auto path = d.unwrap();
+    ros::Time current_start_time = ros::Time(d.getStartTime());
+    double speed = d.getSpeed();
+
+    project11_nav_msgs::Curve c1;
+    c1.length = path.param[0];
+    c1.arrival_time = current_start_time + ros::Duration(c1.length/speed);
+    c1.radius = d.getRho();
+    switch(path.type)
+    {
+      case LSL:
+      case LSR:
+      case LRL:
+        c1.direction = c1.DIRECTION_LEFT;
+        break;
+      default:
+        c1.direction = c1.DIRECTION_RIGHT;
+    }
+    handoff_curves_.push_back(c1);
+
+    project11_nav_msgs::Curve c2;
+    c2.length = path.param[1];
+    c2.arrival_time = c1.arrival_time + ros::Duration(c2.length/speed);
+    c2.radius = d.getRho();
+    switch(path.type)
+    {
+      case RLR:
+        c2.direction = c2.DIRECTION_LEFT;
+        break;
+      case LRL:
+        c2.direction = c2.DIRECTION_RIGHT;
+        break;
+      default:
+        c2.direction = c2.DIRECTION_STRAIGHT;
+    }
+    handoff_curves_.push_back(c2);
+
+    project11_nav_msgs::Curve c3;
+    c3.length = path.param[2];
+    c3.arrival_time = c2.arrival_time + ros::Duration(c3.length/speed);
+    c3.radius = d.getRho();
+    switch(path.type)
+    {
+      case LSL:
+      case LRL:
+      case RSL:
+        c3.direction = c3.DIRECTION_LEFT;
+        break;
+      default:
+        c3.direction = c3.DIRECTION_RIGHT;
+    }
+    handoff_curves_.push_back(c3);
+
+    if(step_size > 0.0)
+    {
+      SampleContext c;
+      c.pose_vector = &handoff_poses_;
+      c.start_time = current_start_time;
+      c.speed = speed;
+      c.frame_id = frame_id;
+
+      // step along incrementally rather than sampling each point from scratch
+      DubinsWrapper::Sampler sampler(d, 0, step_size);
+      State s;
+      for(unsigned long i = 0; sampler.distance(i) < d.length(); i++)
+      {
+        sampler.sample(i, s);
+        double q[3] = {s.x(), s.y(), s.yaw()};
+        buildPath(q, sampler.distance(i), &c);
+      }
+    }
+  }
+
+  /// Bring the hand-off buffers up to date with a new plan. Each plan mostly carries on from the last one (the planner
+  /// drops segments off the front as they're passed and keeps going with the ones after), so find the run of segments
+  /// they have in common, keep what was built for those and only build the ones after it
+  void updateHandOff(const DubinsPlan& plan, double step_size, const std::string& frame_id)
+  {
+    if(step_size != handoff_step_size_ || frame_id != handoff_frame_id_)
+    {
+      handoff_segments_.clear();
+      handoff_curves_.clear();
+      handoff_poses_.clear();
+      handoff_step_size_ = step_size;
+      handoff_frame_id_ = frame_id;
+    }
+
+    const auto& segments = plan.get();
+    size_t first = 0, kept = 0;
+    if(!segments.empty())
+    {
+      auto front = segmentKey(segments.front());
+      while(first < handoff_segments_.size() && handoff_segments_[first].key != front)
+        first++;
+      while(first + kept < handoff_segments_.size() && kept < segments.size() &&
+            handoff_segments_[first + kept].key == segmentKey(segments[kept]))
+        kept++;
+    }
+    if(kept == 0)
+      first = handoff_segments_.size();
+
+    // slide what's kept to the front. Erasing keeps the buffers' capacity so they stop allocating after a few cycles
+    size_t curves_begin = first > 0 ? handoff_segments_[first - 1].curves_end : 0;
+    size_t poses_begin = first > 0 ? handoff_segments_[first - 1].poses_end : 0;
+    size_t curves_end = kept > 0 ? handoff_segments_[first + kept - 1].curves_end : curves_begin;
+    size_t poses_end = kept > 0 ? handoff_segments_[first + kept - 1].poses_end : poses_begin;
+    handoff_curves_.erase(handoff_curves_.begin() + curves_end, handoff_curves_.end());
+    handoff_curves_.erase(handoff_curves_.begin(), handoff_curves_.begin() + curves_begin);
+    handoff_poses_.erase(handoff_poses_.begin() + poses_end, handoff_poses_.end());
+    handoff_poses_.erase(handoff_poses_.begin(), handoff_poses_.begin() + poses_begin);
+    handoff_segments_.erase(handoff_segments_.begin() + first + kept, handoff_segments_.end());
+    handoff_segments_.erase(handoff_segments_.begin(), handoff_segments_.begin() + first);
+    for(auto& segment : handoff_segments_)
+    {
+      segment.curves_end -= curves_begin;
+      segment.poses_end -= poses_begin;
+    }
+
+    for(size_t i = kept; i < segments.size(); i++)
+    {
+      appendSegment(segments[i], step_size, frame_id);
+      handoff_segments_.push_back({segmentKey(segments[i]), handoff_curves_.size(), handoff_poses_.size()});
+    }
+  }
+
   project11_navigation::Context::Ptr context_;
   std::shared_ptr<project11_navigation::Task> input_task_;
   std::shared_ptr<project11_navigation::Task> output_task_;
@@ -606,6 +738,20 @@ private:
   /// Segment length used for turning curves into segments
   double step_size_ = 2;
 
+  /// What was last handed off to the controller, kept by plan segment so the segments that carry over into the next
+  /// plan don't have to be curved and sampled again
+  struct HandOffSegment
+  {
+    SegmentKey key;
+    size_t curves_end;
+    size_t poses_end;
+  };
+  std::vector<HandOffSegment> handoff_segments_;
+  std::vector<project11_nav_msgs::Curve> handoff_curves_;
+  std::vector<geometry_msgs::PoseStamped> handoff_poses_;
+  double handoff_step_size_ = -1;
+  std::string handoff_frame_id_;
+
   std::string output_task_type_ = "follow_trajectory";
   std::string output_task_name_ = "navigation_trajectory";
 
@@ -626,12 +772,19 @@ private:
   int heuristic_ = 0;
   bool gaussian_dynamic_obstacles_ = false;
   bool ignore_dynamic_obstacles_ = false;
+  bool integrate_obstacle_penalty_ = false;
+  int search_memory_limit_ = 0; // MB, 0 for no limit
+  double vessel_length_ = 0.0; // m, 0 along with the width for a point
+  double vessel_width_ = 0.0;
+  int roadmap_nodes_ = 0; // poses in the static roadmap over the survey area, 0 for none
   std::string planner_ = "AStarPlanner";
 
   double planning_time_ = 1.0;
   double planning_time_override_ = planning_time_;
 
   bool display_local_map_ = false;
+  /// How far (m) displayed trajectories can stray from the real ones to save points
+  double display_tolerance_ = 0.5;
 };
 
 } // namespace alex_path_planner
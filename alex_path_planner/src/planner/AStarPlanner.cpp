@@ -27,7 +27,7 @@ Planner::Stats AStarPlanner::plan(
 //    m_ExpandedCount = 0;
     m_IterationCount = 0;
     m_StartStateTime = start.time();
-    m_Samples.clear();
+    clearSamples();
     m_AttemptedSamples = 0;
     double minX, maxX, minY, maxY, minSpeed = m_Config.maxSpeed(), maxSpeed = m_Config.maxSpeed();
     double magnitude = m_Config.maxSpeed() * m_Config.timeHorizon();
@@ -38,6 +38,11 @@ Planner::Stats AStarPlanner::plan(
     maxY = fmin(start.y() + magnitude, mapExtremes[3]);
     auto seed = (unsigned long)endTime; // for different results each time. For consistency, use like 7 or something
     StateGenerator generator = StateGenerator(minX, maxX, minY, maxY, minSpeed, maxSpeed, seed, m_RibbonManager); // lucky seed
+    // search the roadmap instead of random samples if there's one for this map
+    auto roadmap = m_Config.roadmap();
+    if (roadmap && !roadmap->suits(*m_Config.map(), m_Config.turningRadius(), m_Config.coverageTurningRadius(),
+                                   m_Config.footprint())) roadmap = nullptr;
+    useRoadmap(roadmap);
     auto startV = Vertex::makeRoot(start, m_RibbonManager);
     startV->state().speed() = m_Config.maxSpeed();
     startV->computeApproxToGo(m_Config);
@@ -47,14 +52,21 @@ Planner::Stats AStarPlanner::plan(
     if (m_Config.useBrownPaths()) {
         brownPathSamples = m_RibbonManager.findNearStatesOnRibbons(start, m_Config.coverageTurningRadius());
     }
+    // aim for where the global tour gets onto the next ribbon too, which is often too far away to get sampled
+    std::vector<State> tourSamples(1);
+    if (!m_RibbonManager.nextTourEntry(tourSamples.front()) || tourSamples.front().isCoLocated(start))
+        tourSamples.clear();
 
-    // collision check old plan
+    // collision check old plan, re-using what we can from last time
+    if (m_Config.collisionCache()) m_Config.collisionCache()->retain(previousPlan);
     Vertex::SharedPtr lastPlanEnd = startV;
     if (!previousPlan.empty()) {
         for (const auto& p : previousPlan.get()) {
             if (p.getEndTime() <= start.time()) continue;
             if (p.getNetTime() == 0) continue; // There is sometimes a zero length edge at the end. Not sure why
             lastPlanEnd = Vertex::connect(lastPlanEnd, p, p.getRho() == m_Config.coverageTurningRadius());
+            if (m_Config.collisionCache())
+                lastPlanEnd->parentEdge()->useCollisionCache(m_Config.collisionCache()->get(p));
             lastPlanEnd->parentEdge()->computeTrueCost(m_Config);
             if (lastPlanEnd->parentEdge()->infeasible()) {
                 lastPlanEnd = startV;
@@ -70,7 +82,7 @@ Planner::Stats AStarPlanner::plan(
             *m_Config.output() << "Found best possible plan, assuming heuristic admissibility" << std::endl;
             break;
         }
-        visualizeVertex(startV, "start", false);
+        visualizeVertex(startV, Visualizer::Tag::Start, false);
 
         if (m_Config.visualizations()) {
             // copied here for debugging but it's necessary for visualizing the previous plan
@@ -80,9 +92,11 @@ Planner::Stats AStarPlanner::plan(
                     if (p.getEndTime() <= start.time()) continue;
                     if (p.getNetTime() == 0) continue; // just trying this I guess
                     lastPlanEnd = Vertex::connect(lastPlanEnd, p, p.getRho() == m_Config.coverageTurningRadius());
+                    if (m_Config.collisionCache())
+                        lastPlanEnd->parentEdge()->useCollisionCache(m_Config.collisionCache()->get(p));
                     lastPlanEnd->parentEdge()->computeTrueCost(m_Config);
                     lastPlanEnd->computeApproxToGo(m_Config);
-                    visualizeVertex(lastPlanEnd, "lastPlanEnd", false);
+                    visualizeVertex(lastPlanEnd, Visualizer::Tag::LastPlanEnd, false);
                     if (lastPlanEnd->parentEdge()->infeasible()) {
                         lastPlanEnd = startV;
                         break;
@@ -93,8 +107,8 @@ Planner::Stats AStarPlanner::plan(
         }
 
         if (m_Config.visualizations()) {
-            m_Config.visualizationStream() << "Incumbent f-value: " << (m_BestVertex? m_BestVertex->f() : 0) << std::endl;
-            m_Config.visualizationStream() << m_RibbonManager.dumpRibbons() << "End Ribbons" << std::endl;
+            m_Config.visualizer().incumbent(m_BestVertex? m_BestVertex->f() : 0);
+            m_Config.visualizer().ribbons(m_RibbonManager);
         }
         pushVertexQueue(startV);
         if (lastPlanEnd != startV) pushVertexQueue(lastPlanEnd);
@@ -103,25 +117,34 @@ Planner::Stats AStarPlanner::plan(
 
 //        expandToCoverSpecificSamples(startV, ribbonSamples, m_Config.obstacles(), true);
         expandToCoverSpecificSamples(startV, brownPathSamples, m_Config.obstaclesManager(), true);
-        // On the first iteration add initialSamples samples, otherwise just double them
-        if (m_Samples.size() < m_Config.initialSamples()) addSamples(generator, m_Config.initialSamples());
-        else addSamples(generator); // double samples (BIT* linearly increases them...)
+        expandToCoverSpecificSamples(startV, tourSamples, m_Config.obstaclesManager(), true);
+        // On the first iteration add initialSamples samples, otherwise just double them (the roadmap's are all there)
+        if (!m_Roadmap) {
+            if (m_Samples.size() < m_Config.initialSamples()) addSamples(generator, m_Config.initialSamples());
+            else addSamples(generator); // double samples (BIT* linearly increases them...)
+        }
         // visualize all samples each iteration
         if (m_Config.visualizations()) {
-            for (const auto& s : m_Samples)
-                m_Config.visualizationStream() << "State: (" << s.toStringRad() << "), f: " << 0 << ", g: " << 0 << ", h: " <<
-                                           0 << " sample" << std::endl;
+            for (uint32_t i = 0; i < m_Samples.size(); i++)
+                m_Config.visualizer().state(sample(i), 0, 0, 0, Visualizer::Tag::Sample);
         }
         auto v = aStar(m_Config.obstaclesManager(), endTime);
         if (!m_BestVertex || (v && v->f() + 0.0 < m_BestVertex->f())) { // add fudge factor to favor earlier (simpler) plans
             // found a (better) plan
-            m_BestVertex = v;
+            setBestVertex(v);
             if (v && m_Config.visualizations()) {
                 visualizePlan(tracePlan(v, false, m_Config.obstaclesManager()));
-                visualizeVertex(v, "goal", false);
+                visualizeVertex(v, Visualizer::Tag::Goal, false);
             }
         }
         m_Stats.Iterations++;
+        // the roadmap doesn't grow, so searching it again would find the same thing
+        if (m_Roadmap) break;
+        // and with more samples a search that ran out of memory would only run out sooner
+        if (memoryExhausted()) {
+            *m_Config.output() << "Search ran out of memory, stopping with the best plan so far" << std::endl;
+            break;
+        }
     }
     // Add expected final cost, total accrued cost (not here)
     m_Stats.Samples = m_Samples.size();
@@ -139,10 +162,10 @@ Planner::Stats AStarPlanner::plan(
 
 shared_ptr<Vertex> AStarPlanner::aStar(const DynamicObstaclesManager& obstacles, double endTime) {
     auto vertex = popVertexQueue();
-    while (now() < endTime) {
+    while (now() < endTime && !memoryExhausted()) {
         // relying on the filter on the vertex queue to give us a better goal
         if (goalCondition(vertex)) {
-            visualizeVertex(vertex, "vertex", false);
+            visualizeVertex(vertex, Visualizer::Tag::Vertex, false);
             return vertex;
         }
         expand(vertex, obstacles);
@@ -157,12 +180,10 @@ void AStarPlanner::expandToCoverSpecificSamples(Vertex::SharedPtr root, const st
                                                 const DynamicObstaclesManager& obstacles, bool coverageAllowed) {
     if (m_Config.coverageTurningRadius() > 0) {
         for (auto s : samples) {
-            for (const auto& speed : {m_Config.maxSpeed(), m_Config.slowSpeed()}) {
-                s.speed() = speed;
-                auto destinationVertex = Vertex::connect(root, s, m_Config.coverageTurningRadius(), coverageAllowed);
-                destinationVertex->parentEdge()->computeTrueCost(m_Config);
-                pushVertexQueue(destinationVertex);
-            }
+            s.speed() = m_Config.maxSpeed();
+            auto destinationVertex = Vertex::connect(root, s, m_Config.coverageTurningRadius(), coverageAllowed);
+            destinationVertex->parentEdge()->computeApproxCost();
+            connectAtAllSpeeds(root, destinationVertex);
         }
     }
 }
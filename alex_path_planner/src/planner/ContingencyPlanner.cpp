@@ -0,0 +1,63 @@
+#include <cfloat>
+#include "ContingencyPlanner.h"
+
+constexpr double ContingencyPlanner::c_Turns[];
+
+DubinsPlan ContingencyPlanner::plan(const State& start, const PlannerConfig& config, double duration) {
+    DubinsPlan best;
+    double bestPenalty = DBL_MAX, bestClearance = -1;
+    for (const auto& candidate : candidates(start, config, duration)) {
+        double penalty = 0, clearance = duration;
+        bool blocked = false;
+        for (const auto& s : candidate.getHalfSecondSamples()) {
+            if (config.map() && config.footprint().blocked(*config.map(), s.x(), s.y(), s.heading())) {
+                blocked = true;
+                break;
+            }
+            // they all last at least the duration, so compare them on the obstacles over just that
+            if (s.time() > start.time() + duration) continue;
+            penalty += config.obstaclesManager().collisionExists(s.x(), s.y(), s.time(), false);
+            // anything further off than the duration is as good as never
+            clearance = fmin(clearance, config.obstaclesManager().timeToPossibleCollision(s.x(), s.y(), s.time(),
+                                                                                          s.speed()));
+        }
+        if (blocked) continue;
+        // strictly better only, so ties go to the more preferred manoeuvre
+        if (penalty < bestPenalty || (penalty == bestPenalty && clearance > bestClearance)) {
+            best = candidate;
+            bestPenalty = penalty;
+            bestClearance = clearance;
+        }
+    }
+    return best;
+}
+
+std::vector<DubinsPlan> ContingencyPlanner::candidates(const State& start, const PlannerConfig& config,
+                                                       double duration) {
+    auto rho = config.turningRadius();
+    State from(start);
+    from.speed() = config.slowSpeed();
+    // far enough that turning onto the new heading doesn't take up the whole thing
+    auto distance = fmax(from.speed() * duration, 2 * rho);
+
+    std::vector<DubinsPlan> plans;
+    for (auto turn : c_Turns) {
+        auto yaw = from.yaw() + turn;
+        State to(from.x() + distance * cos(yaw), from.y() + distance * sin(yaw), 0, from.speed(), 0);
+        to.setYaw(yaw);
+        plans.emplace_back(from, to, rho);
+    }
+    // loiter: half a circle out to the far side and half a circle back
+    for (auto side : {1, -1}) {
+        auto centreYaw = from.yaw() + side * M_PI_2;
+        State across(from.x() + 2 * rho * cos(centreYaw), from.y() + 2 * rho * sin(centreYaw), 0, from.speed(), 0);
+        across.setYaw(from.yaw() + M_PI);
+        DubinsWrapper out(from, across, rho);
+        across.time() = out.getEndTime();
+        DubinsPlan loiter;
+        loiter.append(out);
+        loiter.append(DubinsWrapper(across, from, rho));
+        plans.push_back(loiter);
+    }
+    return plans;
+}
@@ -0,0 +1,41 @@
+#ifndef SRC_CONTINGENCYPLANNER_H
+#define SRC_CONTINGENCYPLANNER_H
+
+#include <cmath>
+#include <vector>
+#include <alex_path_planner_common/DubinsPlan.h>
+#include "PlannerConfig.h"
+
+/**
+ * Makes a short plan to fall back on when the real planner fails. It doesn't search; it tries a handful of simple
+ * manoeuvres at slow speed (carry on, turn off to either side or back the way we came, loiter in a circle either way)
+ * and picks the safest one that stays off the map's obstacles: least collision penalty first, then the one that keeps
+ * furthest (in time) from the dynamic obstacles, which means turning away from whoever's nearest.
+ *
+ * It's cheap enough to redo every cycle, so the executive keeps one ready in the background.
+ */
+class ContingencyPlanner {
+public:
+    /**
+     * @param start the state to plan from
+     * @param config the map, obstacles, slow speed and turning radius to use
+     * @param duration how far ahead (s) to compare the manoeuvres. They all last at least this long
+     * @return the safest manoeuvre, or an empty plan if they all run into something on the map
+     */
+    static DubinsPlan plan(const State& start, const PlannerConfig& config, double duration);
+
+    /**
+     * @param start
+     * @param config
+     * @param duration
+     * @return all the manoeuvres plan() picks from, most preferred first
+     */
+    static std::vector<DubinsPlan> candidates(const State& start, const PlannerConfig& config, double duration);
+
+private:
+    // headings to turn onto, relative to the start's
+    static constexpr double c_Turns[] = {0, M_PI_4, -M_PI_4, M_PI_2, -M_PI_2, 3 * M_PI_4, -3 * M_PI_4, M_PI};
+};
+
+
+#endif //SRC_CONTINGENCYPLANNER_H
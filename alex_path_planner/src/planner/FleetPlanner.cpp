@@ -0,0 +1,74 @@
+#include <atomic>
+#include <exception>
+#include <thread>
+#include "FleetPlanner.h"
+#include "AStarPlanner.h"
+#include "../common/dynamic_obstacles/FleetObstaclesManager.h"
+
+FleetPlanner::FleetPlanner(unsigned int threads, PlannerFactory factory)
+    : m_Threads(threads), m_Factory(std::move(factory)) {
+    if (m_Threads == 0) m_Threads = std::max(1u, std::thread::hardware_concurrency());
+    if (!m_Factory) m_Factory = [] { return std::unique_ptr<Planner>(new AStarPlanner); };
+}
+
+std::vector<Planner::Stats> FleetPlanner::plan(const std::vector<Vessel>& vessels, const PlannerConfig& config,
+                                               double timeRemaining) {
+    auto n = vessels.size();
+    std::vector<Planner::Stats> results(n);
+    if (n == 0) return results;
+
+    // everyone's obstacles, made up front since they all share the same view of where everyone else is going
+    std::vector<DynamicObstaclesManager::SharedPtr> obstacles;
+    for (size_t i = 0; i < n; i++) {
+        std::vector<FleetObstaclesManager::Vessel> others;
+        for (size_t j = 0; j < n; j++) {
+            if (j != i) others.emplace_back(vessels[j].CurrentPlan, vessels[j].Width, vessels[j].Length);
+        }
+        obstacles.push_back(std::make_shared<FleetObstaclesManager>(config.obstaclesManager(), others));
+    }
+    m_CollisionCaches.resize(n);
+    for (auto& cache : m_CollisionCaches) if (!cache) cache = std::make_shared<CollisionCache>();
+
+    auto workers = (unsigned int)std::min<size_t>(m_Threads, n);
+    auto rounds = (n + workers - 1) / workers;
+    auto timePerVessel = timeRemaining / (double)rounds;
+
+    std::atomic<size_t> next(0);
+    std::vector<std::exception_ptr> errors(n);
+    auto work = [&] {
+        for (auto i = next++; i < n; i = next++) {
+            try {
+                auto vesselConfig = config;
+                vesselConfig.setVisualizations(false);
+                vesselConfig.setObstaclesManager(obstacles[i]);
+                vesselConfig.setCollisionCache(config.collisionCache()? m_CollisionCaches[i] : nullptr);
+                auto planner = m_Factory();
+                results[i] = planner->plan(vessels[i].Ribbons, vessels[i].Start, vesselConfig, vessels[i].CurrentPlan,
+                                           timePerVessel, {});
+            } catch (...) {
+                errors[i] = std::current_exception();
+            }
+        }
+    };
+    // this thread takes a share of the work too
+    std::vector<std::thread> threads;
+    for (unsigned int t = 1; t < workers; t++) {
+        threads.emplace_back([&] {
+            if (m_ThreadSetup) m_ThreadSetup();
+            work();
+        });
+    }
+    work();
+    for (auto& thread : threads) thread.join();
+
+    for (const auto& error : errors) if (error) std::rethrow_exception(error);
+    return results;
+}
+
+unsigned int FleetPlanner::threads() const {
+    return m_Threads;
+}
+
+void FleetPlanner::setThreadSetup(std::function<void()> setup) {
+    m_ThreadSetup = std::move(setup);
+}
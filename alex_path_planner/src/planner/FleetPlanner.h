@@ -0,0 +1,73 @@
+#ifndef SRC_FLEETPLANNER_H
+#define SRC_FLEETPLANNER_H
+
+#include <functional>
+#include <memory>
+#include <vector>
+#include "Planner.h"
+#include "utilities/CollisionCache.h"
+
+/**
+ * Plans for several vessels at once in one process. Everyone plans against the same map and obstacles from the config
+ * (which aren't copied, so however big the map is there's only one of it) plus the other vessels, which are obstacles
+ * following the plans they have now. Each vessel has its own start and its own ribbons, so they can split a survey.
+ *
+ * The searches are spread over a fixed number of threads, which bounds how much CPU the fleet uses. When there are
+ * more vessels than threads they go in rounds and the time is split between the rounds, so the whole batch still
+ * finishes within the time given.
+ */
+class FleetPlanner {
+public:
+    /**
+     * What we need to know about each vessel.
+     */
+    struct Vessel {
+        State Start;
+        RibbonManager Ribbons;
+        // the plan it's following now, which seeds its search and is what the other vessels avoid
+        DubinsPlan CurrentPlan;
+        // size as an obstacle for the others
+        double Width = 5, Length = 10;
+    };
+
+    typedef std::function<std::unique_ptr<Planner>()> PlannerFactory;
+
+    /**
+     * @param threads how many searches can run at once, or 0 for one per core
+     * @param factory makes a planner for each search. Defaults to A*
+     */
+    explicit FleetPlanner(unsigned int threads = 0, PlannerFactory factory = nullptr);
+
+    /**
+     * Plan for every vessel. The map and obstacles must not change until this returns.
+     * @param vessels
+     * @param config configuration for everyone. Visualizations are turned off since everyone would write over each other
+     * @param timeRemaining computation time bound for the whole batch
+     * @return stats (including the plan) for each vessel, in the same order as the vessels
+     */
+    std::vector<Planner::Stats> plan(const std::vector<Vessel>& vessels, const PlannerConfig& config,
+                                     double timeRemaining);
+
+    /**
+     * @return how many searches can run at once
+     */
+    unsigned int threads() const;
+
+    /**
+     * Give the worker threads something to run when they start, like pinning them to some CPUs. The calling thread does
+     * a share of the work too, but it's left alone.
+     * @param setup
+     */
+    void setThreadSetup(std::function<void()> setup);
+
+private:
+    unsigned int m_Threads;
+    PlannerFactory m_Factory;
+    std::function<void()> m_ThreadSetup;
+
+    // collision caches by vessel, kept between batches like the executive keeps its own
+    std::vector<CollisionCache::SharedPtr> m_CollisionCaches;
+};
+
+
+#endif //SRC_FLEETPLANNER_H
@@ -0,0 +1,176 @@
+#include "LatticePlanner.h"
+
+using std::shared_ptr;
+
+std::function<bool(shared_ptr<Vertex> v1, shared_ptr<Vertex> v2)> LatticePlanner::getVertexComparator() {
+    return [] (const shared_ptr<Vertex>& v1, const shared_ptr<Vertex>& v2) {
+        return v1->f() > v2->f();
+    };
+}
+
+Planner::Stats LatticePlanner::plan(
+    const RibbonManager& ribbonManager,
+    const State& start,
+    PlannerConfig config,
+    const DubinsPlan& previousPlan,
+    double timeRemaining,
+    std::unordered_map<uint32_t, GaussianDynamicObstaclesManager::Obstacle> dynamic_obstacles_copy
+) {
+    m_Config = std::move(config); // gotta do this before we can call now()
+    double endTime = timeRemaining + now();
+    m_Config.setStartStateTime(start.time());
+    m_RibbonManager = ribbonManager;
+    m_RibbonManager.changeHeuristicIfTooManyRibbons(); // make sure ribbon heuristic is calculable
+    if (m_RibbonManager.done()) m_RibbonManager.setCoverageCompletedTime(start.time());
+    m_Stats = Stats();
+    m_StartStateTime = start.time();
+    clearSamples();
+    clearVertexQueue();
+    m_BlockedCells.clear();
+    m_Reached.clear();
+
+    // anchor the lattice at the start, with a spacing that's a whole number of map cells
+    m_OriginX = start.x();
+    m_OriginY = start.y();
+    m_CellSize = m_Config.map()->resolution() > 0? m_Config.map()->resolution() : c_DefaultCellSize;
+    m_CellsPerSpacing = std::max(1, (int)std::round(c_SpacingTurningRadii * m_Config.turningRadius() / m_CellSize));
+    m_Spacing = m_CellsPerSpacing * m_CellSize;
+    auto primitives = m_Config.motionPrimitives();
+    if (!primitives) primitives = std::make_shared<MotionPrimitives>();
+    m_Libraries.clear();
+    m_Libraries.push_back({primitives->get(m_Config.turningRadius(), m_Spacing, m_CellSize,
+            m_Config.collisionCheckingIncrement()), m_Config.turningRadius() == m_Config.coverageTurningRadius()});
+    if (m_Config.coverageTurningRadius() > 0 && m_Config.coverageTurningRadius() != m_Config.turningRadius()) {
+        m_Libraries.push_back({primitives->get(m_Config.coverageTurningRadius(), m_Spacing, m_CellSize,
+                m_Config.collisionCheckingIncrement()), true});
+    }
+
+    auto startV = Vertex::makeRoot(start, m_RibbonManager);
+    startV->state().speed() = m_Config.maxSpeed();
+    startV->computeApproxToGo(m_Config);
+    m_BestVertex = nullptr;
+
+    // collision check old plan, re-using what we can from last time
+    if (m_Config.collisionCache()) m_Config.collisionCache()->retain(previousPlan);
+    Vertex::SharedPtr lastPlanEnd = startV;
+    for (const auto& p : previousPlan.get()) {
+        if (p.getEndTime() <= start.time()) continue;
+        if (p.getNetTime() == 0) continue;
+        lastPlanEnd = Vertex::connect(lastPlanEnd, p, p.getRho() == m_Config.coverageTurningRadius());
+        if (m_Config.collisionCache())
+            lastPlanEnd->parentEdge()->useCollisionCache(m_Config.collisionCache()->get(p));
+        lastPlanEnd->parentEdge()->computeTrueCost(m_Config);
+        if (lastPlanEnd->parentEdge()->infeasible()) {
+            lastPlanEnd = startV;
+            break;
+        }
+        if (goalCondition(lastPlanEnd)) break;
+    }
+
+    visualizeVertex(startV, Visualizer::Tag::Start, false);
+    visualizeRibbons(m_RibbonManager);
+    pushVertexQueue(startV);
+    if (lastPlanEnd != startV) pushVertexQueue(lastPlanEnd);
+    while (now() < endTime && !vertexQueueEmpty() && !memoryExhausted()) {
+        auto vertex = popVertexQueue();
+        if (goalCondition(vertex)) {
+            setBestVertex(vertex);
+            break;
+        }
+        expand(vertex, m_Config.obstaclesManager());
+    }
+    m_Stats.Iterations = 1;
+    if (memoryExhausted())
+        *m_Config.output() << "Search ran out of memory, stopping with the best plan so far" << std::endl;
+
+    if (!m_BestVertex) {
+        *m_Config.output() << "Failed to find a plan" << std::endl;
+    } else {
+        if (m_Config.visualizations()) {
+            visualizePlan(tracePlan(m_BestVertex, false, m_Config.obstaclesManager()));
+            visualizeVertex(m_BestVertex, Visualizer::Tag::Goal, false);
+        }
+        m_Stats.PlanFValue = m_BestVertex->f();
+        m_Stats.PlanDepth = m_BestVertex->getDepth();
+        m_Stats.PlanTimePenalty = (m_BestVertex->state().time() - m_StartStateTime) * Edge::timePenaltyFactor();
+        m_Stats.PlanHValue = m_BestVertex->approxToGo();
+        m_Stats.Plan = std::move(tracePlan(m_BestVertex, false, m_Config.obstaclesManager()));
+    }
+    return m_Stats;
+}
+
+void LatticePlanner::expand(const std::shared_ptr<Vertex>& sourceVertex, const DynamicObstaclesManager& obstacles) {
+    visualizeVertex(sourceVertex, Visualizer::Tag::Vertex, true);
+    const auto& source = sourceVertex->state();
+    int i, j, heading;
+    bool onLattice = latticeIndex(source, i, j, heading);
+    const double speeds[2] = {m_Config.maxSpeed(), m_Config.slowSpeed() == m_Config.maxSpeed()?
+                                                   -1 : m_Config.slowSpeed()};
+    for (const auto& library : m_Libraries) {
+        for (const auto& primitive : library.Primitives->ByHeading[heading]) {
+            auto key = std::make_tuple(i + primitive->DX, j + primitive->DY, primitive->EndHeading, 0);
+            DubinsWrapper wrapper;
+            bool staticClear = false;
+            if (onLattice) {
+                staticClear = true;
+                for (const auto& cell : primitive->SweptCells) {
+                    if (cellBlocked(i * m_CellsPerSpacing + cell.first, j * m_CellsPerSpacing + cell.second)) {
+                        // might just be the corner of a cell the curve doesn't really touch, so let the edge decide
+                        staticClear = false;
+                        break;
+                    }
+                }
+                wrapper = primitive->place(source.x(), source.y(), speeds[0], source.time());
+            } else {
+                State target(m_OriginX + std::get<0>(key) * m_Spacing, m_OriginY + std::get<1>(key) * m_Spacing,
+                             MotionPrimitives::heading(primitive->EndHeading), speeds[0], 0);
+                if (source.isCoLocated(target)) continue;
+                wrapper.set(source, target, library.Primitives->TurningRadius);
+                wrapper.setSpeed(speeds[0]);
+            }
+            Vertex::SharedPtr first;
+            for (int s = 0; s < 2; s++) {
+                if (speeds[s] <= 0) continue;
+                wrapper.setSpeed(speeds[s]);
+                auto v = Vertex::connect(sourceVertex, wrapper, library.CoverageAllowed);
+                if (onLattice) v->parentEdge()->usePrimitive(primitive, staticClear);
+                // the first speed walks the curve, the other re-uses it
+                if (first) first->parentEdge()->shareGeometry(*v->parentEdge());
+                else first = v;
+                v->parentEdge()->computeTrueCost(m_Config);
+                std::get<3>(key) = s;
+                pushIfUseful(v, key);
+            }
+        }
+    }
+    m_Stats.Expanded++;
+}
+
+bool LatticePlanner::latticeIndex(const State& s, int& i, int& j, int& heading) const {
+    i = (int)std::round((s.x() - m_OriginX) / m_Spacing);
+    j = (int)std::round((s.y() - m_OriginY) / m_Spacing);
+    heading = MotionPrimitives::headingIndex(s.heading());
+    return fabs(m_OriginX + i * m_Spacing - s.x()) < 1e-6 && fabs(m_OriginY + j * m_Spacing - s.y()) < 1e-6 &&
+           fabs(remainder(s.heading() - MotionPrimitives::heading(heading), 2 * M_PI)) < 1e-6;
+}
+
+bool LatticePlanner::cellBlocked(int cx, int cy) {
+    auto key = ((uint64_t)(uint32_t)cx << 32) | (uint32_t)cy;
+    auto it = m_BlockedCells.find(key);
+    if (it != m_BlockedCells.end()) return it->second;
+    // a point a whole number of cells away from the origin is in the cell that many cells away from the origin's cell
+    auto blocked = m_Config.map()->isBlocked(m_OriginX + cx * m_CellSize, m_OriginY + cy * m_CellSize);
+    m_BlockedCells.emplace(key, blocked);
+    return blocked;
+}
+
+void LatticePlanner::pushIfUseful(const Vertex::SharedPtr& v, const std::tuple<int, int, int, int>& key) {
+    if (v->parentEdge()->infeasible()) return;
+    auto g = v->currentCost(), h = v->approxToGo();
+    auto& reached = m_Reached[key];
+    for (const auto& r : reached) {
+        if (r.first <= g && r.second <= h) return;
+    }
+    reached.emplace_back(g, h);
+    pushVertexQueue(v);
+}
@@ -0,0 +1,96 @@
+#ifndef SRC_LATTICEPLANNER_H
+#define SRC_LATTICEPLANNER_H
+
+#include <map>
+#include <tuple>
+#include <unordered_map>
+#include "SamplingBasedPlanner.h"
+#include "utilities/MotionPrimitives.h"
+
+/**
+ * A* over a state lattice instead of random samples. The lattice is anchored at the start state: positions on a grid
+ * a fraction of the turning radius apart, a fixed set of headings, and the two speeds. Vertices are expanded with a
+ * library of motion primitives for each turning radius (see MotionPrimitives), which are checked against the map with
+ * their precomputed swept cells before any curve gets walked.
+ *
+ * Unlike the AStarPlanner this is deterministic and does one search per cycle, so it's a useful comparison and a
+ * fallback when random samples have trouble (narrow channels, for instance).
+ */
+class LatticePlanner : public SamplingBasedPlanner {
+public:
+    LatticePlanner() = default;
+
+    ~LatticePlanner() override = default;
+
+    Stats plan(
+        const RibbonManager& ribbonManager,
+        const State& start,
+        PlannerConfig config,
+        const DubinsPlan& previousPlan,
+        double timeRemaining,
+        std::unordered_map<uint32_t, GaussianDynamicObstaclesManager::Obstacle> dynamic_obstacles_copy
+    ) override;
+
+    /**
+     * Expand a vertex with the motion primitives for its lattice heading. Vertices that aren't on the lattice (the
+     * start, or the end of the last plan) get ordinary Dubins curves to where the primitives would have ended.
+     * @param sourceVertex
+     * @param obstacles
+     */
+    void expand(const std::shared_ptr<Vertex>& sourceVertex, const DynamicObstaclesManager& obstacles) override;
+
+protected:
+    std::function<bool(std::shared_ptr<Vertex> v1, std::shared_ptr<Vertex> v2)> getVertexComparator() override;
+
+private:
+    struct RadiusLibrary {
+        MotionPrimitives::Library::SharedPtr Primitives;
+        bool CoverageAllowed;
+    };
+
+    std::vector<RadiusLibrary> m_Libraries;
+
+    // lattice origin (the start state) and spacing, and the map cell size it's a multiple of
+    double m_OriginX = 0, m_OriginY = 0, m_Spacing = 1, m_CellSize = 1;
+    int m_CellsPerSpacing = 1;
+
+    // map lookups this cycle, keyed by cell relative to the origin's cell
+    std::unordered_map<uint64_t, bool> m_BlockedCells;
+
+    // (g, h) of the vertices that have reached each lattice state and speed, none of which is worse in both
+    std::map<std::tuple<int, int, int, int>, std::vector<std::pair<double, double>>> m_Reached;
+
+    /**
+     * Find the lattice state nearest a state.
+     * @param s
+     * @param i
+     * @param j
+     * @param heading
+     * @return true iff the state is on the lattice
+     */
+    bool latticeIndex(const State& s, int& i, int& j, int& heading) const;
+
+    /**
+     * Check a map cell, remembering the answer for the rest of the cycle.
+     * @param cx cell relative to the origin's cell
+     * @param cy
+     * @return
+     */
+    bool cellBlocked(int cx, int cy);
+
+    /**
+     * Push a vertex that has reached a lattice state, unless it's infeasible or some other vertex has already reached
+     * that state at least as cheaply with at least as much covered (by its heuristic).
+     * @param v
+     * @param key lattice position, heading and speed index
+     */
+    void pushIfUseful(const Vertex::SharedPtr& v, const std::tuple<int, int, int, int>& key);
+
+    // lattice spacing as a fraction of the (non-coverage) turning radius
+    static constexpr double c_SpacingTurningRadii = 0.5;
+    // cell size to use for maps without one
+    static constexpr double c_DefaultCellSize = 1;
+};
+
+
+#endif //SRC_LATTICEPLANNER_H
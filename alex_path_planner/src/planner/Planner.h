@@ -32,6 +32,13 @@ public:
         double PlanTimePenalty;
         double PlanHValue;
         unsigned long PlanDepth;
+        // most vertices (and their estimated bytes) the search held at once, and how many it dropped to stay under the
+        // memory limit
+        unsigned long PeakVertices = 0;
+        size_t PeakBytes = 0;
+        unsigned long Dropped = 0;
+        // connections to samples that re-used a curve from earlier in the cycle (see ConnectionCache)
+        unsigned long ReusedConnections = 0;
         DubinsPlan Plan;
     };
 
@@ -4,6 +4,10 @@
 #include <functional>
 #include <assert.h>
 #include "utilities/Visualizer.h"
+#include "utilities/CollisionCache.h"
+#include "utilities/Footprint.h"
+#include "utilities/MotionPrimitives.h"
+#include "utilities/Roadmap.h"
 #include "../common/map//Map.h"
 #include "../common/dynamic_obstacles/DynamicObstaclesManager1.h"
 #include "../common/dynamic_obstacles/DynamicObstaclesManager.h"
@@ -65,10 +69,9 @@ public:
         m_Visualizations = visualizations;
     }
 
-    std::ostream& visualizationStream() const {
-        assert(m_Visualizations && "Visualization stream accessed when visualizations are disabled");
-//        assert(m_VisualizationStream && *m_VisualizationStream && "Visualization stream accessed but does not exist");
-        return (*m_Visualizer)->stream();
+    Visualizer& visualizer() const {
+        assert(m_Visualizations && "Visualizer accessed when visualizations are disabled");
+        return **m_Visualizer;
     }
 
     void setVisualizationStream(std::ostream** visualizationStream) {
@@ -85,6 +88,7 @@ public:
 
     void setMap(const Map::SharedPtr& map) {
         m_Map = map;
+        m_EdgeEvaluator = -1;
     }
 
     const DynamicObstaclesManager1& obstacles() const {
@@ -101,6 +105,39 @@ public:
 
     void setObstaclesManager(DynamicObstaclesManager::SharedPtr obstaclesManager) {
         m_ObstaclesManager = obstaclesManager;
+        m_EdgeEvaluator = -1;
+    }
+
+    int edgeEvaluator() const {
+        return m_EdgeEvaluator;
+    }
+
+    void setEdgeEvaluator(int edgeEvaluator) {
+        m_EdgeEvaluator = edgeEvaluator;
+    }
+
+    bool integrateObstaclePenalty() const {
+        return m_IntegrateObstaclePenalty;
+    }
+
+    void setIntegrateObstaclePenalty(bool integrateObstaclePenalty) {
+        m_IntegrateObstaclePenalty = integrateObstaclePenalty;
+    }
+
+    const CollisionCache::SharedPtr& collisionCache() const {
+        return m_CollisionCache;
+    }
+
+    void setCollisionCache(CollisionCache::SharedPtr collisionCache) {
+        m_CollisionCache = std::move(collisionCache);
+    }
+
+    const MotionPrimitives::SharedPtr& motionPrimitives() const {
+        return m_MotionPrimitives;
+    }
+
+    void setMotionPrimitives(MotionPrimitives::SharedPtr motionPrimitives) {
+        m_MotionPrimitives = std::move(motionPrimitives);
     }
 
     std::ostream* output() const {
@@ -165,6 +202,14 @@ public:
         m_TimeMinimum = timeMinimum;
     }
 
+    size_t searchMemoryLimit() const {
+        return m_SearchMemoryLimit;
+    }
+
+    void setSearchMemoryLimit(size_t searchMemoryLimit) {
+        m_SearchMemoryLimit = searchMemoryLimit;
+    }
+
     double slowSpeed() const {
         if (m_SlowSpeed <= 0) return m_MaxSpeed;
         return m_SlowSpeed;
@@ -174,11 +219,29 @@ public:
         m_SlowSpeed = slowSpeed;
     }
 
+    const Footprint& footprint() const {
+        return m_Footprint;
+    }
+
+    void setFootprint(const Footprint& footprint) {
+        m_Footprint = footprint;
+    }
+
+    const Roadmap::SharedPtr& roadmap() const {
+        return m_Roadmap;
+    }
+
+    void setRoadmap(Roadmap::SharedPtr roadmap) {
+        m_Roadmap = std::move(roadmap);
+    }
+
 private:
     // search branching factor
     int m_BranchingFactor = 9;
     // vehicle configuration (radii for Dubins model)
     double m_MaxSpeed = 2.5, m_SlowSpeed = 0.5, m_TurningRadius = 8, m_CoverageTurningRadius = 16;
+    // hull to check against the map (a point by default)
+    Footprint m_Footprint;
     // time horizon and minimum plan duration
     double m_TimeHorizon = 30, m_TimeMinimum = 5;
     // increment at which plans are collision checked (m)
@@ -189,6 +252,8 @@ private:
     int m_InitialSamples = 100;
     // whether or not to be clever about getting onto the ribbon with some hand-picked curves
     bool m_UseBrownPaths = false;
+    // roughly how much memory (bytes) the search may hold onto in vertices, or 0 for no limit
+    size_t m_SearchMemoryLimit = 0;
     // whether to dump the motion tree to a file. tends to make search go a little slower, and files get big fast
     bool m_Visualizations = false;
     Visualizer::UniquePtr* m_Visualizer;
@@ -199,6 +264,17 @@ private:
     // dynamic obstacles
     DynamicObstaclesManager1 m_Obstacles;
     DynamicObstaclesManager::SharedPtr m_ObstaclesManager = std::make_shared<DynamicObstaclesManager>();
+    // which specialization of edge evaluation suits the map and obstacles manager, worked out (once) by Edge
+    int m_EdgeEvaluator = -1;
+    // whether to integrate the obstacle penalty along each piece of an edge rather than sample it every increment (only
+    // done when the obstacles manager's penalty is smooth)
+    bool m_IntegrateObstaclePenalty = false;
+    // collision checking results for the previous plan, kept across cycles (optional)
+    CollisionCache::SharedPtr m_CollisionCache;
+    // motion primitive libraries for the lattice planner, kept across cycles so they're only built once (optional)
+    MotionPrimitives::SharedPtr m_MotionPrimitives;
+    // static roadmap over the survey area for the A* planner to search, built in the background (optional)
+    Roadmap::SharedPtr m_Roadmap;
     // Stream for output. Maybe this should go to its own ROS topic?
     std::ostream* m_Output;
     // function we pass in to let the planner check the time
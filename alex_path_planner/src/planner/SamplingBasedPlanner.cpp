@@ -2,6 +2,9 @@
 #include <algorithm>
 #include <utility>
 
+constexpr double SamplingBasedPlanner::c_ShedTarget;
+constexpr double SamplingBasedPlanner::c_ExpandedShare;
+
 SamplingBasedPlanner::SamplingBasedPlanner() {}
 
 void SamplingBasedPlanner::pushVertexQueue(Vertex::SharedPtr vertex) {
@@ -14,8 +17,12 @@ void SamplingBasedPlanner::pushVertexQueue(Vertex::SharedPtr vertex) {
     m_VertexQueue.push_back(vertex);
     std::push_heap(m_VertexQueue.begin(), m_VertexQueue.end(), getVertexComparator());
 //    std::cerr << "Pushing to vertex queue: " << vertex->toString() << std::endl;
-    visualizeVertex(vertex, "vertex", false);
+    visualizeVertex(vertex, Visualizer::Tag::Vertex, false);
     m_Stats.Generated++;
+    m_QueueBytes += vertex->memoryUsage();
+    if (m_Config.searchMemoryLimit() != 0 && m_QueueBytes + m_ExpandedBytes > m_Config.searchMemoryLimit())
+        shedVertexQueue();
+    recordMemory();
 }
 
 std::shared_ptr<Vertex> SamplingBasedPlanner::popVertexQueue() {
@@ -23,9 +30,72 @@ std::shared_ptr<Vertex> SamplingBasedPlanner::popVertexQueue() {
     std::pop_heap(m_VertexQueue.begin(), m_VertexQueue.end(), getVertexComparator());
     auto ret = m_VertexQueue.back();
     m_VertexQueue.pop_back();
+    // it's either expanded or it's the goal, and either way it's kept around as long as something descends from it
+    auto bytes = ret->memoryUsage();
+    m_QueueBytes -= bytes;
+    m_ExpandedBytes += bytes;
+    m_ExpandedVertices++;
+    m_Expanded.emplace_back(ret, bytes);
     return ret;
 }
 
+void SamplingBasedPlanner::setBestVertex(const Vertex::SharedPtr& vertex) {
+    m_BestVertex = vertex;
+    if (m_BestVertex) compactVertexQueue(m_BestVertex->f());
+}
+
+void SamplingBasedPlanner::compactVertexQueue(double bound) {
+    auto end = std::remove_if(m_VertexQueue.begin(), m_VertexQueue.end(), [&](const Vertex::SharedPtr& v) {
+        if (v->f() <= bound) return false;
+        m_QueueBytes -= v->memoryUsage();
+        return true;
+    });
+    if (end == m_VertexQueue.end()) return;
+    m_VertexQueue.erase(end, m_VertexQueue.end());
+    std::make_heap(m_VertexQueue.begin(), m_VertexQueue.end(), getVertexComparator());
+}
+
+void SamplingBasedPlanner::shedVertexQueue() {
+    releaseExpanded();
+    if (m_QueueBytes + m_ExpandedBytes <= m_Config.searchMemoryLimit()) return;
+    if (m_ExpandedBytes > c_ExpandedShare * (double)m_Config.searchMemoryLimit()) m_MemoryExhausted = true;
+    auto comparator = getVertexComparator();
+    // best first
+    std::sort(m_VertexQueue.begin(), m_VertexQueue.end(), [&](const Vertex::SharedPtr& v1, const Vertex::SharedPtr& v2) {
+        return comparator(v2, v1);
+    });
+    auto target = (size_t)(c_ShedTarget * (double)m_Config.searchMemoryLimit());
+    target = m_ExpandedBytes < target? target - m_ExpandedBytes : 0;
+    size_t kept = 0, bytes = 0;
+    for (; kept < m_VertexQueue.size(); kept++) {
+        auto vertexBytes = m_VertexQueue[kept]->memoryUsage();
+        if (kept > 0 && bytes + vertexBytes > target) break;
+        bytes += vertexBytes;
+    }
+    m_Stats.Dropped += m_VertexQueue.size() - kept;
+    m_VertexQueue.erase(m_VertexQueue.begin() + kept, m_VertexQueue.end());
+    m_QueueBytes = bytes;
+    std::make_heap(m_VertexQueue.begin(), m_VertexQueue.end(), comparator);
+    // whatever only the dropped vertices were holding on to is gone now too
+    releaseExpanded();
+}
+
+void SamplingBasedPlanner::releaseExpanded() {
+    auto end = std::remove_if(m_Expanded.begin(), m_Expanded.end(),
+            [&](const std::pair<std::weak_ptr<Vertex>, size_t>& e) {
+        if (!e.first.expired()) return false;
+        m_ExpandedBytes -= e.second;
+        m_ExpandedVertices--;
+        return true;
+    });
+    m_Expanded.erase(end, m_Expanded.end());
+}
+
+void SamplingBasedPlanner::recordMemory() {
+    m_Stats.PeakVertices = std::max(m_Stats.PeakVertices, (unsigned long)m_VertexQueue.size() + m_ExpandedVertices);
+    m_Stats.PeakBytes = std::max(m_Stats.PeakBytes, m_QueueBytes + m_ExpandedBytes);
+}
+
 std::function<bool(std::shared_ptr<Vertex> v1,
                    std::shared_ptr<Vertex> v2)> SamplingBasedPlanner::getVertexComparator() {
     return [](const std::shared_ptr<Vertex>& v1, const std::shared_ptr<Vertex>& v2){
@@ -33,10 +103,8 @@ std::function<bool(std::shared_ptr<Vertex> v1,
     };
 }
 
-std::function<bool(const State& s1, const State& s2)> SamplingBasedPlanner::getStateComparator(const State& origin) {
-    return [&](const State& s1, const State& s2) {
-        return s1.distanceTo(origin) > s2.distanceTo(origin);
-    };
+State SamplingBasedPlanner::sample(uint32_t i) const {
+    return m_Roadmap? m_Roadmap->nodes()[i] : m_Samples.state(i);
 }
 
 bool SamplingBasedPlanner::goalCondition(const std::shared_ptr<Vertex>& vertex) {
@@ -52,11 +120,9 @@ bool SamplingBasedPlanner::goalCondition(const std::shared_ptr<Vertex>& vertex)
 void SamplingBasedPlanner::expand(const std::shared_ptr<Vertex>& sourceVertex, const DynamicObstaclesManager& obstacles) {
     
 //    std::cerr << "Expanding vertex " << sourceVertex->toString() << std::endl;
-    visualizeVertex(sourceVertex, "vertex", true);
+    visualizeVertex(sourceVertex, Visualizer::Tag::Vertex, true);
 
     // define configurations
-    const auto& speeds = {m_Config.maxSpeed(), m_Config.maxSpeed() == m_Config.slowSpeed()?
-                                               -1 : m_Config.slowSpeed()};
     const int nTurningRadii = 2;
     const double turningRadii[nTurningRadii] = {m_Config.turningRadius(),
                                 m_Config.coverageTurningRadius() == m_Config.turningRadius()?
@@ -66,32 +132,39 @@ void SamplingBasedPlanner::expand(const std::shared_ptr<Vertex>& sourceVertex, c
         auto s = sourceVertex->getNearestPointAsState();
         // TODO! -- get some set of near points
         if (sourceVertex->state().distanceTo(s) > m_Config.collisionCheckingIncrement()) {
-            for (const auto& speed : speeds) {
-                if (speed <= 0) continue;
-                for (const auto& turningRadius : turningRadii) {
-                    if (turningRadius <= 0) continue;
-                    bool coverageAllowed = turningRadius == m_Config.coverageTurningRadius();
-                    s.speed() = speed;
-                    auto destinationVertex = Vertex::connect(sourceVertex, s, turningRadius, coverageAllowed);
-                    destinationVertex->parentEdge()->computeTrueCost(m_Config);
-                    pushVertexQueue(destinationVertex);
-                }
+            s.speed() = m_Config.maxSpeed();
+            for (const auto& turningRadius : turningRadii) {
+                if (turningRadius <= 0) continue;
+                bool coverageAllowed = turningRadius == m_Config.coverageTurningRadius();
+                auto destinationVertex = Vertex::connect(sourceVertex, s, turningRadius, coverageAllowed);
+                destinationVertex->parentEdge()->computeApproxCost();
+                connectAtAllSpeeds(sourceVertex, destinationVertex);
             }
         }
     }
-    auto comp = getStateComparator(sourceVertex->state());
+    // on the roadmap the clear curves out of here are already known, so there's no need to look through the samples
+    if (m_Roadmap && sourceVertex->sample() >= 0) {
+        expandOnRoadmap(sourceVertex);
+        m_Stats.Expanded++;
+        return;
+    }
+    // distances to all the samples in one pass, which is a lot cheaper than working them out again on every comparison
+    m_Samples.distancesSquared(sourceVertex->state().x(), sourceVertex->state().y(), m_SampleDistances);
+    auto comp = [&] (uint32_t i1, uint32_t i2) { return m_SampleDistances[i1] > m_SampleDistances[i2]; };
     auto dubinsComp = getDubinsComparator(sourceVertex->state());
     // heapify first by Euclidean distance
-    std::make_heap(m_Samples.begin(), m_Samples.end(), comp);
+    std::make_heap(m_SampleOrder.begin(), m_SampleOrder.end(), comp);
     // Use more heaps to sort by Dubins distance, skipping the samples which are farther away this time.
     // Making all the vertices adds some allocation overhead but it lets us cache the dubins paths
     std::vector<Vertex::SharedPtr> bestSamplesHeaps[nTurningRadii];
     bool doneChecks[nTurningRadii] = {false, false};
     // iterate through samples in closest (Euclidean distance) first order
-    for (uint64_t i = 0; i < m_Samples.size() && (!doneChecks[0] || !doneChecks[1]); i++) {
+    for (uint64_t i = 0; i < m_SampleOrder.size() && (!doneChecks[0] || !doneChecks[1]); i++) {
         // get closest sample
-        auto sample = m_Samples.front();
-        std::pop_heap(m_Samples.begin(), m_Samples.end() - i, comp);
+        auto sampleIndex = m_SampleOrder.front();
+        auto state = sample(sampleIndex);
+        auto distance = sqrt((double)m_SampleDistances[sampleIndex]);
+        std::pop_heap(m_SampleOrder.begin(), m_SampleOrder.end() - i, comp);
         // iterate through turning radii
         for (unsigned long j = 0; j < nTurningRadii; j++) {
             // if we've filled up the heap for this radius we can skip
@@ -106,17 +179,18 @@ void SamplingBasedPlanner::expand(const std::shared_ptr<Vertex>& sourceVertex, c
             auto& bestSamples = bestSamplesHeaps[j];
             // if we haven't filled up the heap yet or this sample could possibly be better than the worst sample
             // we've connected to so far, add it to the heap
-            if (bestSamples.size() < k() || bestSamples.front()->parentEdge()->getPlan(m_Config).length() >
-                    sample.distanceTo(sourceVertex->state())){
-                if (sourceVertex->state().distanceTo(sample) > m_Config.collisionCheckingIncrement()) {
+            if (bestSamples.size() < k() || bestSamples.front()->parentEdge()->getPlan(m_Config).length() > distance) {
+                if (distance > m_Config.collisionCheckingIncrement()) {
                     // set the speed to be the max speed for now - it could get changed later
-                    sample.speed() = m_Config.maxSpeed();
+                    state.speed() = m_Config.maxSpeed();
                     // check whether to allow coverage
                     bool coverageAllowed = turningRadius == m_Config.coverageTurningRadius();
                     // connect to the sample and push it onto the heap
-                    bestSamples.push_back(Vertex::connect(sourceVertex, sample, turningRadius, coverageAllowed));
-                    // make sure to compute the approx cost before fixing the heap
-                    bestSamples.back()->parentEdge()->computeApproxCost();
+                    bestSamples.push_back(Vertex::connect(sourceVertex, state, turningRadius, coverageAllowed));
+                    bestSamples.back()->setSample((int)sampleIndex);
+                    // make sure to compute the approx cost before fixing the heap, re-using the curve if we've been
+                    // from this sample to that one before
+                    connect(sourceVertex, bestSamples.back());
                     // fix the heap
                     std::push_heap(bestSamples.begin(), bestSamples.end(), dubinsComp);
                     // if we've filled up the heap, pop the worst sample
@@ -135,40 +209,121 @@ void SamplingBasedPlanner::expand(const std::shared_ptr<Vertex>& sourceVertex, c
         // Push the closest K onto the open list
         if (bestSamples.size() > k()) throw std::runtime_error("Somehow got too many samples in the heap");
         for (auto& destinationVertex : bestSamples) {
-            // use the wrapper from the vertex to save re-computing it but ditch the rest
-            auto wrapper = destinationVertex->parentEdge()->getPlan(m_Config);
-            for (const auto& speed : speeds) {
-                if (speed <= 0) continue;
-                // Changing the end state's speed will cause recalculation of approx cost if necessary
-                wrapper.setSpeed(speed);
-                auto v = Vertex::connect(sourceVertex, wrapper, destinationVertex->coverageAllowed());
-                v->parentEdge()->computeTrueCost(m_Config);
-                pushVertexQueue(v);
-            }
+            connectAtAllSpeeds(sourceVertex, destinationVertex);
         }
     }
     m_Stats.Expanded++;
 }
 
+void SamplingBasedPlanner::expandOnRoadmap(const Vertex::SharedPtr& sourceVertex) {
+    auto from = (uint32_t)sourceVertex->sample();
+    for (int j = 0; j < 2; j++) {
+        auto turningRadius = m_Roadmap->turningRadius(j);
+        if (turningRadius <= 0) continue;
+        bool coverageAllowed = turningRadius == m_Config.coverageTurningRadius();
+        // shortest first, so these are the nearest samples by Dubins distance (of the ones we can get to)
+        const auto& connections = m_Roadmap->connections(from, j);
+        auto count = std::min(connections.size(), (size_t)k());
+        for (size_t i = 0; i < count; i++) {
+            const auto& connection = connections[i];
+            auto state = sample(connection.To);
+            state.speed() = m_Config.maxSpeed();
+            auto destinationVertex = Vertex::connect(sourceVertex, state, turningRadius, coverageAllowed);
+            destinationVertex->setSample((int)connection.To);
+            auto& edge = *destinationVertex->parentEdge();
+            edge.computeApproxCost(connection.Path);
+            edge.useStaticCache(m_RoadmapClear);
+            connectAtAllSpeeds(sourceVertex, destinationVertex);
+        }
+    }
+}
+
+void SamplingBasedPlanner::connectAtAllSpeeds(const Vertex::SharedPtr& sourceVertex,
+                                              const Vertex::SharedPtr& destinationVertex) {
+    const auto& speeds = {m_Config.maxSpeed(), m_Config.maxSpeed() == m_Config.slowSpeed()?
+                                               -1 : m_Config.slowSpeed()};
+    // use the wrapper from the vertex to save re-computing it but ditch the rest
+    auto& templateEdge = *destinationVertex->parentEdge();
+    auto wrapper = templateEdge.getPlan(m_Config);
+    for (const auto& speed : speeds) {
+        if (speed <= 0) continue;
+        // Changing the end state's speed will cause recalculation of approx cost if necessary
+        wrapper.setSpeed(speed);
+        auto v = Vertex::connect(sourceVertex, wrapper, destinationVertex->coverageAllowed());
+        v->setSample(destinationVertex->sample());
+        // the first speed walks the curve for static obstacles and coverage, the rest re-use it
+        templateEdge.shareGeometry(*v->parentEdge());
+        v->parentEdge()->computeTrueCost(m_Config);
+        pushVertexQueue(v);
+    }
+}
+
 int SamplingBasedPlanner::k() const {
     return m_Config.branchingFactor();
 }
 
+void SamplingBasedPlanner::connect(const Vertex::SharedPtr& sourceVertex, const Vertex::SharedPtr& destinationVertex) {
+    auto& edge = *destinationVertex->parentEdge();
+    if (sourceVertex->sample() < 0) {
+        edge.computeApproxCost();
+        return;
+    }
+    auto from = (uint32_t)sourceVertex->sample(), to = (uint32_t)destinationVertex->sample();
+    auto rho = destinationVertex->turningRadius();
+    auto connection = m_Connections.find(from, to, rho);
+    if (connection) {
+        edge.computeApproxCost(connection->Path);
+        m_Stats.ReusedConnections++;
+    } else {
+        edge.computeApproxCost();
+        connection = m_Connections.add(from, to, rho, edge.getPlan(m_Config).unwrap());
+    }
+    if (connection) edge.useStaticCache(connection->Static);
+}
+
 void SamplingBasedPlanner::addSamples(StateGenerator& generator, int n) {
     m_AttemptedSamples += n;
     for (int i = 0; i < n; i++) {
         const auto s = generator.generate();
-        if (!m_Config.map()->isBlocked(s.x(), s.y()))
-            m_Samples.push_back(s);
+        if (!m_Config.map()->isBlocked(s.x(), s.y())) m_SampleOrder.push_back(m_Samples.add(s));
     }
 }
 
+void SamplingBasedPlanner::clearSamples() {
+    m_Samples.clear();
+    m_SampleOrder.clear();
+    m_Connections.clear();
+}
+
+void SamplingBasedPlanner::useRoadmap(const Roadmap::SharedPtr& roadmap) {
+    clearSamples();
+    m_Roadmap = roadmap;
+    m_RoadmapClear = nullptr;
+    if (!m_Roadmap) return;
+    // nothing writes to it, because it always covers the whole curve
+    m_RoadmapClear = std::make_shared<CollisionCache::Entry>();
+    m_Roadmap->markClear(*m_RoadmapClear);
+    reserve(0, m_Roadmap->nodes().size());
+    for (const auto& node : m_Roadmap->nodes()) m_SampleOrder.push_back(m_Samples.add(node));
+    m_AttemptedSamples += m_Samples.size();
+}
+
 void SamplingBasedPlanner::addSamples(StateGenerator& generator) {
     addSamples(generator, m_Samples.size());
 }
 
+void SamplingBasedPlanner::reserve(size_t vertices, size_t samples) {
+    m_VertexQueue.reserve(vertices);
+    m_Samples.reserve(samples);
+    m_SampleOrder.reserve(samples);
+}
+
 void SamplingBasedPlanner::clearVertexQueue() {
     m_VertexQueue.clear();
+    m_QueueBytes = m_ExpandedBytes = 0;
+    m_ExpandedVertices = 0;
+    m_Expanded.clear();
+    m_MemoryExhausted = false;
 }
 
 std::function<bool(const std::shared_ptr<Vertex>& v1, const std::shared_ptr<Vertex>& v2)> SamplingBasedPlanner::getDubinsComparator(
@@ -189,8 +344,8 @@ Planner::Stats SamplingBasedPlanner::plan(
 ) {
     m_Config = config;
     m_StartStateTime = start.time();
-    m_Samples.clear();
-    m_VertexQueue.clear();
+    clearSamples();
+    clearVertexQueue();
     m_Stats = Stats();
     double minX, maxX, minY, maxY, minSpeed = m_Config.maxSpeed(), maxSpeed = m_Config.maxSpeed();
     double magnitude = m_Config.maxSpeed() * m_Config.timeHorizon();
@@ -212,10 +367,10 @@ Planner::Stats SamplingBasedPlanner::plan(
     return m_Stats;
 }
 
-void SamplingBasedPlanner::visualizeVertex(Vertex::SharedPtr v, const std::string& tag, bool expanded) {
+void SamplingBasedPlanner::visualizeVertex(Vertex::SharedPtr v, Visualizer::Tag tag, bool expanded) {
     if (m_Config.visualizations()) {
-        m_Config.visualizationStream() << (expanded? "Expanded " : "Generated ") <<
-        v->toString() << " " << tag << " " << v->getPointerTreeString() << std::endl;
+        m_Config.visualizer().state(v->state(), v->f(), v->currentCost(), v->approxToGo(), tag,
+                expanded? Visualizer::Kind::Expanded : Visualizer::Kind::Generated, reinterpret_cast<uint64_t>(v.get()));
     }
 }
 
@@ -223,9 +378,17 @@ bool SamplingBasedPlanner::vertexQueueEmpty() const {
     return m_VertexQueue.empty();
 }
 
+size_t SamplingBasedPlanner::vertexQueueSize() const {
+    return m_VertexQueue.size();
+}
+
+bool SamplingBasedPlanner::memoryExhausted() const {
+    return m_MemoryExhausted;
+}
+
 void SamplingBasedPlanner::visualizeRibbons(const RibbonManager& ribbonManager) {
     if (m_Config.visualizations()) {
-        m_Config.visualizationStream() << ribbonManager.dumpRibbons() << "\nEnd Ribbons" << std::endl;
+        m_Config.visualizer().ribbons(ribbonManager);
     }
 }
 
@@ -235,8 +398,7 @@ void SamplingBasedPlanner::visualizePlan(const DubinsPlan& plan) {
         s.time() = plan.getStartTime();
         while (s.time() < plan.getEndTime()) {
             plan.sample(s);
-            m_Config.visualizationStream() << "State: (" << s.toStringRad() << "), f: " << 0 << ", g: " << 0 << ", h: " <<
-                                           0 << " plan" << std::endl;
+            m_Config.visualizer().state(s, 0, 0, 0, Visualizer::Tag::Plan);
             s.time() += 1;
         }
     }
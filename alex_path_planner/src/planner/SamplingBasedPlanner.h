@@ -3,6 +3,9 @@
 
 #include "Planner.h"
 #include "utilities/StateGenerator.h"
+#include "utilities/ConnectionCache.h"
+#include "utilities/Roadmap.h"
+#include "utilities/SampleSet.h"
 #include <functional>
 
 /**
@@ -37,7 +40,15 @@ public:
     std::shared_ptr<Vertex> popVertexQueue();
 
     /**
-     * Clear the open list.
+     * Make room up front for about this many vertices on the open list and samples, so the search doesn't have to
+     * reallocate as it goes.
+     * @param vertices
+     * @param samples
+     */
+    void reserve(size_t vertices, size_t samples);
+
+    /**
+     * Clear the open list. This also forgets about the vertices expanded so far as far as the memory limit goes.
      */
     void clearVertexQueue();
 
@@ -48,6 +59,22 @@ public:
      */
     virtual void expand(const std::shared_ptr<Vertex>& sourceVertex, const DynamicObstaclesManager& obstacles);
 
+    /**
+     * Connect the source vertex along the same curve as the given (not yet evaluated) destination vertex at each speed,
+     * and push the results onto the open list. The speed variants share the static obstacle and coverage checks.
+     * @param sourceVertex
+     * @param destinationVertex vertex whose parent edge has its Dubins curve computed
+     */
+    void connectAtAllSpeeds(const Vertex::SharedPtr& sourceVertex, const Vertex::SharedPtr& destinationVertex);
+
+    /**
+     * Work out the curve from the source vertex to a (just connected) destination vertex at a sample, or take it from
+     * the connection cache if both are at samples and we've done it before this cycle.
+     * @param sourceVertex
+     * @param destinationVertex
+     */
+    void connect(const Vertex::SharedPtr& sourceVertex, const Vertex::SharedPtr& destinationVertex);
+
     /**
      * Increase the number of samples.
      * @param generator
@@ -55,9 +82,30 @@ public:
     void addSamples(StateGenerator& generator);
     void addSamples(StateGenerator& generator, int n);
 
+    /**
+     * Forget the samples, and the connections between them.
+     */
+    void clearSamples();
+
+    /**
+     * Search a roadmap: its poses become the samples (so sample indices are roadmap indices), and expanding a vertex
+     * at one of them follows the roadmap's curves instead of connecting to the nearest samples, without checking them
+     * against the map again. Vertices anywhere else (like the root) still connect to the samples as usual.
+     * @param roadmap
+     */
+    void useRoadmap(const Roadmap::SharedPtr& roadmap);
+
 protected:
     double m_StartStateTime;
-    std::vector<State> m_Samples;
+    SampleSet m_Samples;
+    // sample indices, which expansion keeps in a heap by distance so the samples themselves stay put, and the squared
+    // distances (by index) from the vertex being expanded
+    std::vector<uint32_t> m_SampleOrder;
+    std::vector<float> m_SampleDistances;
+    ConnectionCache m_Connections;
+    // roadmap being searched (if any), and a static cache entry saying its curves are clear
+    Roadmap::SharedPtr m_Roadmap;
+    CollisionCache::Entry::SharedPtr m_RoadmapClear;
     unsigned long m_AttemptedSamples = 0;
     int m_ExpandedCount = 0;
 
@@ -71,6 +119,13 @@ protected:
      */
     virtual std::function<bool(std::shared_ptr<Vertex> v1, std::shared_ptr<Vertex> v2)> getVertexComparator();
 
+    /**
+     * The pose of a sample, exactly as the roadmap has it if we're searching one (so its curves join up).
+     * @param i
+     * @return
+     */
+    State sample(uint32_t i) const;
+
     /**
      * Goal condition on which to stop search.
      * @param vertex
@@ -89,7 +144,7 @@ protected:
      * @param v
      * @param tag
      */
-    void visualizeVertex(Vertex::SharedPtr v, const std::string& tag, bool expanded);
+    void visualizeVertex(Vertex::SharedPtr v, Visualizer::Tag tag, bool expanded);
 
     void visualizePlan(const DubinsPlan& plan);
 
@@ -105,15 +160,71 @@ protected:
      */
     bool vertexQueueEmpty() const;
 
+    /**
+     * How many vertices are on the open list.
+     * @return
+     */
+    size_t vertexQueueSize() const;
+
+    /**
+     * Check whether the expanded vertices the search still holds take up so much of the memory limit that the open list
+     * can't be kept useful, in which case the search should stop with what it has. Reset by clearing the open list.
+     * @return
+     */
+    bool memoryExhausted() const;
+
+    /**
+     * Take a new incumbent solution and drop everything on the open list that can't beat it.
+     * @param vertex
+     */
+    void setBestVertex(const Vertex::SharedPtr& vertex);
+
 private:
     std::vector<std::shared_ptr<Vertex>> m_VertexQueue;
 
     /**
-     * State comparison to order samples for Dubins path computation.
-     * @param origin
-     * @return
+     * Rough account of the memory the search is holding for the memory limit: what's on the open list plus the expanded
+     * vertices that are still alive. An expanded vertex is freed once nothing on the open list descends from it, so
+     * they're tracked weakly and released (see releaseExpanded) before shedding.
+     */
+    size_t m_QueueBytes = 0, m_ExpandedBytes = 0;
+    unsigned long m_ExpandedVertices = 0;
+    std::vector<std::pair<std::weak_ptr<Vertex>, size_t>> m_Expanded;
+    bool m_MemoryExhausted = false;
+
+    /**
+     * Drop everything on the open list with an f-value over the bound.
+     * @param bound
+     */
+    void compactVertexQueue(double bound);
+
+    /**
+     * Get back under the memory limit by dropping the worst vertices on the open list (leaves of the search tree, so
+     * nothing else depends on them), a bit like SMA*. This drops a good chunk at once so it doesn't have to happen on
+     * every push. If the expanded vertices still held are over their share of the limit, the open list would be cut
+     * down to almost nothing every time, so the search is told to stop instead (see memoryExhausted).
+     */
+    void shedVertexQueue();
+
+    /**
+     * Stop counting expanded vertices that have been freed since their descendants were dropped.
+     */
+    void releaseExpanded();
+
+    /**
+     * Update the peak memory stats.
+     */
+    void recordMemory();
+
+    // fraction of the memory limit to get down to when shedding, and the most of it that expanded vertices can take up
+    // before the search gives up, which leaves the open list at least the difference
+    static constexpr double c_ShedTarget = 0.75, c_ExpandedShare = 0.5;
+
+    /**
+     * Expand a vertex at a roadmap pose along the roadmap's shortest k curves out of it at each turning radius.
+     * @param sourceVertex
      */
-    std::function<bool(const State& s1, const State& s2)> getStateComparator(const State& origin);
+    void expandOnRoadmap(const Vertex::SharedPtr& sourceVertex);
 
     /**
      * Vertex comparison which uses Dubins distance to order expansion.
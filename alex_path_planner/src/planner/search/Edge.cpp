@@ -3,6 +3,65 @@
 #include <memory>
 #include "Edge.h"
 #include <cfloat>
+#include <typeinfo>
+#include "../../common/map/GeoTiffMap.h"
+#include "../../common/map/GridWorldMap.h"
+#include "../../common/dynamic_obstacles/GaussianDynamicObstaclesManager.h"
+#include "../../common/dynamic_obstacles/BinaryDynamicObstaclesManager.h"
+
+namespace {
+/**
+ * How edge evaluation calls the map. Any<...> goes through the virtual functions like everything else, and Exact<...>
+ * calls a particular class's versions directly, which lets the compiler inline them into the sampling loops. Exact is
+ * only used when the object is exactly that class (not a subclass), so it can't skip an override.
+ */
+struct AnyMap {
+    static bool isBlocked(const Map& map, double x, double y) { return map.isBlocked(x, y); }
+    static double clearance(const Map& map, double x, double y) { return map.clearance(x, y); }
+};
+
+template <class T>
+struct ExactMap {
+    static bool isBlocked(const Map& map, double x, double y) {
+        return static_cast<const T&>(map).T::isBlocked(x, y);
+    }
+    static double clearance(const Map& map, double x, double y) {
+        return static_cast<const T&>(map).T::clearance(x, y);
+    }
+};
+
+/**
+ * Check the vessel's whole footprint at a state against the map (see Footprint).
+ */
+template <class MapAccess>
+bool footprintBlocked(const Map& map, const Footprint& footprint, const State& s) {
+    return footprint.blocked(s.x(), s.y(), s.heading(),
+                             [&] (double x, double y) { return MapAccess::isBlocked(map, x, y); },
+                             [&] (double x, double y) { return MapAccess::clearance(map, x, y); });
+}
+
+/**
+ * Same idea for the obstacles manager.
+ */
+struct AnyObstacles {
+    static double collisionExists(const DynamicObstaclesManager& obstacles, const State& s) {
+        return obstacles.collisionExists(s.x(), s.y(), s.time(), true);
+    }
+    static double timeToPossibleCollision(const DynamicObstaclesManager& obstacles, const State& s) {
+        return obstacles.timeToPossibleCollision(s.x(), s.y(), s.time(), s.speed());
+    }
+};
+
+template <class T>
+struct ExactObstacles {
+    static double collisionExists(const DynamicObstaclesManager& obstacles, const State& s) {
+        return static_cast<const T&>(obstacles).T::collisionExists(s.x(), s.y(), s.time(), true);
+    }
+    static double timeToPossibleCollision(const DynamicObstaclesManager& obstacles, const State& s) {
+        return static_cast<const T&>(obstacles).T::timeToPossibleCollision(s.x(), s.y(), s.time(), s.speed());
+    }
+};
+}
 
 Edge::Edge(std::shared_ptr<Vertex> start) {
     this->m_Start = std::move(start);
@@ -65,7 +124,231 @@ double Edge::computeApproxCost() {
     return computeApproxCost(end()->state().speed(), end()->turningRadius());
 }
 
+double Edge::computeApproxCost(const DubinsPath& path) {
+    m_DubinsWrapper.fill(path, start()->state().speed(), start()->state().time());
+    m_ApproxCost = m_DubinsWrapper.length() / end()->state().speed() * Edge::timePenaltyFactor();
+    return m_ApproxCost;
+}
+
+void Edge::shareGeometry(Edge& other) {
+    if (!m_Geometry) m_Geometry = std::make_shared<Geometry>();
+    other.m_Geometry = m_Geometry;
+    if (m_StaticEntry) other.m_StaticEntry = m_StaticEntry;
+}
+
+double Edge::integrateCollisionPenalty(const PlannerConfig& config, double startTime, double endTime) const {
+    // three point Gauss-Legendre rule for arcs
+    static const double nodes[3] = {-0.7745966692414834, 0, 0.7745966692414834};
+    static const double weights[3] = {5.0 / 9, 8.0 / 9, 5.0 / 9};
+    const auto& path = m_DubinsWrapper.unwrap();
+    auto wrapperStartTime = m_DubinsWrapper.getStartTime();
+    auto speed = m_DubinsWrapper.getSpeed();
+    const auto& obstacles = config.obstaclesManager();
+    double integral = 0, segmentStartDistance = 0;
+    State s;
+    for (int i = 0; i < 3; i++) {
+        auto segmentEndDistance = segmentStartDistance + path.param[i] * path.rho;
+        auto t0 = fmax(startTime, wrapperStartTime + segmentStartDistance / speed);
+        auto t1 = fmin(endTime, wrapperStartTime + segmentEndDistance / speed);
+        segmentStartDistance = segmentEndDistance;
+        if (t1 <= t0) continue;
+        bool straight = i == 1 && path.type != RLR && path.type != LRL;
+        if (straight) {
+            m_DubinsWrapper.sampleDistance((t0 - wrapperStartTime) * speed, s);
+            integral += obstacles.integratedCollisionExists(s.x(), s.y(), speed * cos(s.yaw()), speed * sin(s.yaw()),
+                                                            t0, t1);
+        } else {
+            // pieces of at most an eighth of a turn
+            auto maxPieceTime = M_PI_4 * path.rho / speed;
+            int pieces = (int)ceil((t1 - t0) / maxPieceTime);
+            for (int j = 0; j < pieces; j++) {
+                auto a = t0 + (t1 - t0) * j / pieces, b = t0 + (t1 - t0) * (j + 1) / pieces;
+                for (int k = 0; k < 3; k++) {
+                    s.time() = (a + b) / 2 + nodes[k] * (b - a) / 2;
+                    m_DubinsWrapper.sampleDistance((s.time() - wrapperStartTime) * speed, s);
+                    integral += weights[k] * (b - a) / 2 * obstacles.collisionExists(s, true);
+                }
+            }
+        }
+    }
+    // sampling adds up one value per time increment, so divide by that to make the units agree
+    auto timeIncrement = config.collisionCheckingIncrement() / config.maxSpeed();
+    return integral / timeIncrement * Edge::collisionPenaltyFactor();
+}
+
+void Edge::useCollisionCache(CollisionCache::Entry::SharedPtr entry) {
+    m_CacheEntry = std::move(entry);
+    m_StaticEntry = m_CacheEntry;
+}
+
+void Edge::useStaticCache(CollisionCache::Entry::SharedPtr entry) {
+    m_StaticEntry = std::move(entry);
+}
+
+void Edge::usePrimitive(MotionPrimitives::Primitive::SharedPtr primitive, bool staticClear) {
+    m_Primitive = std::move(primitive);
+    m_StaticClear = staticClear;
+}
+
+template <class MapAccess>
+void Edge::probeGeometry(const PlannerConfig& config, double startDistance, double maxDistance) {
+    auto& g = *m_Geometry;
+    g.Probed = true;
+    g.ProbeStride = 0;
+    g.ProbeBlockedDistance = DBL_MAX;
+    const auto& map = *config.map();
+    auto increment = config.collisionCheckingIncrement();
+    const auto* poses = m_Primitive && startDistance == 0? &m_Primitive->Poses : nullptr;
+    // the walk's points are startDistance + i * increment for i < count
+    unsigned long count = 0;
+    while (startDistance + (double)count * increment < maxDistance) count++;
+    g.ProbeCount = count;
+    if (count == 0) return;
+
+    State s(start()->state());
+    auto probe = [&] (unsigned long i) {
+        auto d = startDistance + (double)i * increment;
+        if (poses && i < poses->size()) {
+            s.x() = start()->state().x() + (*poses)[i].X;
+            s.y() = start()->state().y() + (*poses)[i].Y;
+            s.heading() = (*poses)[i].Heading;
+        } else {
+            m_DubinsWrapper.sampleDistance(d, s);
+        }
+        if (!footprintBlocked<MapAccess>(map, config.footprint(), s)) return false;
+        g.ProbeBlockedDistance = d;
+        return true;
+    };
+
+    // running aground at the far end is the most common case, and the strides never land on it
+    if (probe(count - 1)) return;
+    unsigned long top = 1;
+    while (top * 2 < count) top *= 2;
+    unsigned long finest = 1;
+    while (finest * 2 * increment <= c_ProbeSpacing && finest * 2 <= top) finest *= 2;
+    for (auto stride = top; stride >= finest; stride /= 2) {
+        // the coarsest level gets both ends, each finer one the midpoints in between
+        auto first = stride == top? 0 : stride, step = stride == top? stride : 2 * stride;
+        for (auto i = first; i < count; i += step) {
+            if (probe(i)) return;
+        }
+        g.ProbeStride = stride;
+    }
+}
+
+template <class MapAccess>
+void Edge::walkGeometry(const PlannerConfig& config, double startDistance, double maxDistance, double fastestSpeed) {
+    auto& g = *m_Geometry;
+    const auto& map = *config.map();
+    g.Computed = true;
+    g.BlockedDistance = DBL_MAX;
+    g.RibbonsDoneDistance = -1;
+    g.CoverPoints.clear();
+    g.Ribbons = start()->ribbonManager();
+
+    // we may already know about the map along here from an earlier cycle
+    auto mapVersion = map.version();
+    bool cached = m_StaticEntry &&
+            m_StaticEntry->staticCovers(mapVersion, config.footprint(), startDistance, maxDistance);
+    if (cached) maxDistance = fmin(maxDistance, m_StaticEntry->BlockedDistance);
+    // ...or from a motion primitive's swept cells, which are only swept by a point
+    bool checkMap = !cached && !(m_StaticClear && config.footprint().isPoint());
+    // primitive poses are every increment from the start of the curve
+    const auto* poses = m_Primitive && startDistance == 0? &m_Primitive->Poses : nullptr;
+    // points the pre-pass found clear
+    auto probeStride = g.Probed && g.ProbeBlockedDistance == DBL_MAX? g.ProbeStride : 0;
+
+    State intermediate(start()->state());
+    double toCoverDistance = 0;
+    double lastHeading = start()->state().heading();
+    DubinsWrapper::Sampler sampler(m_DubinsWrapper, startDistance, config.collisionCheckingIncrement());
+    double d = startDistance;
+    // step from the start rather than accumulating so we land on the same points as the pre-pass
+    for (unsigned long i = 0; d < maxDistance; d = sampler.distance(++i)) {
+        if (poses && i < poses->size()) {
+            const auto& pose = (*poses)[i];
+            intermediate.x() = start()->state().x() + pose.X;
+            intermediate.y() = start()->state().y() + pose.Y;
+            intermediate.heading() = pose.Heading;
+        } else {
+            sampler.sample(i, intermediate);
+        }
+        bool probed = probeStride != 0 && i < g.ProbeCount && i % probeStride == 0;
+        if (checkMap && !probed && footprintBlocked<MapAccess>(map, config.footprint(), intermediate)) {
+            g.BlockedDistance = d;
+            break;
+        }
+        if (toCoverDistance > config.collisionCheckingIncrement()) {
+            toCoverDistance -= config.collisionCheckingIncrement();
+        } else {
+            // do this first because cover splits ribbons so you'd never get one that "contains" the point so it
+            // could be a bit more work
+            toCoverDistance = g.Ribbons.minDistanceFrom(intermediate.x(), intermediate.y());
+            if (end()->coverageAllowed() || lastHeading == intermediate.heading()) {
+                g.Ribbons.cover(intermediate.x(), intermediate.y(), true);
+                if (g.RibbonsDoneDistance == -1) g.CoverPoints.push_back({d, intermediate.x(), intermediate.y()});
+            }
+            if (g.Ribbons.done()) {
+                if (g.RibbonsDoneDistance == -1) g.RibbonsDoneDistance = d;
+                // no edge will go further than the time minimum past coverage, even at the fastest speed
+                maxDistance = fmin(maxDistance, g.RibbonsDoneDistance + config.timeMinimum() * fastestSpeed);
+            }
+        }
+        lastHeading = intermediate.heading();
+    }
+    if (cached && m_StaticEntry->BlockedDistance <= maxDistance) {
+        g.BlockedDistance = m_StaticEntry->BlockedDistance;
+    } else if (checkMap && m_StaticEntry) {
+        m_StaticEntry->setStatic(mapVersion, config.footprint(), startDistance,
+                                 g.BlockedDistance != DBL_MAX? g.BlockedDistance : maxDistance, g.BlockedDistance);
+    }
+    if (g.BlockedDistance != DBL_MAX) {
+        g.WalkedDistance = g.BlockedDistance;
+        return;
+    }
+    g.WalkedDistance = maxDistance;
+    // cover the last little bit
+    if (d != startDistance && g.RibbonsDoneDistance == -1) {
+        g.Ribbons.cover(intermediate.x(), intermediate.y(), true);
+        g.CoverPoints.push_back({d - config.collisionCheckingIncrement(), intermediate.x(), intermediate.y()});
+        if (g.Ribbons.done()) g.RibbonsDoneDistance = d - config.collisionCheckingIncrement();
+    }
+}
+
+int Edge::chooseEvaluator(const PlannerConfig& config) {
+    int mapIndex = 2, obstaclesIndex = 2;
+    if (config.map()) {
+        const auto& type = typeid(*config.map());
+        if (type == typeid(GeoTiffMap)) mapIndex = 0;
+        else if (type == typeid(GridWorldMap)) mapIndex = 1;
+    }
+    const auto& type = typeid(config.obstaclesManager());
+    if (type == typeid(GaussianDynamicObstaclesManager)) obstaclesIndex = 0;
+    else if (type == typeid(BinaryDynamicObstaclesManager)) obstaclesIndex = 1;
+    return mapIndex * 3 + obstaclesIndex;
+}
+
 double Edge::computeTrueCost(PlannerConfig& config) {
+    typedef double (Edge::*Evaluator)(PlannerConfig&);
+    // the combinations we actually run with; anything else goes through the virtual functions
+    static const Evaluator evaluators[9] = {
+            &Edge::evaluate<ExactMap<GeoTiffMap>, ExactObstacles<GaussianDynamicObstaclesManager>>,
+            &Edge::evaluate<ExactMap<GeoTiffMap>, ExactObstacles<BinaryDynamicObstaclesManager>>,
+            &Edge::evaluate<ExactMap<GeoTiffMap>, AnyObstacles>,
+            &Edge::evaluate<ExactMap<GridWorldMap>, ExactObstacles<GaussianDynamicObstaclesManager>>,
+            &Edge::evaluate<ExactMap<GridWorldMap>, ExactObstacles<BinaryDynamicObstaclesManager>>,
+            &Edge::evaluate<ExactMap<GridWorldMap>, AnyObstacles>,
+            &Edge::evaluate<AnyMap, ExactObstacles<GaussianDynamicObstaclesManager>>,
+            &Edge::evaluate<AnyMap, ExactObstacles<BinaryDynamicObstaclesManager>>,
+            &Edge::evaluate<AnyMap, AnyObstacles>,
+    };
+    // the config forgets its choice when the map or obstacles manager changes, so this is once per plan
+    if (config.edgeEvaluator() < 0) config.setEdgeEvaluator(chooseEvaluator(config));
+    return (this->*evaluators[config.edgeEvaluator()])(config);
+}
+
+template <class MapAccess, class ObstaclesAccess>
+double Edge::evaluate(PlannerConfig& config) {
     if (start()->state().isCoLocated(end()->state())) {
         std::cerr << "Computing cost of edge between two co-located states is likely an error" << std::endl;
     }
@@ -75,16 +358,18 @@ double Edge::computeTrueCost(PlannerConfig& config) {
     if (end()->coverageAllowed()) {
         turningRadius = config.coverageTurningRadius();
     }
-    if (m_ApproxCost == -1 || (m_DubinsWrapper.getRho() != turningRadius))
-        // if the parameters are different now we need to re-calculate the curve
+    if (m_ApproxCost == -1 || (m_DubinsWrapper.getRho() != turningRadius)) {
+        // if the parameters are different now we need to re-calculate the curve, and any shared geometry is stale
         computeApproxCost(speed, turningRadius);
+        m_Geometry.reset();
+    }
     if (m_DubinsWrapper.getSpeed() != speed) {
         // update the speed if it's different
         m_DubinsWrapper.setSpeed(speed);
     }
     if (m_ApproxCost < 0) throw std::runtime_error("Could not compute approximate cost");
+    if (!m_Geometry) m_Geometry = std::make_shared<Geometry>();
     double collisionPenalty = 0;
-    std::vector<std::pair<double, double>> result;
     State intermediate(start()->state());
     // truncate longer edges than 30 seconds
     auto endTime = fmin(config.timeHorizon() + 1e-12 + config.startStateTime(),m_DubinsWrapper.getEndTime());
@@ -92,9 +377,9 @@ double Edge::computeTrueCost(PlannerConfig& config) {
     auto ribbonsDoneTime = -1;
     auto ribbonManagerStartedDone = end()->ribbonManager().done();
 
-    double dynamicDistance = 0, toCoverDistance = 0;
-    double lastHeading = start()->state().heading();
-    int visCount = int(1.0 / config.collisionCheckingIncrement()); // counter to reduce visualization frequency
+    // only visualize every so many steps to keep the dump down
+    const unsigned long visInterval = int(1.0 / config.collisionCheckingIncrement());
+    unsigned long visStep = visInterval;
 
     auto startG = start()->currentCost();
     auto startH = start()->approxToGo();
@@ -109,6 +394,49 @@ double Edge::computeTrueCost(PlannerConfig& config) {
         m_Infeasible = true;
     }
 
+    // Static obstacles and coverage only depend on where we are along the curve, so check those in distance. Edges
+    // differing only in speed share this, so make sure it reaches far enough for us before using it.
+    auto wrapperStartTime = m_DubinsWrapper.getStartTime();
+    auto startDistance = (intermediate.time() - wrapperStartTime) * speed;
+    auto endDistance = (endTime - wrapperStartTime) * speed;
+    auto& geometry = *m_Geometry;
+    bool rejected = false;
+    if (!geometry.Computed || (geometry.BlockedDistance == DBL_MAX && geometry.WalkedDistance < endDistance &&
+            (geometry.RibbonsDoneDistance == -1 ||
+            geometry.WalkedDistance < geometry.RibbonsDoneDistance + config.timeMinimum() * speed))) {
+        auto fastestSpeed = fmax(speed, config.maxSpeed());
+        auto horizonDistance = (config.timeHorizon() + 1e-12 + config.startStateTime() - wrapperStartTime) * fastestSpeed;
+        auto maxDistance = fmin(m_DubinsWrapper.length(), horizonDistance);
+        // the cache or a motion primitive may already know about the map, in which case don't bother
+        bool known = (m_StaticClear && config.footprint().isPoint()) || m_CacheEntry ||
+                (m_StaticEntry && m_StaticEntry->staticCovers(config.map()->version(), config.footprint(),
+                                                              startDistance, maxDistance));
+        if (!geometry.Probed && !known) probeGeometry<MapAccess>(config, startDistance, maxDistance);
+        // A blocked probe before our end rules us out, unless coverage could finish (and so end the edge) before it.
+        // Getting within a ribbon width of every ribbon left is a lower bound on how far that takes.
+        auto blocked = geometry.ProbeBlockedDistance;
+        if (blocked < endDistance && !start()->ribbonManager().done()) {
+            const auto& s = start()->state();
+            double toFinish = 0;
+            for (const auto& r : start()->ribbonManager().get())
+                toFinish = fmax(toFinish, r.distance(s.x(), s.y()) - Ribbon::RibbonWidth);
+            rejected = blocked - startDistance < toFinish;
+        }
+        // otherwise walk, knowing we needn't go past the blocked probe
+        if (!rejected) walkGeometry<MapAccess>(config, startDistance, fmin(maxDistance, blocked + 1e-9), fastestSpeed);
+    }
+    if (rejected || geometry.BlockedDistance < endDistance) m_Infeasible = true;
+    auto& ribbons = end()->ribbonManager();
+    // if no prior edge has finished coverage yet, coverage finishes on this edge
+    auto coverageCompletedTime = ribbons.coverageCompletedTime();
+    if (geometry.RibbonsDoneDistance != -1 && geometry.RibbonsDoneDistance < endDistance) {
+        if (coverageCompletedTime == -1)
+            coverageCompletedTime = wrapperStartTime + geometry.RibbonsDoneDistance / speed;
+        // truncate only if we hit the time minimum *after coverage* - the adjusted end time
+        endTime = fmin(endTime, coverageCompletedTime + config.timeMinimum());
+        endDistance = (endTime - wrapperStartTime) * speed;
+    }
+
     // Collision check at max speed, even if we're going slower. This will make going slower in congested areas look
     // artificially better, because they'll accrue a smaller penalty per time
     auto timeIncrement = config.collisionCheckingIncrement() / config.maxSpeed();
@@ -119,73 +447,105 @@ double Edge::computeTrueCost(PlannerConfig& config) {
     auto timeNudge = fmod(timeSinceStart, timeIncrement);
     intermediate.time() += timeNudge;
 
+    // the penalties along here may be known from an earlier cycle too
+    const auto& obstacles = config.obstaclesManager();
+    auto obstaclesVersion = obstacles.version();
+    auto loopStartTime = intermediate.time();
+    // on/off obstacles are sampled regardless, since quadrature would miss short crossings
+    bool integrate = config.integrateObstaclePenalty() && obstacles.smoothPenalty();
+    bool penaltyCached = !integrate && m_CacheEntry &&
+            m_CacheEntry->dynamicCovers(obstaclesVersion, loopStartTime, endTime);
+    if (integrate) {
+        // the loop below is just for visualization in this case
+        if (!m_Infeasible) collisionPenalty = integrateCollisionPenalty(config, start()->state().time(), endTime);
+        penaltyCached = true;
+    } else if (penaltyCached) {
+        collisionPenalty = m_CacheEntry->penaltyBetween(loopStartTime, endTime);
+    } else if (m_CacheEntry) {
+        m_CacheEntry->HasDynamic = false;
+        m_CacheEntry->Penalties.clear();
+    }
+
     if (config.visualizations())
-        config.visualizationStream() << "Trajectory:" << std::endl;
-    // collision and coverage check along the curve
-    while (intermediate.time() < endTime) {
-        try {
-            m_DubinsWrapper.sample(intermediate);
-        }
-        catch (std::runtime_error& e) {
-            m_Infeasible = true;
-            *config.output() << "Encountered an error while collision checking: " << e.what() << std::endl;
-            break;
+        config.visualizer().trajectory();
+    // dynamic obstacle check along the curve (static ones are already done)
+    unsigned long step = 0;
+    auto wrapperSpeed = m_DubinsWrapper.getSpeed();
+    DubinsWrapper::Sampler sampler(m_DubinsWrapper, (loopStartTime - wrapperStartTime) * wrapperSpeed,
+                                   timeIncrement * wrapperSpeed);
+    while (!m_Infeasible && intermediate.time() < endTime) {
+        if (!penaltyCached || config.visualizations()) {
+            if (!m_DubinsWrapper.containsTime(intermediate.time())) {
+                m_Infeasible = true;
+                *config.output() << "Encountered an error while collision checking: invalid time "
+                    << std::to_string(intermediate.time()) << " on an edge which spans from "
+                    << std::to_string(m_DubinsWrapper.getStartTime()) << " to "
+                    << std::to_string(m_DubinsWrapper.getEndTime()) << std::endl;
+                break;
+            }
+            sampler.sample(step, intermediate);
+            intermediate.speed() = wrapperSpeed;
         }
         // visualize
-        if (config.visualizations() && visCount-- <= 0) {
-            visCount = int(1.0 / config.collisionCheckingIncrement());
+        if (config.visualizations() && step >= visStep) {
+            visStep = step + visInterval + 1;
             auto timeSoFar = intermediate.time() - start()->state().time();
             auto gSoFar = startG + timeSoFar + collisionPenalty;
             // should really put visualizeVertex somewhere accessible
             // use start H because it isn't worth it to calculate current H
-            config.visualizationStream() << "State: (" << intermediate.toStringRad() << "), f: " << gSoFar + startH <<
-                ", g: " << gSoFar << ", h: " << startH << " trajectory" << std::endl;
-        }
-        if (config.map()->isBlocked(intermediate.x(), intermediate.y())) {
-            m_Infeasible = true;
-            break;
+            config.visualizer().state(intermediate, gSoFar + startH, gSoFar, startH, Visualizer::Tag::Trajectory);
         }
 
         // assess collision penalty
-        collisionPenalty +=
-                config.obstaclesManager().collisionExists(intermediate, true) * Edge::collisionPenaltyFactor();
-
-        if (toCoverDistance > config.collisionCheckingIncrement()) {
-            toCoverDistance -= config.collisionCheckingIncrement();
-        } else {
-            // do this first because cover splits ribbons so you'd never get one that "contains" the point so it
-            // could be a bit more work
-            toCoverDistance = end()->ribbonManager().minDistanceFrom(intermediate.x(), intermediate.y());
-            if (end()->coverageAllowed() || lastHeading == intermediate.heading()) {
-                end()->ribbonManager().cover(intermediate.x(), intermediate.y(), true);
-            }
-            if (end()->ribbonManager().done()) {
-                // if no prior edge has finished coverage yet, set the coverage completed time now
-                if (end()->ribbonManager().coverageCompletedTime() == -1) {
-                    end()->ribbonManager().setCoverageCompletedTime(intermediate.time());
+        if (!penaltyCached) {
+            auto penalty = ObstaclesAccess::collisionExists(obstacles, intermediate) * Edge::collisionPenaltyFactor();
+            collisionPenalty += penalty;
+            if (m_CacheEntry && penalty != 0) m_CacheEntry->Penalties.emplace_back(intermediate.time(), penalty);
+            if (penalty == 0) {
+                // Nothing's close, so skip the steps before anything could possibly get close. Skipped steps would all
+                // have had zero penalty and we stay on the same grid, so the total comes out the same.
+                auto clearTime = fmin(ObstaclesAccess::timeToPossibleCollision(obstacles, intermediate),
+                                      endTime - intermediate.time());
+                if (clearTime > 2 * timeIncrement) {
+                    auto skip = (unsigned long)(clearTime / timeIncrement) - 1;
+                    // don't skip over the next visualized step
+                    if (config.visualizations() && visStep > step) skip = std::min(skip, visStep - step - 1);
+                    step += skip;
                 }
-                ribbonsDoneTime = intermediate.time();
-                // truncate only if we hit the time minimum *after coverage* - the adjusted end time
-                endTime = fmin(endTime, end()->ribbonManager().coverageCompletedTime() + config.timeMinimum());
             }
-
         }
-        intermediate.time() += timeIncrement;
-        lastHeading = intermediate.heading();
+
+        // step from the start rather than accumulating so skipping ahead lands exactly on the grid
+        intermediate.time() = loopStartTime + (double)++step * timeIncrement;
+    }
+    if (m_CacheEntry && !penaltyCached && !m_Infeasible) {
+        m_CacheEntry->HasDynamic = true;
+        m_CacheEntry->ObstaclesVersion = obstaclesVersion;
+        m_CacheEntry->DynamicFrom = loopStartTime;
+        m_CacheEntry->DynamicTo = endTime;
     }
     // set to the end of the edge (potentially truncated)
     end()->state().time() = endTime;
     m_DubinsWrapper.sample(end()->state());
     m_DubinsWrapper.updateEndTime(end()->state().time()); // should just be truncating the path
 
-    // cover the last little bit
-    if (end()->coverageAllowed() || lastHeading == intermediate.heading()) {
-        end()->ribbonManager().cover(intermediate.x(), intermediate.y(), true);
+    // Bring the ribbons up to the end of this edge. If the walk stopped where we did (or coverage finished before
+    // that) the ribbons at the end of the walk are right, otherwise replay the covered points we actually passed.
+    if (rejected) {
+        // nothing walked, and it doesn't matter anyway
+    } else if ((geometry.RibbonsDoneDistance != -1 && geometry.RibbonsDoneDistance < endDistance) ||
+            geometry.WalkedDistance <= endDistance + 1e-6) {
+        ribbons = geometry.Ribbons;
+    } else {
+        for (const auto& p : geometry.CoverPoints) {
+            if (p.Distance >= endDistance) break;
+            ribbons.cover(p.X, p.Y, true);
+        }
     }
-    if (end()->ribbonManager().done()) {
+    if (ribbons.done()) {
         // may need to set the time here too
-        if (end()->ribbonManager().coverageCompletedTime() == -1) {
-            end()->ribbonManager().setCoverageCompletedTime(intermediate.time());
+        if (ribbons.coverageCompletedTime() == -1) {
+            ribbons.setCoverageCompletedTime(coverageCompletedTime != -1? coverageCompletedTime : endTime);
         }
         ribbonsDoneTime = intermediate.time();
     }
@@ -7,7 +7,11 @@
 //#include "../utilities/Path.h"
 #include <alex_path_planner_common/DubinsPlan.h>
 #include "../PlannerConfig.h"
+#include <cfloat>
 #include "../utilities/Ribbon.h"
+#include "../utilities/RibbonManager.h"
+#include "../utilities/CollisionCache.h"
+#include "../utilities/MotionPrimitives.h"
 
 extern "C" {
 #include "dubins_curves/dubins.h"
@@ -69,6 +73,37 @@ public:
      */
     double computeTrueCost(PlannerConfig& config);
 
+    /**
+     * Share the speed-independent part of collision checking (static map and ribbon coverage) with another edge. Both
+     * edges must start at the same vertex and follow the same curve, differing at most in speed. Whichever edge is
+     * evaluated first does the walk along the curve and the other one just reads the results.
+     * @param other
+     */
+    void shareGeometry(Edge& other);
+
+    /**
+     * Take collision checking results from (and save them to) a cache entry that lasts across planning cycles. This only
+     * makes sense for edges along segments of the previous plan.
+     * @param entry
+     */
+    void useCollisionCache(CollisionCache::Entry::SharedPtr entry);
+
+    /**
+     * Take static map checking results from (and save them to) an entry shared with other edges along the same curve,
+     * whenever they start. Only the static part of the entry is used. Edges sharing geometry with this one (see
+     * shareGeometry) use it too.
+     * @param entry
+     */
+    void useStaticCache(CollisionCache::Entry::SharedPtr entry);
+
+    /**
+     * Tell the edge it follows a motion primitive, so it can take the poses along the curve from there instead of
+     * sampling them. The edge must have been made from the primitive (see MotionPrimitives::Primitive::place).
+     * @param primitive
+     * @param staticClear true if the primitive's swept cells are known to be clear, so the map needn't be checked
+     */
+    void usePrimitive(MotionPrimitives::Primitive::SharedPtr primitive, bool staticClear);
+
     /**
      * Retrieve the cached true cost, computing it if necessary.
      * @return
@@ -85,6 +120,14 @@ public:
     double computeApproxCost(double maxSpeed, double turningRadius);
     double computeApproxCost();
 
+    /**
+     * Same, but with the curve already worked out (from an earlier edge between the same poses, at the end vertex's
+     * turning radius) rather than working it out again.
+     * @param path
+     * @return
+     */
+    double computeApproxCost(const DubinsPath& path);
+
     /**
      * Fetch the Dubins path in this edge. Throws an exception if not computed yet.
      * @param config
@@ -142,6 +185,98 @@ private:
 
     double m_CollisionPenalty = 0;
 
+    /**
+     * Results of walking the curve in distance rather than time. Static obstacles and ribbon coverage don't care how
+     * fast we go, so edges which only differ in speed can all use one of these.
+     */
+    struct Geometry {
+        typedef std::shared_ptr<Geometry> SharedPtr;
+
+        struct CoverPoint {
+            double Distance, X, Y;
+        };
+
+        bool Computed = false;
+        // how far along the curve the walk went
+        double WalkedDistance = 0;
+        // distance of the first blocked point, if there was one
+        double BlockedDistance = DBL_MAX;
+        // distance at which the ribbons were finished, if they were
+        double RibbonsDoneDistance = -1;
+        // points that got covered along the way, so we can replay them onto edges that stop short of the walk
+        std::vector<CoverPoint> CoverPoints;
+        // ribbons as they were at the end of the walk
+        RibbonManager Ribbons;
+
+        // static pre-pass (see probeGeometry): whether it's been done, how many points along the curve it was over, the
+        // finest stride it finished with nothing blocked (0 if none) and the blocked point it found, if it found one
+        bool Probed = false;
+        unsigned long ProbeCount = 0, ProbeStride = 0;
+        double ProbeBlockedDistance = DBL_MAX;
+    };
+
+    Geometry::SharedPtr m_Geometry;
+
+    CollisionCache::Entry::SharedPtr m_CacheEntry;
+    // where the static results come from and go, which is the cache entry if there is one
+    CollisionCache::Entry::SharedPtr m_StaticEntry;
+
+    MotionPrimitives::Primitive::SharedPtr m_Primitive;
+    bool m_StaticClear = false;
+
+    /**
+     * Integrate the dynamic obstacle penalty along the curve between two times. Straight pieces are handed to the
+     * obstacles manager whole and arcs are split up for quadrature. The result is scaled to match what sampling every
+     * collision checking increment would give.
+     * @param config
+     * @param startTime
+     * @param endTime
+     * @return the collision penalty
+     */
+    double integrateCollisionPenalty(const PlannerConfig& config, double startTime, double endTime) const;
+
+    /**
+     * Walk along the curve from the start vertex, checking the static map and covering ribbons.
+     * @tparam MapAccess how to call the map (see Edge.cpp)
+     * @param config
+     * @param startDistance distance along the curve of the start vertex
+     * @param maxDistance how far along the curve to walk
+     * @param fastestSpeed fastest speed any edge sharing this walk will use (decides how far past coverage to go)
+     */
+    template <class MapAccess>
+    void walkGeometry(const PlannerConfig& config, double startDistance, double maxDistance, double fastestSpeed);
+
+    /**
+     * Look for static obstacles along the curve before walking it, in bisection order: the far end, then the ends and
+     * middle, then the quarter points and so on down to every c_ProbeSpacing metres. Edges that run aground usually do so
+     * over a good stretch, so this finds most of them after a few checks instead of walking all the way there. The probes
+     * are on the same points as the walk so it doesn't check them again.
+     * @tparam MapAccess how to call the map (see Edge.cpp)
+     * @param config
+     * @param startDistance distance along the curve of the start vertex
+     * @param maxDistance how far along the curve the walk would go
+     */
+    template <class MapAccess>
+    void probeGeometry(const PlannerConfig& config, double startDistance, double maxDistance);
+
+    /**
+     * The body of computeTrueCost, specialized for the kinds of map and obstacles manager we have so that the per-sample
+     * calls can be direct (and inlined) instead of virtual. computeTrueCost picks the specialization.
+     * @tparam MapAccess how to call the map (see Edge.cpp)
+     * @tparam ObstaclesAccess how to call the obstacles manager (see Edge.cpp)
+     * @param config
+     * @return
+     */
+    template <class MapAccess, class ObstaclesAccess>
+    double evaluate(PlannerConfig& config);
+
+    /**
+     * Work out which specialization of evaluate suits the map and obstacles manager in the config.
+     * @param config
+     * @return index into the table in computeTrueCost
+     */
+    static int chooseEvaluator(const PlannerConfig& config);
+
     /**
      * Find the net time of the edge.
      * @return
@@ -150,6 +285,8 @@ private:
 
     static constexpr double c_CollisionPenaltyFactor = 600; // no idea how to set this but this is probably too low (try 600)
     static constexpr double c_TimePenaltyFactor = 1;
+    // spacing of the finest static pre-pass probes (m)
+    static constexpr double c_ProbeSpacing = 4;
 };
 
 
@@ -89,6 +89,13 @@ int Vertex::getDepth() const {
     return 1 + parent()->getDepth();
 }
 
+size_t Vertex::memoryUsage() const {
+    // the ribbon manager is already counted in sizeof(Vertex)
+    auto bytes = sizeof(Vertex) - sizeof(RibbonManager) + m_RibbonManager.memoryUsage();
+    if (m_ParentEdge) bytes += sizeof(Edge);
+    return bytes;
+}
+
 State Vertex::getNearestPointAsState() const {
     if (m_RibbonManager.done()) throw std::logic_error("Getting nearest point with empty path");
     return m_RibbonManager.getNearestEndpointAsState(state());
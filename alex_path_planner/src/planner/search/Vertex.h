@@ -175,6 +175,19 @@ public:
      */
     bool coverageAllowed() const;
 
+    /**
+     * @return index of the planner's sample this vertex is at, or -1 if it isn't at one
+     */
+    int sample() const { return m_Sample; }
+
+    void setSample(int sample) { m_Sample = sample; }
+
+    /**
+     * Estimate the memory (bytes) the vertex takes up, including its parent edge and ribbons but not its ancestors.
+     * @return
+     */
+    size_t memoryUsage() const;
+
 private:
 
     State m_State;
@@ -185,6 +198,7 @@ private:
     double m_ApproxToGo = -1;
     double m_TurningRadius;
     bool m_CoverageIsAllowed = false;
+    int m_Sample = -1;
 };
 
 
@@ -0,0 +1,62 @@
+#include "CollisionCache.h"
+
+bool CollisionCache::Entry::staticCovers(unsigned long mapVersion, const Footprint& footprint, double from,
+                                         double to) const {
+    if (!HasStatic || MapVersion != mapVersion || from < StaticFrom) return false;
+    // results for a smaller (or just different) hull say nothing about this one
+    if (footprint.length() != FootprintLength || footprint.width() != FootprintWidth) return false;
+    // a blocked point ahead of us decides it no matter how far we got
+    if (BlockedDistance != DBL_MAX && BlockedDistance >= from) return true;
+    return StaticTo >= to;
+}
+
+void CollisionCache::Entry::setStatic(unsigned long mapVersion, const Footprint& footprint, double from, double to,
+                                      double blockedDistance) {
+    HasStatic = true;
+    MapVersion = mapVersion;
+    FootprintLength = footprint.length();
+    FootprintWidth = footprint.width();
+    StaticFrom = from;
+    StaticTo = to;
+    BlockedDistance = blockedDistance;
+}
+
+bool CollisionCache::Entry::dynamicCovers(unsigned long obstaclesVersion, double from, double to) const {
+    return HasDynamic && ObstaclesVersion == obstaclesVersion && from >= DynamicFrom && to <= DynamicTo;
+}
+
+double CollisionCache::Entry::penaltyBetween(double from, double to) const {
+    double sum = 0;
+    for (const auto& p : Penalties) {
+        if (p.first >= to) break;
+        if (p.first >= from) sum += p.second;
+    }
+    return sum;
+}
+
+CollisionCache::Entry::SharedPtr CollisionCache::get(const DubinsWrapper& segment) {
+    auto& entry = m_Entries[key(segment)];
+    if (!entry) entry = std::make_shared<Entry>();
+    return entry;
+}
+
+void CollisionCache::retain(const DubinsPlan& plan) {
+    std::map<Key, Entry::SharedPtr> kept;
+    if (!plan.empty()) {
+        for (const auto& p : plan.get()) {
+            auto it = m_Entries.find(key(p));
+            if (it != m_Entries.end()) kept.insert(*it);
+        }
+    }
+    m_Entries.swap(kept);
+}
+
+size_t CollisionCache::size() const {
+    return m_Entries.size();
+}
+
+CollisionCache::Key CollisionCache::key(const DubinsWrapper& segment) {
+    const auto& path = segment.unwrap();
+    return Key(segment.getStartTime(), path.qi[0], path.qi[1], path.qi[2], path.rho, segment.getSpeed(),
+               (int)path.type, path.param[0], path.param[1], path.param[2]);
+}
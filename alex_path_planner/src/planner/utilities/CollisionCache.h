@@ -0,0 +1,113 @@
+#ifndef SRC_COLLISIONCACHE_H
+#define SRC_COLLISIONCACHE_H
+
+#include <map>
+#include <memory>
+#include <tuple>
+#include <vector>
+#include <cfloat>
+#include <alex_path_planner_common/DubinsPlan.h>
+#include "Footprint.h"
+
+/**
+ * Class to remember collision checking results for the segments of the last plan across planning cycles. Each cycle
+ * the planner re-checks whatever is left of the previous plan, which is usually the same segments checked against the
+ * same map and obstacles as last time, so there's no need to do it all over again.
+ *
+ * Results are split into the static part (the map), tagged with the map version and the footprint checked, and the
+ * dynamic part (obstacle penalties), tagged with the obstacles version, so a change to one only makes us re-check that
+ * one.
+ */
+class CollisionCache {
+public:
+    typedef std::shared_ptr<CollisionCache> SharedPtr;
+
+    /**
+     * What we know about a single segment. Distances are along the segment from its start and times are absolute.
+     */
+    struct Entry {
+        typedef std::shared_ptr<Entry> SharedPtr;
+
+        // static map checks, done over [StaticFrom, StaticTo) in distance with a footprint of the given size
+        bool HasStatic = false;
+        unsigned long MapVersion = 0;
+        double FootprintLength = 0, FootprintWidth = 0;
+        double StaticFrom = 0, StaticTo = 0;
+        double BlockedDistance = DBL_MAX;
+
+        // dynamic obstacle checks, done over [DynamicFrom, DynamicTo) in time
+        bool HasDynamic = false;
+        unsigned long ObstaclesVersion = 0;
+        double DynamicFrom = 0, DynamicTo = 0;
+        // (time, penalty) of the samples with non-zero penalty, in increasing time
+        std::vector<std::pair<double, double>> Penalties;
+
+        /**
+         * Check whether the static results cover the given stretch of the segment.
+         * @param mapVersion
+         * @param footprint
+         * @param from
+         * @param to
+         * @return
+         */
+        bool staticCovers(unsigned long mapVersion, const Footprint& footprint, double from, double to) const;
+
+        /**
+         * Record static results.
+         * @param mapVersion
+         * @param footprint
+         * @param from
+         * @param to
+         * @param blockedDistance
+         */
+        void setStatic(unsigned long mapVersion, const Footprint& footprint, double from, double to,
+                       double blockedDistance);
+
+        /**
+         * Check whether the dynamic results cover the given stretch of time.
+         * @param obstaclesVersion
+         * @param from
+         * @param to
+         * @return
+         */
+        bool dynamicCovers(unsigned long obstaclesVersion, double from, double to) const;
+
+        /**
+         * Add up the cached penalties of the samples in [from, to). The samples were taken on the time grid from when
+         * the segment was first checked, which is off from the current one by less than one increment.
+         * @param from
+         * @param to
+         * @return
+         */
+        double penaltyBetween(double from, double to) const;
+    };
+
+    /**
+     * Get the entry for a segment, making an empty one if we haven't seen it before.
+     * @param segment
+     * @return
+     */
+    Entry::SharedPtr get(const DubinsWrapper& segment);
+
+    /**
+     * Forget about every segment not in the given plan. Call this once per cycle so the cache doesn't grow forever.
+     * @param plan
+     */
+    void retain(const DubinsPlan& plan);
+
+    /**
+     * @return the number of segments remembered
+     */
+    size_t size() const;
+
+private:
+    // start time, start pose, turning radius, speed, path type and path parameters identify a segment
+    typedef std::tuple<double, double, double, double, double, double, int, double, double, double> Key;
+
+    std::map<Key, Entry::SharedPtr> m_Entries;
+
+    static Key key(const DubinsWrapper& segment);
+};
+
+
+#endif //SRC_COLLISIONCACHE_H
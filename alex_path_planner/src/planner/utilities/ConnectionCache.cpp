@@ -0,0 +1,24 @@
+#include "ConnectionCache.h"
+
+constexpr size_t ConnectionCache::c_MaxConnections;
+
+ConnectionCache::Connection* ConnectionCache::find(uint32_t from, uint32_t to, double rho) {
+    auto it = m_Connections.find(Key{from, to, rho});
+    return it == m_Connections.end()? nullptr : &it->second;
+}
+
+ConnectionCache::Connection* ConnectionCache::add(uint32_t from, uint32_t to, double rho, const DubinsPath& path) {
+    if (m_Connections.size() >= c_MaxConnections) return nullptr;
+    auto& connection = m_Connections[Key{from, to, rho}];
+    connection.Path = path;
+    connection.Static = std::make_shared<CollisionCache::Entry>();
+    return &connection;
+}
+
+void ConnectionCache::clear() {
+    m_Connections.clear();
+}
+
+size_t ConnectionCache::size() const {
+    return m_Connections.size();
+}
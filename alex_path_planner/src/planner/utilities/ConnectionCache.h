@@ -0,0 +1,72 @@
+#ifndef SRC_CONNECTIONCACHE_H
+#define SRC_CONNECTIONCACHE_H
+
+#include <cstdint>
+#include <unordered_map>
+#include "CollisionCache.h"
+
+/**
+ * Curves between samples, remembered for one planning cycle. The search connects the same pair of samples over and
+ * over, from vertices that got to the first one at different times, speeds or with different coverage, and again every
+ * time it restarts with more samples. The curve and the static map checks along it only depend on the two poses, so
+ * they only need working out once. Each new edge then just has to do the obstacles and coverage, which depend on when
+ * and from where it starts.
+ *
+ * Samples are identified by their index in the planner's samples.
+ */
+class ConnectionCache {
+public:
+    struct Connection {
+        DubinsPath Path;
+        // static map checks along the curve. Only the static part is used: the rest depends on the start time
+        CollisionCache::Entry::SharedPtr Static;
+    };
+
+    /**
+     * @param from sample the connection starts at
+     * @param to sample it goes to
+     * @param rho turning radius
+     * @return the connection, or null if we haven't made it yet
+     */
+    Connection* find(uint32_t from, uint32_t to, double rho);
+
+    /**
+     * Remember a new connection. Once the cache is full this does nothing.
+     * @param from
+     * @param to
+     * @param rho
+     * @param path
+     * @return the connection, or null if the cache is full
+     */
+    Connection* add(uint32_t from, uint32_t to, double rho, const DubinsPath& path);
+
+    /**
+     * Forget everything, for the next cycle (or different samples).
+     */
+    void clear();
+
+    size_t size() const;
+
+    // most connections to remember in a cycle, which keeps it to some tens of megabytes
+    static constexpr size_t c_MaxConnections = 1 << 18;
+
+private:
+    struct Key {
+        uint32_t From, To;
+        double Rho;
+        bool operator==(const Key& other) const {
+            return From == other.From && To == other.To && Rho == other.Rho;
+        }
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const {
+            return std::hash<uint64_t>()(((uint64_t)key.From << 32) | key.To) ^ std::hash<double>()(key.Rho);
+        }
+    };
+
+    std::unordered_map<Key, Connection, KeyHash> m_Connections;
+};
+
+
+#endif //SRC_CONNECTIONCACHE_H
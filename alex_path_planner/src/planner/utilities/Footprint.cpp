@@ -0,0 +1,26 @@
+#include <algorithm>
+#include <stdexcept>
+#include "Footprint.h"
+
+constexpr double Footprint::c_Spacing;
+
+Footprint::Footprint(double length, double width) : m_Length(length), m_Width(width) {
+    if (length < 0 || width < 0) throw std::invalid_argument("Footprint dimensions can't be negative");
+    m_Radius = sqrt(length * length + width * width) / 2;
+    if (m_Radius == 0) return;
+    // walk around the box corner to corner, so the corners are always in there
+    double corners[5][2] = {{length / 2, width / 2}, {-length / 2, width / 2}, {-length / 2, -width / 2},
+                            {length / 2, -width / 2}, {length / 2, width / 2}};
+    for (int i = 0; i < 4; i++) {
+        auto dx = corners[i + 1][0] - corners[i][0], dy = corners[i + 1][1] - corners[i][1];
+        auto steps = std::max(1, (int)ceil(sqrt(dx * dx + dy * dy) / c_Spacing));
+        for (int j = 0; j < steps; j++) {
+            m_Outline.emplace_back(corners[i][0] + dx * j / steps, corners[i][1] + dy * j / steps);
+        }
+    }
+}
+
+bool Footprint::blocked(const Map& map, double x, double y, double heading) const {
+    return blocked(x, y, heading, [&] (double x1, double y1) { return map.isBlocked(x1, y1); },
+                   [&] (double x1, double y1) { return map.clearance(x1, y1); });
+}
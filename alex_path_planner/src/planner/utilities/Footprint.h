@@ -0,0 +1,84 @@
+#ifndef SRC_FOOTPRINT_H
+#define SRC_FOOTPRINT_H
+
+#include <cmath>
+#include <utility>
+#include <vector>
+#include "../../common/map/Map.h"
+
+/**
+ * The outline of the vessel, for checking the whole hull against the map rather than just the point where we are.
+ * Checking a dozen or so points around the hull at every step would make static collision checking a dozen times more
+ * expensive, so it asks the map how much clearance there is first. Anywhere the clearance is more than the circle
+ * around the hull (which is nearly everywhere) that one lookup settles it, and the hull's points only get checked close
+ * to something.
+ *
+ * Only the outline is checked, not the inside. Along a path the steps are much shorter than the hull, so anything that
+ * would end up inside it has to cross the outline first.
+ *
+ * The default is a point, which checks exactly what we always have.
+ */
+class Footprint {
+public:
+    Footprint() = default;
+
+    /**
+     * A box around the vessel's position.
+     * @param length metres, bow to stern
+     * @param width metres
+     */
+    Footprint(double length, double width);
+
+    bool isPoint() const { return m_Radius == 0; }
+
+    double length() const { return m_Length; }
+
+    double width() const { return m_Width; }
+
+    /**
+     * @return radius (m) of the circle around the whole hull
+     */
+    double radius() const { return m_Radius; }
+
+    /**
+     * Check the hull against the map.
+     * @param x
+     * @param y
+     * @param heading
+     * @param isBlocked whether a point (x, y) is blocked
+     * @param clearance distance (m) from a point (x, y) within which everything is clear
+     * @return whether any of the hull is blocked
+     */
+    template <typename Blocked, typename Clearance>
+    bool blocked(double x, double y, double heading, const Blocked& isBlocked, const Clearance& clearance) const {
+        if (isBlocked(x, y)) return true;
+        if (isPoint() || clearance(x, y) >= m_Radius) return false;
+        // heading is clockwise from north, so forward is (sin, cos) and starboard is (cos, -sin)
+        auto s = sin(heading), c = cos(heading);
+        for (const auto& p : m_Outline) {
+            if (isBlocked(x + p.first * s + p.second * c, y + p.first * c - p.second * s)) return true;
+        }
+        return false;
+    }
+
+    /**
+     * Same, going through the map's virtual functions.
+     * @param map
+     * @param x
+     * @param y
+     * @param heading
+     * @return
+     */
+    bool blocked(const Map& map, double x, double y, double heading) const;
+
+private:
+    double m_Length = 0, m_Width = 0, m_Radius = 0;
+    // (forward, starboard) offsets of points around the outline
+    std::vector<std::pair<double, double>> m_Outline;
+
+    // furthest apart (m) the outline's points can be. Smaller than a cell of any map we use
+    static constexpr double c_Spacing = 0.5;
+};
+
+
+#endif //SRC_FOOTPRINT_H
@@ -0,0 +1,90 @@
+#include <cmath>
+#include <set>
+#include <tuple>
+#include "MotionPrimitives.h"
+
+constexpr int MotionPrimitives::c_Headings;
+
+DubinsWrapper MotionPrimitives::Primitive::place(double x, double y, double speed, double startTime) const {
+    auto path = Path;
+    path.qi[0] = x;
+    path.qi[1] = y;
+    DubinsWrapper wrapper;
+    wrapper.fill(path, speed, startTime);
+    return wrapper;
+}
+
+MotionPrimitives::Library::SharedPtr MotionPrimitives::get(double turningRadius, double spacing, double cellSize,
+                                                           double increment) {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    for (const auto& l : m_Libraries) {
+        if (l->TurningRadius == turningRadius && l->Spacing == spacing && l->CellSize == cellSize &&
+            l->Increment == increment) return l;
+    }
+    m_Libraries.push_back(generate(turningRadius, spacing, cellSize, increment));
+    return m_Libraries.back();
+}
+
+MotionPrimitives::Library::SharedPtr MotionPrimitives::generate(double turningRadius, double spacing, double cellSize,
+                                                                double increment) {
+    auto library = std::make_shared<Library>();
+    library->TurningRadius = turningRadius;
+    library->Spacing = spacing;
+    library->CellSize = cellSize;
+    library->Increment = increment;
+    library->ByHeading.resize(c_Headings);
+    auto step = c_StepTurningRadii * turningRadius;
+    for (int i = 0; i < c_Headings; i++) {
+        std::set<std::tuple<int, int, int>> seen;
+        for (int change = -c_MaxHeadingChange; change <= c_MaxHeadingChange; change++) {
+            int j = ((i + change) % c_Headings + c_Headings) % c_Headings;
+            // aim along the chord of an arc turning through the heading change
+            auto chord = heading(i) + change * M_PI / c_Headings;
+            for (auto distance : {step, 2 * step}) {
+                if (distance != step && change != 0) continue;
+                int dx = (int)std::round(distance * sin(chord) / spacing);
+                int dy = (int)std::round(distance * cos(chord) / spacing);
+                if ((dx == 0 && dy == 0) || !seen.insert(std::make_tuple(dx, dy, j)).second) continue;
+                DubinsWrapper wrapper(State(0, 0, heading(i), 1, 0), State(dx * spacing, dy * spacing, heading(j), 1, 0),
+                                      turningRadius);
+                if (wrapper.length() > c_MaxDetour * spacing * sqrt(dx * dx + dy * dy)) continue;
+                auto primitive = std::make_shared<Primitive>();
+                primitive->StartHeading = i;
+                primitive->EndHeading = j;
+                primitive->DX = dx;
+                primitive->DY = dy;
+                primitive->Length = wrapper.length();
+                primitive->Path = wrapper.unwrap();
+                // step the same way Edge does so the poses line up with what it would have sampled
+                State s;
+                std::set<std::pair<int, int>> cells;
+                auto addCells = [&](double x, double y) {
+                    // the start could be anywhere in its cell, so a point could land in either of two cells each way
+                    auto cx = x / cellSize, cy = y / cellSize;
+                    int fx = (int)floor(cx), fy = (int)floor(cy);
+                    for (int ox = 0; ox <= (cx != fx? 1 : 0); ox++)
+                        for (int oy = 0; oy <= (cy != fy? 1 : 0); oy++)
+                            cells.emplace(fx + ox, fy + oy);
+                };
+                for (double d = 0; d < primitive->Length; d += increment) {
+                    wrapper.sampleDistance(d, s);
+                    primitive->Poses.push_back({s.x(), s.y(), s.heading()});
+                    addCells(s.x(), s.y());
+                }
+                addCells(dx * spacing, dy * spacing);
+                primitive->SweptCells.assign(cells.begin(), cells.end());
+                library->ByHeading[i].push_back(primitive);
+            }
+        }
+    }
+    return library;
+}
+
+int MotionPrimitives::headingIndex(double heading) {
+    auto index = (int)std::round(heading / (2 * M_PI / c_Headings));
+    return (index % c_Headings + c_Headings) % c_Headings;
+}
+
+double MotionPrimitives::heading(int index) {
+    return index * 2 * M_PI / c_Headings;
+}
@@ -0,0 +1,111 @@
+#ifndef SRC_MOTIONPRIMITIVES_H
+#define SRC_MOTIONPRIMITIVES_H
+
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <alex_path_planner_common/DubinsWrapper.h>
+
+/**
+ * Libraries of Dubins motion primitives for the lattice planner. The lattice is a grid of positions (spacing apart)
+ * with a fixed set of headings, and each primitive is a Dubins curve from the origin at one lattice heading to a nearby
+ * lattice point at a (possibly different) lattice heading, so chaining primitives always lands back on the lattice.
+ *
+ * Everything about a primitive that doesn't depend on where it starts is worked out once when the library is built:
+ * the poses along it every collision checking increment (which is what coverage is computed from), and the map cells
+ * it could sweep through, relative to the cell it starts in. That way a static check during search is a handful of
+ * map lookups instead of walking the curve.
+ *
+ * Libraries are built the first time they're asked for and kept, so as long as an instance is shared across planning
+ * cycles (through the planner config) they're only built once per set of parameters.
+ */
+class MotionPrimitives {
+public:
+    typedef std::shared_ptr<MotionPrimitives> SharedPtr;
+
+    struct Primitive {
+        typedef std::shared_ptr<const Primitive> SharedPtr;
+
+        struct Pose {
+            double X, Y, Heading;
+        };
+
+        // lattice heading indices at either end
+        int StartHeading, EndHeading;
+        // lattice offset of the end, in units of the lattice spacing
+        int DX, DY;
+        double Length;
+        // the curve, starting at the origin
+        DubinsPath Path;
+        // poses relative to the start, every collision checking increment starting at 0
+        std::vector<Pose> Poses;
+        // map cells (relative to the start's cell) the curve could pass through, wherever in its cell it starts
+        std::vector<std::pair<int, int>> SweptCells;
+
+        /**
+         * Make a Dubins wrapper for this primitive starting at the given position.
+         * @param x
+         * @param y
+         * @param speed
+         * @param startTime
+         * @return
+         */
+        DubinsWrapper place(double x, double y, double speed, double startTime) const;
+    };
+
+    struct Library {
+        typedef std::shared_ptr<const Library> SharedPtr;
+
+        double TurningRadius, Spacing, CellSize, Increment;
+        // primitives starting at each lattice heading
+        std::vector<std::vector<Primitive::SharedPtr>> ByHeading;
+    };
+
+    /**
+     * Get the library for the given parameters, building it if we haven't already.
+     * @param turningRadius
+     * @param spacing lattice spacing (m). Should be a multiple of cellSize
+     * @param cellSize map resolution (m)
+     * @param increment collision checking increment (m)
+     * @return
+     */
+    Library::SharedPtr get(double turningRadius, double spacing, double cellSize, double increment);
+
+    /**
+     * Build a library from scratch.
+     * @param turningRadius
+     * @param spacing
+     * @param cellSize
+     * @param increment
+     * @return
+     */
+    static Library::SharedPtr generate(double turningRadius, double spacing, double cellSize, double increment);
+
+    /**
+     * @param heading
+     * @return the nearest lattice heading index
+     */
+    static int headingIndex(double heading);
+
+    /**
+     * @param index
+     * @return the heading of a lattice heading index
+     */
+    static double heading(int index);
+
+    static constexpr int c_Headings = 16;
+
+private:
+    std::mutex m_Mutex;
+    std::vector<Library::SharedPtr> m_Libraries;
+
+    // primitives go about this many turning radii (plus a straight one twice as far)
+    static constexpr double c_StepTurningRadii = 2;
+    // how many lattice headings a primitive can turn through
+    static constexpr int c_MaxHeadingChange = 2;
+    // skip curves that are this much longer than a straight line because they loop around
+    static constexpr double c_MaxDetour = 1.5;
+};
+
+
+#endif //SRC_MOTIONPRIMITIVES_H
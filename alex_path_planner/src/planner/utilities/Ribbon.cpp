@@ -12,6 +12,7 @@ Ribbon Ribbon::split(double x, double y, bool strict) {
     if (!contains(x, y, projected, strict)) return Ribbon::empty();
     // Split the ribbon at the projected coordinates
     Ribbon r(m_StartX, m_StartY, projected.first, projected.second);
+    r.m_Id = m_Id;
     m_StartX = projected.first; m_StartY = projected.second;
     return r;
 }
@@ -2,6 +2,7 @@
 #define SRC_RIBBON_H
 
 #include <cmath>
+#include <cstdint>
 #include <utility>
 #include <string>
 #include <alex_path_planner_common/State.h>
@@ -122,9 +123,18 @@ public:
 
     static constexpr double strictModifier() { return c_StrictModifier; }
 
+    /**
+     * @return the id of the survey line this ribbon is (part of). Pieces split off a ribbon keep its id.
+     */
+    uint32_t id() const { return m_Id; }
+
+    void setId(uint32_t id) { m_Id = id; }
+
 private:
     double m_StartX, m_StartY, m_EndX, m_EndY;
 
+    uint32_t m_Id = 0;
+
     // use a tolerance to compensate for floating point errors that were happening
     static constexpr double c_Tolerance = 1e-5;
 
@@ -4,19 +4,27 @@
 #include <vector>
 #include "RibbonManager.h"
 
+std::atomic<uint64_t> RibbonManager::s_NextVersion(1);
+
 void RibbonManager::add(double x1, double y1, double x2, double y2) {
     if (m_Ribbons.size() > c_RibbonCountDangerThreshold)
         std::cerr << "Warning: adding more ribbons than can be used for TSP heuristics" << std::endl;
     Ribbon r(x1, y1, x2, y2);
+    r.setId(m_NextRibbonId++);
     add(r, m_Ribbons.end(), false);
 }
 
 void RibbonManager::cover(double x, double y, bool strict) {
     auto i = m_Ribbons.begin();
     while (i != m_Ribbons.end()) {
+        auto before = i->start();
         auto r = i->split(x, y, strict);
+        if (i->start() != before) changed();
         add(r, i, strict);
-        if (i->covered(strict)) i = m_Ribbons.erase(i);
+        if (i->covered(strict)) {
+            i = m_Ribbons.erase(i);
+            changed();
+        }
         else ++i;
     }
 }
@@ -29,111 +37,109 @@ double RibbonManager::approximateDistanceUntilDone(double x, double y, double ya
    if (done()) return 0;
     // if we're above the danger threshold just give max distance
 //    if (m_Ribbons.size() > c_RibbonCountDangerThreshold) return maxDistance(x, y);
+    const auto& m = memo();
     switch (m_Heuristic) {
         // Modified max distance heuristic
         case MaxDistance: {
-            return maxDistance(x, y);
-        }
-        case TspPointRobotNoSplitAllRibbons: {
-            return tspPointRobotNoSplitAllRibbons(m_Ribbons, 0, std::make_pair(x, y));
-        }
-        case TspDubinsNoSplitAllRibbons: {
-            return tspDubinsNoSplitAllRibbons(m_Ribbons, 0, x, y, yaw);
+            return maxDistance(m, x, y);
         }
+        case TspPointRobotNoSplitAllRibbons:
         case TspPointRobotNoSplitKRibbons: {
-            return tspPointRobotNoSplitKRibbons(m_Ribbons, 0, std::make_pair(x, y));
+            std::vector<double> transits(m.Ends.size());
+            for (size_t e = 0; e < m.Ends.size(); e++) transits[e] = distance(std::make_pair(x, y), m.Ends[e]);
+            std::vector<int> ribbonsLeft(m.Lengths.size());
+            for (size_t r = 0; r < ribbonsLeft.size(); r++) ribbonsLeft[r] = (int)r;
+            auto k = m_Heuristic == TspPointRobotNoSplitKRibbons? m_K : -1;
+            return tsp(m, ribbonsLeft, 0, transits.data(), k, k != -1);
         }
+        case TspDubinsNoSplitAllRibbons:
         case TspDubinsNoSplitKRibbons: {
-            return tspDubinsNoSplitKRibbons(m_Ribbons, 0, x, y, yaw);
+            std::vector<double> transits(m.EndStates.size());
+            for (size_t e = 0; e < m.EndStates.size(); e++) transits[e] = dubinsDistance(x, y, yaw, m.EndStates[e]);
+            std::vector<int> ribbonsLeft(m.Lengths.size());
+            for (size_t r = 0; r < ribbonsLeft.size(); r++) ribbonsLeft[r] = (int)r;
+            // the Dubins K variant has never actually sorted or limited its branches, so leave it that way
+            return tsp(m, ribbonsLeft, 0, transits.data(), -1, false);
+        }
+        case TourGuided: {
+            auto d = m.Tour? RibbonTour::distanceUntilDone(m.TourRemaining, x, y) : -1;
+            return d >= 0? d : maxDistance(m, x, y);
         }
         default: return 0;
     }
 }
 
-double RibbonManager::tspPointRobotNoSplitAllRibbons(std::list<Ribbon> ribbonsLeft, double distanceSoFar, std::pair<double, double> point) {
-    // Depth-first TSP solution
-    if (ribbonsLeft.empty()) return distanceSoFar;
-    auto min = DBL_MAX;
-    for (auto it = ribbonsLeft.begin(); it != ribbonsLeft.end(); it++) {
-        const Ribbon r = *it;
-        it = ribbonsLeft.erase(it);
-        min = fmin(min, tspPointRobotNoSplitAllRibbons(ribbonsLeft, fmax(distanceSoFar + r.length() -
-            2 * Ribbon::RibbonWidth + distance(point, r.start()), 0), r.end()));
-        min = fmin(min, tspPointRobotNoSplitAllRibbons(ribbonsLeft, fmax(distanceSoFar + r.length() -
-            2 * Ribbon::RibbonWidth + distance(point, r.end()), 0), r.start()));
-        it = ribbonsLeft.insert(it, r);
+const RibbonManager::HeuristicMemo& RibbonManager::memo() const {
+    if (m_Memo && m_Memo->Version == m_Version && m_Memo->For == m_Heuristic &&
+            m_Memo->RibbonWidth == Ribbon::RibbonWidth && m_Memo->Tour == m_Tour) {
+        return *m_Memo;
     }
-    return min;
-}
-
-double RibbonManager::tspPointRobotNoSplitKRibbons(std::list<Ribbon> ribbonsLeft, double distanceSoFar,
-                                                   std::pair<double, double> point) const {
-    if (ribbonsLeft.empty()) return distanceSoFar;
-    auto min = DBL_MAX;
-    auto comp = [&] (const Ribbon& r1, const Ribbon& r2) {
-        double min1 = fmin(distance(point, r1.start()), distance(point, r1.end()));
-        double min2 = fmin(distance(point, r2.start()), distance(point, r2.end()));
-        return min1 > min2; // should be lt except that make_heap makes a max heap
-    };
-    // Just sort the list because it's easier than trying to make it a heap.
-    // I'm not even sure it would be advantageous to use a heap because we need the constant time insert/delete,
-    // of which the heap-supporting containers are incapable, so we'd need to make a copy
-    ribbonsLeft.sort(comp);
-    int i = 0;
-    for (auto it = ribbonsLeft.begin(); it != ribbonsLeft.end(); it++) {
-        if (i++ >= m_K) break;
-        const Ribbon r = *it;
-        it = ribbonsLeft.erase(it);
-        min = fmin(min, tspPointRobotNoSplitKRibbons(ribbonsLeft, fmax(distanceSoFar + r.length()-
-            2 * Ribbon::RibbonWidth + distance(point, r.start()), 0), r.end()));
-        min = fmin(min, tspPointRobotNoSplitKRibbons(ribbonsLeft, fmax(distanceSoFar + r.length() -
-            2 * Ribbon::RibbonWidth + distance(point, r.end()), 0), r.start()));
-        it = ribbonsLeft.insert(it, r);
+    auto memo = std::make_shared<HeuristicMemo>();
+    memo->Version = m_Version;
+    memo->For = m_Heuristic;
+    memo->RibbonWidth = Ribbon::RibbonWidth;
+    for (const auto& r : m_Ribbons) {
+        memo->SumLength += r.length() - 2 * Ribbon::RibbonWidth; // can technically shortcut the ribbon on both ends
+        memo->Ends.push_back(r.start());
+        memo->Ends.push_back(r.end());
     }
-    return min;
-}
-
-
-double RibbonManager::tspDubinsNoSplitAllRibbons(std::list<Ribbon> ribbonsLeft, double distanceSoFar, double x,
-                                                 double y, double yaw) const{
-    // Depth-first TSP solution
-    if (ribbonsLeft.empty()) return distanceSoFar;
-    auto min = DBL_MAX;
-    for (auto it = ribbonsLeft.begin(); it != ribbonsLeft.end(); it++) {
-        const auto r = *it;
-        it = ribbonsLeft.erase(it);
-        auto start = r.startAsState();
-        auto end = r.endAsState();
-        min  = fmin(min, tspDubinsNoSplitAllRibbons(ribbonsLeft, fmax(distanceSoFar + r.length() - 2 * Ribbon::RibbonWidth +
-            dubinsDistance(x, y, yaw, start), 0), end.x(), end.y(), end.yaw()));
-        min  = fmin(min, tspDubinsNoSplitAllRibbons(ribbonsLeft, fmax(distanceSoFar + r.length() - 2 * Ribbon::RibbonWidth +
-            dubinsDistance(x, y, yaw, end), 0), start.x(), start.y(), start.yaw()));
-        it = ribbonsLeft.insert(it, r);
+    switch (m_Heuristic) {
+        case TspPointRobotNoSplitAllRibbons:
+        case TspPointRobotNoSplitKRibbons:
+        case TspDubinsNoSplitAllRibbons:
+        case TspDubinsNoSplitKRibbons: {
+            bool dubins = m_Heuristic == TspDubinsNoSplitAllRibbons || m_Heuristic == TspDubinsNoSplitKRibbons;
+            for (const auto& r : m_Ribbons) {
+                memo->Lengths.push_back(r.length());
+                memo->EndStates.push_back(r.startAsState());
+                memo->EndStates.push_back(r.endAsState());
+            }
+            auto n = memo->Ends.size();
+            memo->Transits.resize(n * n);
+            for (size_t from = 0; from < n; from++) {
+                for (size_t to = 0; to < n; to++) {
+                    const auto& s = memo->EndStates[from];
+                    memo->Transits[from * n + to] = dubins? dubinsDistance(s.x(), s.y(), s.yaw(), memo->EndStates[to]) :
+                                                    distance(memo->Ends[from], memo->Ends[to]);
+                }
+            }
+            break;
+        }
+        case TourGuided: {
+            memo->Tour = m_Tour;
+            if (m_Tour) memo->TourRemaining = m_Tour->remaining(m_Ribbons);
+            break;
+        }
+        default: break;
     }
-    return min;
+    m_Memo = memo;
+    return *m_Memo;
 }
 
-double RibbonManager::tspDubinsNoSplitKRibbons(std::list<Ribbon> ribbonsLeft, double distanceSoFar, double x, double y,
-                                               double yaw) const {
+double RibbonManager::tsp(const HeuristicMemo& memo, std::vector<int> ribbonsLeft, double distanceSoFar,
+                          const double* transits, int k, bool sort) {
     if (ribbonsLeft.empty()) return distanceSoFar;
     auto min = DBL_MAX;
-    auto comp = [&] (const Ribbon& r1, const Ribbon& r2) {
-        double min1 = fmin(dubinsDistance(x, y, yaw, r1.startAsState()), dubinsDistance(x, y, yaw, r1.endAsState()));
-        double min2 = fmin(dubinsDistance(x, y, yaw, r1.startAsState()), dubinsDistance(x, y, yaw, r1.endAsState()));
-        return min1 > min2;
-    };
+    if (sort) {
+        auto comp = [&] (int r1, int r2) {
+            double min1 = fmin(transits[2 * r1], transits[2 * r1 + 1]);
+            double min2 = fmin(transits[2 * r2], transits[2 * r2 + 1]);
+            return min1 > min2; // should be lt except that make_heap makes a max heap
+        };
+        std::stable_sort(ribbonsLeft.begin(), ribbonsLeft.end(), comp);
+    }
+    auto n = memo.Ends.size();
     int i = 0;
-    ribbonsLeft.sort(comp);
     for (auto it = ribbonsLeft.begin(); it != ribbonsLeft.end(); it++) {
-        if (i >= m_K) break;
-        const auto r = *it;
+        if (k != -1 && i++ >= k) break;
+        auto r = *it;
         it = ribbonsLeft.erase(it);
-        auto start = r.startAsState();
-        auto end = r.endAsState();
-        min  = fmin(min, tspDubinsNoSplitKRibbons(ribbonsLeft, fmax(distanceSoFar + r.length() - 2 * Ribbon::RibbonWidth +
-                                                                 dubinsDistance(x, y, yaw, start), 0), end.x(), end.y(), end.yaw()));
-        min  = fmin(min, tspDubinsNoSplitKRibbons(ribbonsLeft, fmax(distanceSoFar + r.length() - 2 * Ribbon::RibbonWidth +
-                                                                 dubinsDistance(x, y, yaw, end), 0), start.x(), start.y(), start.yaw()));
+        // in at the start and out at the end, or the other way round
+        auto length = memo.Lengths[r];
+        min = fmin(min, tsp(memo, ribbonsLeft, fmax(distanceSoFar + length - 2 * Ribbon::RibbonWidth +
+            transits[2 * r], 0), &memo.Transits[(2 * r + 1) * n], k, sort));
+        min = fmin(min, tsp(memo, ribbonsLeft, fmax(distanceSoFar + length - 2 * Ribbon::RibbonWidth +
+            transits[2 * r + 1], 0), &memo.Transits[2 * r * n], k, sort));
         it = ribbonsLeft.insert(it, r);
     }
     return min;
@@ -155,6 +161,7 @@ void RibbonManager::add(const Ribbon& r, std::list<Ribbon>::iterator i, bool str
     if (r.covered(strict)) return;
     // TODO! -- determine whether to split any of the prior ribbons based on this new one
     m_Ribbons.insert(i, r);
+    changed();
 }
 
 State RibbonManager::getNearestEndpointAsState(const State& state) const {
@@ -231,20 +238,18 @@ void RibbonManager::projectOntoNearestRibbon(State& state) const {
     state = ribbon.getProjectionAsState(state.x(), state.y());
 }
 
-double RibbonManager::maxDistance(double x, double y) const {
+double RibbonManager::maxDistance(const HeuristicMemo& memo, double x, double y) {
     // max represents the distance to the farthest endpoint.
     // min represents the distance to the nearest endpoint plus the sum of the lengths of all ribbons.
     // Whichever is larger is returned.
     // Both are technically inadmissible due to the "done" action but that's not implemented yet anywhere
-    double sumLength = 0, min = DBL_MAX, max = 0;
-    for (const auto& r : m_Ribbons) {
-        sumLength += r.length() - 2 * Ribbon::RibbonWidth; // can technically shortcut the ribbon on both ends
-        auto dStart = distance(r.start(), x, y);
-        auto dEnd = distance(r.end(), x, y);
-        min = fmin(fmin(min, dEnd), dStart);
-        max = fmax(fmax(max, dEnd), dStart);
+    double min = DBL_MAX, max = 0;
+    for (const auto& end : memo.Ends) {
+        auto d = distance(end, x, y);
+        min = fmin(min, d);
+        max = fmax(max, d);
     }
-    return fmax(sumLength + min, max);
+    return fmax(memo.SumLength + min, max);
 }
 
 const std::list<Ribbon>& RibbonManager::get() const {
@@ -379,7 +384,8 @@ std::vector<State> RibbonManager::findNearStatesOnRibbons(const State& start, do
 }
 
 void RibbonManager::changeHeuristicIfTooManyRibbons() {
-    if (m_Ribbons.size() > c_RibbonCountDangerThreshold) {
+    // the tour was made for lots of ribbons
+    if (m_Ribbons.size() > c_RibbonCountDangerThreshold && m_Heuristic != TourGuided) {
         m_Heuristic = MaxDistance;
     }
 }
@@ -417,3 +423,19 @@ double RibbonManager::getTotalUncoveredLength() const {
     return sum;
 }
 
+size_t RibbonManager::memoryUsage() const {
+    // list nodes carry a pair of pointers on top of the ribbon
+    return sizeof(RibbonManager) + m_Ribbons.size() * (sizeof(Ribbon) + 2 * sizeof(void*));
+}
+
+void RibbonManager::setTour(RibbonTour::SharedPtr tour) {
+    m_Tour = std::move(tour);
+}
+
+const RibbonTour::SharedPtr& RibbonManager::tour() const {
+    return m_Tour;
+}
+
+bool RibbonManager::nextTourEntry(State& entry) const {
+    return m_Tour && m_Tour->nextEntry(m_Ribbons, entry);
+}
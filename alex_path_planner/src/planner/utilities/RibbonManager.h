@@ -1,10 +1,13 @@
 #ifndef SRC_RIBBONMANAGER_H
 #define SRC_RIBBONMANAGER_H
 
+#include <atomic>
 #include <list>
+#include <memory>
 #include <vector>
 #include <alex_path_planner_common/State.h>
 #include "Ribbon.h"
+#include "RibbonTour.h"
 extern "C" {
 #include <dubins_curves/dubins.h>
 }
@@ -23,6 +26,8 @@ public:
         TspPointRobotNoSplitKRibbons,
         TspDubinsNoSplitAllRibbons,
         TspDubinsNoSplitKRibbons,
+        // follow the global tour (see setTour), or max distance if there isn't a usable one
+        TourGuided,
     };
 
     /**
@@ -154,6 +159,8 @@ public:
      */
     void setHeuristic(Heuristic heuristic);
 
+    Heuristic heuristic() const { return m_Heuristic; }
+
     /**
      * Change the ribbon width.
      * @param lineWidth
@@ -179,6 +186,37 @@ public:
      */
     double getTotalUncoveredLength() const;
 
+    /**
+     * Give the ribbons a global tour to follow. It's copied along with the ribbons (cheaply, since it's immutable).
+     * @param tour
+     */
+    void setTour(RibbonTour::SharedPtr tour);
+
+    /**
+     * @return the global tour, which may be null
+     */
+    const RibbonTour::SharedPtr& tour() const;
+
+    /**
+     * Find where the global tour gets onto the next ribbon, if there is a tour.
+     * @param entry
+     * @return false if there isn't a tour or it doesn't know about any of the ribbons left
+     */
+    bool nextTourEntry(State& entry) const;
+
+    /**
+     * Get a version number for the ribbons. It changes whenever they do (when one is added, split or removed) and copies
+     * keep it until they change, so two managers with the same version have the same ribbons.
+     * @return
+     */
+    uint64_t version() const { return m_Version; }
+
+    /**
+     * Estimate the memory (bytes) the manager takes up. Memos and tours are shared between copies so they aren't counted.
+     * @return
+     */
+    size_t memoryUsage() const;
+
 private:
     // which heuristic to use
     Heuristic m_Heuristic;
@@ -199,6 +237,12 @@ private:
      */
     std::list<Ribbon> m_Ribbons;
 
+    // id for the next ribbon added
+    uint32_t m_NextRibbonId = 1;
+
+    // global tour for the TourGuided heuristic
+    RibbonTour::SharedPtr m_Tour;
+
     /**
      * Calculate the Dubins distance between (x, y, h) and the state s.
      * @param x
@@ -217,49 +261,71 @@ private:
 
     void add(const Ribbon& r, std::list<Ribbon>::iterator i, bool strict);
 
+    // see version()
+    uint64_t m_Version = s_NextVersion++;
+    static std::atomic<uint64_t> s_NextVersion;
+
     /**
-     * Calculate the max distance heuristic.
-     * @param x
-     * @param y
-     * @return
+     * The parts of the heuristics that only depend on the ribbons, not on where we are. Most vertices don't cover
+     * anything on the way there so they have the same ribbons as their parents, and can just re-use these. Memos are
+     * immutable once made, so copies of the manager (even in other threads) can share them.
      */
-    double maxDistance(double x, double y) const;
+    struct HeuristicMemo {
+        // what the memo was made for
+        uint64_t Version;
+        Heuristic For;
+        double RibbonWidth;
+        RibbonTour::SharedPtr Tour;
+
+        // max distance: sum of ribbon lengths (shortcutting both ends) and the ribbon ends
+        double SumLength = 0;
+        std::vector<std::pair<double, double>> Ends;
+
+        // TSP: ribbon lengths, states at the ribbon ends (start then end for each ribbon) and the distances between
+        // those, Transits[from * Ends.size() + to], where from is the end you leave a ribbon by and to the one you join
+        // the next by
+        std::vector<double> Lengths;
+        std::vector<State> EndStates;
+        std::vector<double> Transits;
+
+        // tour guided
+        RibbonTour::Remaining TourRemaining;
+    };
+
+    mutable std::shared_ptr<const HeuristicMemo> m_Memo;
 
     /**
-     * Calculate the TSPDubinsNoSplitAllRibbons heuristic. As the name suggests, this uses Dubins distance between
-     * ribbons, does not split ribbons, and does not limit the branching factor in the TSP.
-     * @param ribbonsLeft
-     * @param distanceSoFar
-     * @param x
-     * @param y
-     * @param yaw
+     * Get the memo for the ribbons and heuristic as they are, making a new one if they've changed.
      * @return
      */
-    double tspDubinsNoSplitAllRibbons(std::list<Ribbon> ribbonsLeft, double distanceSoFar, double x,
-                                      double y, double yaw) const;
+    const HeuristicMemo& memo() const;
 
     /**
-     * Calculate the TSPPointRobotNoSplitKRibbons heuristic. As the name suggests, this uses Euclidean distance between
-     * ribbons, does not split ribbons, and limits the TSP branching factor to K.
-     * @param ribbonsLeft
-     * @param distanceSoFar
-     * @param point
-     * @return
+     * Note that the ribbons changed.
      */
-    double tspPointRobotNoSplitKRibbons(std::list<Ribbon> ribbonsLeft, double distanceSoFar, std::pair<double, double> point) const;
+    void changed() { m_Version = s_NextVersion++; }
 
     /**
-     * Calculate the TSPDubinsNoSplitKRibbons heuristic. As the name suggests, this uses Dubins distance between
-     * ribbons, does not split ribbons, and limits the TSP branching factor to K.
-     * @param ribbonsLeft
-     * @param distanceSoFar
+     * Calculate the max distance heuristic.
+     * @param memo
      * @param x
      * @param y
-     * @param yaw
      * @return
      */
-    double tspDubinsNoSplitKRibbons(std::list<Ribbon> ribbonsLeft, double distanceSoFar, double x,
-                                    double y, double yaw) const;
+    static double maxDistance(const HeuristicMemo& memo, double x, double y);
+
+    /**
+     * Depth-first TSP solution for the TSP heuristics. None of them split ribbons.
+     * @param memo
+     * @param ribbonsLeft indices of the ribbons left
+     * @param distanceSoFar
+     * @param transits distances from where we are to each ribbon end, like a row of the memo's transits
+     * @param k maximum branching factor, or -1 to try every ribbon
+     * @param sort whether to sort the ribbons left by distance before branching
+     * @return
+     */
+    static double tsp(const HeuristicMemo& memo, std::vector<int> ribbonsLeft, double distanceSoFar,
+                      const double* transits, int k, bool sort);
 
     /**
      * Threshold for the number of ribbons that is too many for TSP heuristics to reliably handle. This number is not
@@ -285,16 +351,6 @@ private:
     static double distance(double x1, double y1, double x2, double y2) {
         return sqrt((x1 - x2)*(x1 - x2) + (y1 - y2)*(y1 - y2));
     }
-
-    /**
-     * Calculate the TSPPointRobotNoSplitAllRibbons heuristic. As the name suggests, this uses Euclidean distance between
-     * ribbons, does not split ribbons, and does not limit the TSP branching factor.
-     * @param ribbonsLeft
-     * @param distanceSoFar
-     * @param point
-     * @return
-     */
-    static double tspPointRobotNoSplitAllRibbons(std::list<Ribbon> ribbonsLeft, double distanceSoFar, std::pair<double, double> point);
 };
 
 
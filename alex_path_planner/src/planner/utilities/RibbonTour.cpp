@@ -0,0 +1,317 @@
+#include <cfloat>
+#include <algorithm>
+#include "RibbonTour.h"
+extern "C" {
+#include <dubins_curves/dubins.h>
+}
+
+namespace {
+/**
+ * Transit distance from leaving one ribbon to getting onto the next.
+ */
+double transit(const State& from, const State& to, double turningRadius) {
+    if (turningRadius <= 0) return from.distanceTo(to);
+    DubinsPath path;
+    double q1[] = {from.x(), from.y(), from.yaw()}, q2[] = {to.x(), to.y(), to.yaw()};
+    dubins_shortest_path(&path, q1, q2, turningRadius);
+    return dubins_path_length(&path);
+}
+
+/**
+ * The tour while it's being improved. Ribbons are nodes 0..N-1 and a stop is a node with a direction.
+ *
+ * Moves are evaluated by only looking at the links they change, which relies on going from A to B costing the same as
+ * going from B to A backwards (true for straight lines and Dubins curves). Rounding could make that slightly off, so
+ * moves are only accepted once the whole tour has been re-costed.
+ */
+struct Optimizer {
+    typedef std::pair<size_t, bool> Stop;
+
+    size_t N = 0;
+    // [end][end] where end = 2 * node + (forward? 0 : 1): from the exit of the first to the entry of the second
+    std::vector<double> Costs;
+    // [end]: from the start to the entry
+    std::vector<double> StartCosts;
+    std::vector<Stop> Tour;
+    double Total = 0;
+
+    static size_t end(const Stop& s) {
+        return 2 * s.first + (s.second? 0 : 1);
+    }
+
+    static Stop flip(const Stop& s) {
+        return Stop(s.first, !s.second);
+    }
+
+    /**
+     * Cost of going from one stop to another. Null from is the start, and null to means the tour is over.
+     */
+    double link(const Stop* from, const Stop* to) const {
+        if (!to) return 0;
+        if (!from) return StartCosts[end(*to)];
+        return Costs[end(*from) * 2 * N + end(*to)];
+    }
+
+    double total(const std::vector<Stop>& tour) const {
+        double sum = link(nullptr, &tour.front());
+        for (size_t i = 1; i < tour.size(); i++) sum += link(&tour[i - 1], &tour[i]);
+        return sum;
+    }
+
+    bool accept(std::vector<Stop>& candidate) {
+        auto t = total(candidate);
+        if (t >= Total - 1e-9) return false;
+        Tour.swap(candidate);
+        Total = t;
+        return true;
+    }
+
+    /**
+     * Look for a segment to run backwards.
+     * @return true iff we found one
+     */
+    bool twoOpt(const std::function<bool()>& keepGoing, double minImprovement) {
+        for (size_t a = 0; a < N && keepGoing(); a++) {
+            auto prev = a > 0? &Tour[a - 1] : nullptr;
+            for (size_t b = a; b < N; b++) {
+                auto next = b + 1 < N? &Tour[b + 1] : nullptr;
+                auto ra = flip(Tour[a]), rb = flip(Tour[b]);
+                auto delta = link(prev, &rb) + link(&ra, next) - link(prev, &Tour[a]) - link(&Tour[b], next);
+                if (delta > -minImprovement) continue;
+                auto candidate = Tour;
+                std::reverse(candidate.begin() + a, candidate.begin() + b + 1);
+                for (size_t i = a; i <= b; i++) candidate[i].second = !candidate[i].second;
+                if (accept(candidate)) return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * Look for a short segment to move somewhere else (either way round).
+     * @return true iff we found one
+     */
+    bool orOpt(const std::function<bool()>& keepGoing, double minImprovement) {
+        for (size_t length = 1; length <= 3 && length < N; length++) {
+            for (size_t a = 0; a + length <= N && keepGoing(); a++) {
+                auto prev = a > 0? &Tour[a - 1] : nullptr;
+                auto next = a + length < N? &Tour[a + length] : nullptr;
+                const auto& first = Tour[a];
+                const auto& last = Tour[a + length - 1];
+                auto removed = link(prev, next) - link(prev, &first) - link(&last, next);
+                std::vector<Stop> rest(Tour.begin(), Tour.begin() + a);
+                rest.insert(rest.end(), Tour.begin() + a + length, Tour.end());
+                for (size_t p = 0; p <= rest.size(); p++) {
+                    auto u = p > 0? &rest[p - 1] : nullptr;
+                    auto v = p < rest.size()? &rest[p] : nullptr;
+                    for (bool reversed : {false, true}) {
+                        if (p == a && !reversed) continue; // that's where it already is
+                        auto f = reversed? flip(last) : first;
+                        auto l = reversed? flip(first) : last;
+                        auto delta = removed + link(u, &f) + link(&l, v) - link(u, v);
+                        if (delta > -minImprovement) continue;
+                        std::vector<Stop> segment(Tour.begin() + a, Tour.begin() + a + length);
+                        if (reversed) {
+                            std::reverse(segment.begin(), segment.end());
+                            for (auto& s : segment) s.second = !s.second;
+                        }
+                        auto candidate = rest;
+                        candidate.insert(candidate.begin() + p, segment.begin(), segment.end());
+                        if (accept(candidate)) return true;
+                    }
+                }
+            }
+        }
+        return false;
+    }
+};
+}
+
+RibbonTour::SharedPtr RibbonTour::plan(const std::list<Ribbon>& ribbons, const State& start, double turningRadius,
+                                       const std::function<bool()>& keepGoing, const SharedPtr& previous) {
+    auto tour = std::make_shared<RibbonTour>();
+    // one node per ribbon id, however many pieces it's in now
+    std::unordered_map<uint32_t, size_t> nodes;
+    std::vector<Span> spans;
+    std::vector<uint32_t> ids;
+    for (const auto& r : ribbons) {
+        auto it = nodes.find(r.id());
+        if (it == nodes.end()) {
+            it = nodes.emplace(r.id(), spans.size()).first;
+            spans.emplace_back();
+            ids.push_back(r.id());
+        }
+        spans[it->second].add(r);
+    }
+    if (spans.empty()) return tour;
+
+    Optimizer optimizer;
+    auto n = optimizer.N = spans.size();
+    std::vector<State> entries(2 * n), exits(2 * n);
+    for (size_t i = 0; i < n; i++) {
+        for (bool forward : {true, false}) {
+            auto e = Optimizer::end(Optimizer::Stop(i, forward));
+            entries[e] = spans[i].entry(forward);
+            exits[e] = spans[i].exit(forward);
+        }
+    }
+    optimizer.Costs.resize(4 * n * n);
+    optimizer.StartCosts.resize(2 * n);
+    for (size_t from = 0; from < 2 * n; from++) {
+        optimizer.StartCosts[from] = transit(start, entries[from], turningRadius);
+        for (size_t to = 0; to < 2 * n; to++) {
+            optimizer.Costs[from * 2 * n + to] = transit(exits[from], entries[to], turningRadius);
+        }
+    }
+
+    // start with the last tour if we have one, keeping whatever's still around
+    std::vector<bool> visited(n, false);
+    if (previous) {
+        for (const auto& leg : previous->m_Legs) {
+            auto it = nodes.find(leg.RibbonId);
+            if (it == nodes.end() || visited[it->second]) continue;
+            visited[it->second] = true;
+            optimizer.Tour.emplace_back(it->second, leg.Forward);
+        }
+    }
+    // nearest neighbour for the rest
+    while (optimizer.Tour.size() < n) {
+        auto from = optimizer.Tour.empty()? nullptr : &optimizer.Tour.back();
+        Optimizer::Stop best(0, true);
+        auto bestCost = DBL_MAX;
+        for (size_t i = 0; i < n; i++) {
+            if (visited[i]) continue;
+            for (bool forward : {true, false}) {
+                Optimizer::Stop s(i, forward);
+                auto c = optimizer.link(from, &s);
+                if (c < bestCost) {
+                    bestCost = c;
+                    best = s;
+                }
+            }
+        }
+        visited[best.first] = true;
+        optimizer.Tour.push_back(best);
+    }
+    optimizer.Total = optimizer.total(optimizer.Tour);
+
+    while (keepGoing() && (optimizer.twoOpt(keepGoing, c_MinImprovement) ||
+                           optimizer.orOpt(keepGoing, c_MinImprovement))) {}
+
+    for (const auto& s : optimizer.Tour) {
+        tour->m_Positions[ids[s.first]] = tour->m_Legs.size();
+        tour->m_Legs.push_back({ids[s.first], s.second});
+    }
+    tour->m_Cost = optimizer.Total;
+    return tour;
+}
+
+const std::vector<RibbonTour::Leg>& RibbonTour::legs() const {
+    return m_Legs;
+}
+
+double RibbonTour::cost() const {
+    return m_Cost;
+}
+
+double RibbonTour::distanceUntilDone(const std::list<Ribbon>& ribbons, double x, double y) const {
+    return distanceUntilDone(remaining(ribbons), x, y);
+}
+
+RibbonTour::Remaining RibbonTour::remaining(const std::list<Ribbon>& ribbons) const {
+    Remaining remaining;
+    std::vector<Span> s;
+    if (!spans(ribbons, s)) return remaining;
+    remaining.Usable = true;
+    double x = 0, y = 0;
+    for (size_t i = 0; i < s.size(); i++) {
+        if (!s[i].Present) continue;
+        auto entry = s[i].entry(m_Legs[i].Forward);
+        auto exit = s[i].exit(m_Legs[i].Forward);
+        if (!remaining.HasEntry) {
+            remaining.HasEntry = true;
+            remaining.EntryX = entry.x();
+            remaining.EntryY = entry.y();
+        } else {
+            remaining.Rest += sqrt((entry.x() - x) * (entry.x() - x) + (entry.y() - y) * (entry.y() - y));
+        }
+        // can technically shortcut the ribbon on both ends
+        remaining.Rest += fmax(s[i].length() - 2 * Ribbon::RibbonWidth, 0);
+        x = exit.x();
+        y = exit.y();
+    }
+    return remaining;
+}
+
+double RibbonTour::distanceUntilDone(const Remaining& remaining, double x, double y) {
+    if (!remaining.Usable) return -1;
+    if (!remaining.HasEntry) return 0;
+    auto dx = remaining.EntryX - x, dy = remaining.EntryY - y;
+    return sqrt(dx * dx + dy * dy) + remaining.Rest;
+}
+
+bool RibbonTour::nextEntry(const std::list<Ribbon>& ribbons, State& entry) const {
+    std::vector<Span> s;
+    spans(ribbons, s);
+    for (size_t i = 0; i < s.size(); i++) {
+        if (!s[i].Present) continue;
+        entry = s[i].entry(m_Legs[i].Forward);
+        return true;
+    }
+    return false;
+}
+
+bool RibbonTour::spans(const std::list<Ribbon>& ribbons, std::vector<Span>& spans) const {
+    spans.resize(m_Legs.size());
+    bool all = true;
+    for (const auto& r : ribbons) {
+        auto it = m_Positions.find(r.id());
+        if (it == m_Positions.end()) all = false;
+        else spans[it->second].add(r);
+    }
+    return all;
+}
+
+void RibbonTour::Span::add(const Ribbon& r) {
+    auto start = r.start(), end = r.end();
+    if (!Present) {
+        Present = true;
+        OriginX = StartX = start.first;
+        OriginY = StartY = start.second;
+        EndX = end.first;
+        EndY = end.second;
+        auto length = r.length();
+        if (length > 0) {
+            DirectionX = (end.first - start.first) / length;
+            DirectionY = (end.second - start.second) / length;
+        }
+        From = 0;
+        To = length;
+        return;
+    }
+    auto from = (start.first - OriginX) * DirectionX + (start.second - OriginY) * DirectionY;
+    auto to = (end.first - OriginX) * DirectionX + (end.second - OriginY) * DirectionY;
+    if (from < From) {
+        From = from;
+        StartX = start.first;
+        StartY = start.second;
+    }
+    if (to > To) {
+        To = to;
+        EndX = end.first;
+        EndY = end.second;
+    }
+}
+
+State RibbonTour::Span::entry(bool forward) const {
+    State s(forward? StartX : EndX, forward? StartY : EndY, 0, 0, 0);
+    s.setHeadingTowards(forward? EndX : StartX, forward? EndY : StartY);
+    return s;
+}
+
+State RibbonTour::Span::exit(bool forward) const {
+    auto s = entry(forward);
+    s.x() = forward? EndX : StartX;
+    s.y() = forward? EndY : StartY;
+    return s;
+}
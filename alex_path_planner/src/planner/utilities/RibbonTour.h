@@ -0,0 +1,138 @@
+#ifndef SRC_RIBBONTOUR_H
+#define SRC_RIBBONTOUR_H
+
+#include <functional>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "Ribbon.h"
+
+/**
+ * A global ordering (and direction) for covering all the remaining ribbons. The receding horizon planner only looks
+ * ~30s ahead and the TSP heuristics can only handle a handful of ribbons, so on a long survey it tends to wander. A
+ * tour gives it something to follow: a cost-to-go for the heuristic and the next ribbon entry as a goal to aim for.
+ *
+ * Tours are built from a nearest neighbour ordering and improved with 2-opt and Or-opt moves over Dubins transit costs
+ * between ribbon ends. That's too slow to do per vertex so the executive keeps one improving in the background.
+ *
+ * Tours are immutable once planned so they can be shared between threads. They refer to ribbons by id, so they still
+ * apply as the ribbons get covered and split up; ribbons the tour doesn't know about make it unusable.
+ */
+class RibbonTour {
+public:
+    typedef std::shared_ptr<const RibbonTour> SharedPtr;
+
+    struct Leg {
+        uint32_t RibbonId;
+        // whether to run the ribbon start to end (as opposed to end to start)
+        bool Forward;
+    };
+
+    /**
+     * Plan a tour of the given ribbons starting from a state.
+     * @param ribbons
+     * @param start
+     * @param turningRadius used for transit costs between ribbons. If this isn't positive, use straight lines
+     * @param keepGoing checked between improvement moves; stop improving when it returns false
+     * @param previous a tour to start from instead of nearest neighbour, if it isn't null. New ribbons get appended
+     * @return
+     */
+    static SharedPtr plan(const std::list<Ribbon>& ribbons, const State& start, double turningRadius,
+                          const std::function<bool()>& keepGoing, const SharedPtr& previous = nullptr);
+
+    const std::vector<Leg>& legs() const;
+
+    /**
+     * @return the total transit distance (not counting the ribbons themselves), including getting to the first one
+     */
+    double cost() const;
+
+    /**
+     * The part of distanceUntilDone that doesn't depend on where we are.
+     */
+    struct Remaining {
+        // false if there's a ribbon that isn't in the tour
+        bool Usable = false;
+        // false if there aren't any ribbons left, in which case there's no entry
+        bool HasEntry = false;
+        // where the tour gets onto the first ribbon left
+        double EntryX = 0, EntryY = 0;
+        // distance from there until done
+        double Rest = 0;
+    };
+
+    /**
+     * Estimate the distance to cover the given ribbons by following the tour from (x, y), using straight lines between
+     * ribbons. Ribbons are spanned end to end, so any bits already covered in the middle count too.
+     * @param ribbons
+     * @param x
+     * @param y
+     * @return the distance, or -1 if there's a ribbon that isn't in the tour
+     */
+    double distanceUntilDone(const std::list<Ribbon>& ribbons, double x, double y) const;
+
+    /**
+     * Work out everything distanceUntilDone needs except where we are, so it can be done once per set of ribbons.
+     * @param ribbons
+     * @return
+     */
+    Remaining remaining(const std::list<Ribbon>& ribbons) const;
+
+    /**
+     * Finish off distanceUntilDone from what remaining gave.
+     * @param remaining
+     * @param x
+     * @param y
+     * @return the distance, or -1 if the tour isn't usable
+     */
+    static double distanceUntilDone(const Remaining& remaining, double x, double y);
+
+    /**
+     * Find where to get onto the first of the given ribbons the tour goes to.
+     * @param ribbons
+     * @param entry set to the ribbon end to start from, heading along the ribbon
+     * @return false if there isn't one (the tour has none of the ribbons)
+     */
+    bool nextEntry(const std::list<Ribbon>& ribbons, State& entry) const;
+
+private:
+    std::vector<Leg> m_Legs;
+    // position of each ribbon id in the tour
+    std::unordered_map<uint32_t, size_t> m_Positions;
+    double m_Cost = 0;
+
+    /**
+     * The extent of whatever's left of a ribbon, taken over all of its pieces.
+     */
+    struct Span {
+        bool Present = false;
+        double StartX = 0, StartY = 0, EndX = 0, EndY = 0;
+        // the first piece we saw and its direction, which all the pieces share
+        double OriginX = 0, OriginY = 0, DirectionX = 0, DirectionY = 0;
+        // extent along the direction from the origin
+        double From = 0, To = 0;
+
+        double length() const { return To - From; }
+
+        void add(const Ribbon& r);
+
+        State entry(bool forward) const;
+
+        State exit(bool forward) const;
+    };
+
+    /**
+     * Gather the ribbons' spans in tour order.
+     * @param ribbons
+     * @param spans
+     * @return false if there's a ribbon that isn't in the tour
+     */
+    bool spans(const std::list<Ribbon>& ribbons, std::vector<Span>& spans) const;
+
+    // (a tiny bit) better than this isn't worth another pass
+    static constexpr double c_MinImprovement = 1e-6;
+};
+
+
+#endif //SRC_RIBBONTOUR_H
@@ -0,0 +1,117 @@
+#include <algorithm>
+#include "Roadmap.h"
+#include "StateGenerator.h"
+
+constexpr int Roadmap::c_Neighbours;
+constexpr unsigned long Roadmap::c_Seed;
+
+Roadmap::SharedPtr Roadmap::build(const Map::SharedPtr& map, const RibbonManager& ribbons, double turningRadius,
+                                  double coverageTurningRadius, const Footprint& footprint, double increment, int nodes,
+                                  const std::function<bool()>& keepGoing) {
+    if (ribbons.get().empty() || nodes <= 0) return nullptr;
+    auto roadmap = std::make_shared<Roadmap>();
+    roadmap->m_TurningRadii[0] = turningRadius;
+    roadmap->m_TurningRadii[1] = coverageTurningRadius == turningRadius? -1 : coverageTurningRadius;
+    roadmap->m_MapVersion = map->version();
+    roadmap->m_FootprintLength = footprint.length();
+    roadmap->m_FootprintWidth = footprint.width();
+
+    // the survey's bounding box, with room to turn around at the ends of the lines
+    double minX = DBL_MAX, maxX = -DBL_MAX, minY = DBL_MAX, maxY = -DBL_MAX;
+    for (const auto& r : ribbons.get()) {
+        for (const auto& p : {r.start(), r.end()}) {
+            minX = fmin(minX, p.first);
+            maxX = fmax(maxX, p.first);
+            minY = fmin(minY, p.second);
+            maxY = fmax(maxY, p.second);
+        }
+    }
+    auto margin = 2 * fmax(turningRadius, coverageTurningRadius);
+    auto extremes = map->extremes();
+    StateGenerator generator(fmax(minX - margin, extremes[0]), fmin(maxX + margin, extremes[1]),
+                             fmax(minY - margin, extremes[2]), fmin(maxY + margin, extremes[3]), 0, 0, c_Seed, ribbons);
+    auto& poses = roadmap->m_Nodes;
+    poses.reserve(nodes);
+    for (int i = 0; i < nodes; i++) {
+        auto s = generator.generate();
+        if (!footprint.blocked(*map, s.x(), s.y(), s.heading())) poses.push_back(s);
+    }
+
+    auto n = (uint32_t)poses.size();
+    for (int j = 0; j < 2; j++) {
+        if (roadmap->m_TurningRadii[j] > 0) roadmap->m_Connections[j].resize(n);
+    }
+    std::vector<std::pair<double, uint32_t>> near;
+    near.reserve(n);
+    for (uint32_t i = 0; i < n; i++) {
+        if (!keepGoing()) return nullptr;
+        // nearest neighbours, leaving out any practically on top of this one
+        near.clear();
+        for (uint32_t other = 0; other < n; other++) {
+            auto d = poses[i].distanceTo(poses[other]);
+            if (other != i && d > increment) near.emplace_back(d, other);
+        }
+        auto count = std::min(near.size(), (size_t)c_Neighbours);
+        std::partial_sort(near.begin(), near.begin() + count, near.end());
+        for (int j = 0; j < 2; j++) {
+            auto rho = roadmap->m_TurningRadii[j];
+            if (rho <= 0) continue;
+            auto& connections = roadmap->m_Connections[j][i];
+            for (size_t k = 0; k < count; k++) {
+                DubinsWrapper wrapper(poses[i], poses[near[k].second], rho);
+                if (clear(wrapper, *map, footprint, increment))
+                    connections.push_back(Connection{near[k].second, wrapper.unwrap(), wrapper.length()});
+            }
+            std::sort(connections.begin(), connections.end(), [] (const Connection& c1, const Connection& c2) {
+                return c1.Length < c2.Length;
+            });
+            connections.shrink_to_fit();
+        }
+    }
+    return roadmap;
+}
+
+bool Roadmap::clear(const DubinsWrapper& wrapper, const Map& map, const Footprint& footprint, double increment) {
+    auto length = wrapper.length();
+    DubinsWrapper::Sampler sampler(wrapper, 0, increment);
+    State s;
+    auto last = (unsigned long)(length / increment);
+    for (unsigned long i = 0; i <= last;) {
+        sampler.sample(i, s);
+        if (footprint.blocked(map, s.x(), s.y(), s.heading())) return false;
+        // the curve can't get any further from here than it goes, so everything up to the clearance (less the hull)
+        // along it is clear too
+        auto stride = (map.clearance(s.x(), s.y()) - footprint.radius()) / increment;
+        i += stride > 1? (unsigned long)stride : 1;
+    }
+    wrapper.sampleDistance(length, s);
+    return !footprint.blocked(map, s.x(), s.y(), s.heading());
+}
+
+bool Roadmap::suits(const Map& map, double turningRadius, double coverageTurningRadius,
+                    const Footprint& footprint) const {
+    return map.version() == m_MapVersion && turningRadius == m_TurningRadii[0] &&
+           (coverageTurningRadius == turningRadius? -1 : coverageTurningRadius) == m_TurningRadii[1] &&
+           footprint.length() == m_FootprintLength && footprint.width() == m_FootprintWidth;
+}
+
+void Roadmap::markClear(CollisionCache::Entry& entry) const {
+    entry.setStatic(m_MapVersion, Footprint(m_FootprintLength, m_FootprintWidth), 0, DBL_MAX, DBL_MAX);
+}
+
+size_t Roadmap::size() const {
+    size_t size = 0;
+    for (const auto& byRadius : m_Connections) {
+        for (const auto& connections : byRadius) size += connections.size();
+    }
+    return size;
+}
+
+size_t Roadmap::memoryUsage() const {
+    auto bytes = sizeof(Roadmap) + m_Nodes.capacity() * sizeof(State);
+    for (const auto& byRadius : m_Connections) {
+        bytes += byRadius.capacity() * sizeof(std::vector<Connection>);
+        for (const auto& connections : byRadius) bytes += connections.capacity() * sizeof(Connection);
+    }
+    return bytes;
+}
@@ -0,0 +1,122 @@
+#ifndef SRC_ROADMAP_H
+#define SRC_ROADMAP_H
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+#include <alex_path_planner_common/DubinsWrapper.h>
+#include "CollisionCache.h"
+#include "Footprint.h"
+#include "RibbonManager.h"
+#include "../../common/map/Map.h"
+
+/**
+ * A fixed set of poses over the survey area with the Dubins curves between nearby ones, worked out once (in the
+ * background) when the survey starts. Each pose is connected to its nearest neighbours at both turning radii, and only
+ * the curves that are clear of the map (with the whole footprint) are kept. Searching the roadmap means the curves
+ * between its poses are never computed or checked against the map again while planning; the search only has to do the
+ * dynamic obstacles and coverage along them, which do depend on when we get there.
+ *
+ * A roadmap is only any good for the map it was built against, the same turning radii and the same footprint, which is
+ * what suits() checks.
+ */
+class Roadmap {
+public:
+    typedef std::shared_ptr<const Roadmap> SharedPtr;
+
+    struct Connection {
+        // index of the pose the curve goes to
+        uint32_t To;
+        // the curve, which is clear of the map all the way, and its length
+        DubinsPath Path;
+        double Length;
+    };
+
+    /**
+     * Build a roadmap. This takes a while (seconds for a few thousand poses) so it's meant to run in the background.
+     * @param map map to check against. It mustn't change while this runs
+     * @param ribbons the survey. Poses cover its bounding box plus a margin to turn around in
+     * @param turningRadius
+     * @param coverageTurningRadius
+     * @param footprint
+     * @param increment collision checking increment (m)
+     * @param nodes how many poses to try (blocked ones are dropped)
+     * @param keepGoing checked every so often. If it says to stop, this gives up and returns null
+     * @return the roadmap, or null if it was stopped or there's nothing to survey
+     */
+    static SharedPtr build(const Map::SharedPtr& map, const RibbonManager& ribbons, double turningRadius,
+                           double coverageTurningRadius, const Footprint& footprint, double increment, int nodes,
+                           const std::function<bool()>& keepGoing = [] { return true; });
+
+    /**
+     * @return the poses (with no speed or time)
+     */
+    const std::vector<State>& nodes() const { return m_Nodes; }
+
+    /**
+     * Clear curves out of a pose, shortest first.
+     * @param node
+     * @param radius 0 for the turning radius, 1 for the coverage turning radius
+     * @return
+     */
+    const std::vector<Connection>& connections(uint32_t node, int radius) const {
+        return m_Connections[radius][node];
+    }
+
+    /**
+     * @param radius 0 or 1, as for connections
+     * @return the turning radius the curves were made with, or -1 if they're the same and only the first is used
+     */
+    double turningRadius(int radius) const { return m_TurningRadii[radius]; }
+
+    /**
+     * Whether this roadmap can be searched with the given map, turning radii and footprint.
+     * @param map
+     * @param turningRadius
+     * @param coverageTurningRadius
+     * @param footprint
+     * @return
+     */
+    bool suits(const Map& map, double turningRadius, double coverageTurningRadius, const Footprint& footprint) const;
+
+    /**
+     * Mark a cache entry as having checked the whole of a roadmap curve against the map and found it clear, so edges
+     * along it skip the static checks.
+     * @param entry
+     */
+    void markClear(CollisionCache::Entry& entry) const;
+
+    /**
+     * @return total number of connections kept
+     */
+    size_t size() const;
+
+    size_t memoryUsage() const;
+
+    // how many neighbours each pose is connected to (at each radius) before dropping the blocked ones
+    static constexpr int c_Neighbours = 16;
+
+private:
+    std::vector<State> m_Nodes;
+    std::vector<std::vector<Connection>> m_Connections[2];
+    double m_TurningRadii[2] = {-1, -1};
+    unsigned long m_MapVersion = 0;
+    double m_FootprintLength = 0, m_FootprintWidth = 0;
+
+    /**
+     * Check a curve against the map every increment, striding over stretches the map's clearance says are empty.
+     * @param wrapper
+     * @param map
+     * @param footprint
+     * @param increment
+     * @return whether it's clear the whole way
+     */
+    static bool clear(const DubinsWrapper& wrapper, const Map& map, const Footprint& footprint, double increment);
+
+    // fixed so the same survey always gets the same roadmap
+    static constexpr unsigned long c_Seed = 7;
+};
+
+
+#endif //SRC_ROADMAP_H
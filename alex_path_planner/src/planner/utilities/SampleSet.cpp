@@ -0,0 +1,45 @@
+#include "SampleSet.h"
+
+uint32_t SampleSet::add(const State& s) {
+    if (empty()) {
+        m_OriginX = s.x();
+        m_OriginY = s.y();
+    }
+    m_X.push_back((float)(s.x() - m_OriginX));
+    m_Y.push_back((float)(s.y() - m_OriginY));
+    m_Heading.push_back((float)s.heading());
+    return (uint32_t)(m_X.size() - 1);
+}
+
+State SampleSet::state(uint32_t i) const {
+    return State(m_OriginX + m_X[i], m_OriginY + m_Y[i], m_Heading[i], 0, 0);
+}
+
+void SampleSet::distancesSquared(double x, double y, std::vector<float>& out) const {
+    auto n = size();
+    out.resize(n);
+    auto qx = (float)(x - m_OriginX), qy = (float)(y - m_OriginY);
+    const float* xs = m_X.data();
+    const float* ys = m_Y.data();
+    float* d = out.data();
+    for (size_t i = 0; i < n; i++) {
+        auto dx = xs[i] - qx, dy = ys[i] - qy;
+        d[i] = dx * dx + dy * dy;
+    }
+}
+
+void SampleSet::reserve(size_t n) {
+    m_X.reserve(n);
+    m_Y.reserve(n);
+    m_Heading.reserve(n);
+}
+
+void SampleSet::clear() {
+    m_X.clear();
+    m_Y.clear();
+    m_Heading.clear();
+}
+
+size_t SampleSet::memoryUsage() const {
+    return sizeof(SampleSet) + (m_X.capacity() + m_Y.capacity() + m_Heading.capacity()) * sizeof(float);
+}
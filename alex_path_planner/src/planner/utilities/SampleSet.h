@@ -0,0 +1,57 @@
+#ifndef SRC_SAMPLESET_H
+#define SRC_SAMPLESET_H
+
+#include <cstdint>
+#include <vector>
+#include <alex_path_planner_common/State.h>
+
+/**
+ * The planner's samples, kept as separate arrays of floats rather than States. A sample is only a pose (the speed gets
+ * set when connecting to it and the time when the edge is evaluated), so a State's five doubles are mostly wasted, and
+ * the search goes through all the samples' positions on every expansion. Positions are relative to the first sample
+ * added, which keeps them within a survey's width or so of the origin where floats are good to well under a millimetre.
+ * That way finding distances to all the samples is a tight loop over two small arrays the compiler can vectorize.
+ */
+class SampleSet {
+public:
+    /**
+     * Add a sample.
+     * @param s
+     * @return its index
+     */
+    uint32_t add(const State& s);
+
+    /**
+     * @param i
+     * @return the sample's pose, with no speed or time
+     */
+    State state(uint32_t i) const;
+
+    /**
+     * Squared distances from a point to every sample, in index order.
+     * @param x
+     * @param y
+     * @param out resized to the number of samples
+     */
+    void distancesSquared(double x, double y, std::vector<float>& out) const;
+
+    size_t size() const { return m_X.size(); }
+
+    bool empty() const { return m_X.empty(); }
+
+    void reserve(size_t n);
+
+    /**
+     * Forget the samples. The next one added becomes the new origin.
+     */
+    void clear();
+
+    size_t memoryUsage() const;
+
+private:
+    double m_OriginX = 0, m_OriginY = 0;
+    std::vector<float> m_X, m_Y, m_Heading;
+};
+
+
+#endif //SRC_SAMPLESET_H
@@ -0,0 +1,113 @@
+#include <cstring>
+#include <chrono>
+#include <algorithm>
+#include <type_traits>
+#include "Visualizer.h"
+#include "RibbonManager.h"
+
+namespace {
+/**
+ * Little helper to lay out a record field by field (no padding). Everything we run on is little-endian, which is what
+ * the decoder expects.
+ */
+template <size_t N>
+struct RecordBuilder {
+    char Data[N];
+    size_t Size = 0;
+
+    template <typename T>
+    RecordBuilder& operator<<(T value) {
+        static_assert(std::is_trivially_copyable<T>::value, "Records can only hold plain values");
+        memcpy(Data + Size, &value, sizeof(T));
+        Size += sizeof(T);
+        return *this;
+    }
+};
+}
+
+Visualizer::Visualizer(const std::string& path) : m_Buffer(c_Capacity) {
+    m_Stream.open(path, std::ios::trunc | std::ios::out | std::ios::binary);
+    m_Stream.write("ALXV", 4);
+    uint32_t version = c_FormatVersion;
+    m_Stream.write(reinterpret_cast<const char*>(&version), sizeof(version));
+    m_Writer = std::thread(&Visualizer::run, this);
+}
+
+Visualizer::~Visualizer() {
+    m_Running = false;
+    if (m_Writer.joinable()) m_Writer.join();
+}
+
+void Visualizer::state(const State& s, double f, double g, double h, Visualizer::Tag tag, Visualizer::Kind kind,
+                       uint64_t id) {
+    RecordBuilder<c_MaxRecordSize> record;
+    record << Record::State << tag << kind << s.x() << s.y() << s.heading() << s.speed() << s.time() << f << g << h
+           << id;
+    push(record.Data, record.Size);
+}
+
+void Visualizer::trajectory() {
+    auto type = Record::Trajectory;
+    push(reinterpret_cast<const char*>(&type), sizeof(type));
+}
+
+void Visualizer::incumbent(double f) {
+    RecordBuilder<c_MaxRecordSize> record;
+    record << Record::Incumbent << f;
+    push(record.Data, record.Size);
+}
+
+void Visualizer::ribbons(const RibbonManager& ribbonManager) {
+    for (const auto& r : ribbonManager.get()) {
+        RecordBuilder<c_MaxRecordSize> record;
+        record << Record::Ribbon << r.start().first << r.start().second << r.end().first << r.end().second;
+        push(record.Data, record.Size);
+    }
+}
+
+unsigned long Visualizer::dropped() const {
+    return m_TotalDropped;
+}
+
+void Visualizer::push(const char* record, size_t size) {
+    RecordBuilder<c_MaxRecordSize> dropped;
+    if (m_PendingDropped) dropped << Record::Dropped << m_PendingDropped;
+    auto head = m_Head.load(std::memory_order_relaxed);
+    auto tail = m_Tail.load(std::memory_order_acquire);
+    if (c_Capacity - (head - tail) < size + dropped.Size) {
+        m_PendingDropped++;
+        m_TotalDropped++;
+        return;
+    }
+    m_PendingDropped = 0;
+    for (auto chunk : {std::make_pair((const char*)dropped.Data, dropped.Size), std::make_pair(record, size)}) {
+        // copy in up to two pieces in case we wrap around the end
+        auto offset = head & (c_Capacity - 1);
+        auto first = std::min(chunk.second, c_Capacity - offset);
+        memcpy(m_Buffer.data() + offset, chunk.first, first);
+        memcpy(m_Buffer.data(), chunk.first + first, chunk.second - first);
+        head += chunk.second;
+    }
+    m_Head.store(head, std::memory_order_release);
+}
+
+void Visualizer::drain() {
+    auto tail = m_Tail.load(std::memory_order_relaxed);
+    auto head = m_Head.load(std::memory_order_acquire);
+    while (tail < head) {
+        auto offset = tail & (c_Capacity - 1);
+        auto chunk = std::min((size_t)(head - tail), c_Capacity - offset);
+        m_Stream.write(m_Buffer.data() + offset, chunk);
+        tail += chunk;
+    }
+    m_Tail.store(tail, std::memory_order_release);
+}
+
+void Visualizer::run() {
+    while (m_Running) {
+        drain();
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    drain();
+    m_Stream.flush();
+}
@@ -2,24 +2,127 @@
 #define SRC_VISUALIZER_H
 
 #include <fstream>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <alex_path_planner_common/State.h>
+
+class RibbonManager;
 
 /**
  * Encapsulate IO for visualization.
+ *
+ * Records are written in a compact binary format (decoded by visualizer.py) into a ring buffer, and a background
+ * thread drains the buffer to the file, so the planner never waits on formatting or disk. There's a single writer (the
+ * planning thread) so the buffer doesn't need locks. If the writer gets too far ahead whole records are dropped, and a
+ * record saying how many were dropped is written as soon as there's room again.
+ *
+ * The file starts with the magic bytes "ALXV" and a uint32 format version. Every record starts with a uint8 type, and
+ * everything is little-endian.
  */
 class Visualizer {
 public:
     typedef std::shared_ptr<Visualizer> SharedPtr;
     typedef std::unique_ptr<Visualizer> UniquePtr;
-    explicit Visualizer(const std::string& path) {
-        m_Stream.open(path, std::ios::trunc | std::ios::out);
-    }
 
-    std::ofstream& stream() {
-        return m_Stream;
-    }
+    /**
+     * What a state record represents. The order matters to the decoder.
+     */
+    enum class Tag : uint8_t {
+        Start, Vertex, LastPlanEnd, Goal, Trajectory, Sample, Plan,
+    };
+
+    /**
+     * Whether a vertex was just generated or is being expanded (or neither, for things that aren't vertices).
+     */
+    enum class Kind : uint8_t {
+        None, Generated, Expanded,
+    };
+
+    /**
+     * Record types. The order matters to the decoder.
+     */
+    enum class Record : uint8_t {
+        State = 1, Trajectory, Incumbent, Ribbon, Dropped,
+    };
+
+    static constexpr uint32_t c_FormatVersion = 1;
+
+    explicit Visualizer(const std::string& path);
+
+    /**
+     * Stops the background thread after it has written everything out.
+     */
+    ~Visualizer();
+
+    /**
+     * Write a state with its costs.
+     * @param s
+     * @param f
+     * @param g
+     * @param h
+     * @param tag
+     * @param kind
+     * @param id something to tell vertices apart by (their address)
+     */
+    void state(const State& s, double f, double g, double h, Tag tag, Kind kind = Kind::None, uint64_t id = 0);
+
+    /**
+     * Mark the start of a trajectory. The trajectory states follow, then the vertex it leads to.
+     */
+    void trajectory();
+
+    /**
+     * Write the f-value of the best plan found so far.
+     * @param f
+     */
+    void incumbent(double f);
+
+    /**
+     * Write all the ribbons in the ribbon manager.
+     * @param ribbonManager
+     */
+    void ribbons(const RibbonManager& ribbonManager);
+
+    /**
+     * @return the number of records dropped because the buffer was full
+     */
+    unsigned long dropped() const;
 
 private:
     std::ofstream m_Stream;
+
+    // ring buffer. Positions only ever increase and are taken modulo the capacity
+    std::vector<char> m_Buffer;
+    std::atomic<uint64_t> m_Head{0}, m_Tail{0};
+    // records dropped since the last dropped record was written, and in total
+    uint64_t m_PendingDropped = 0;
+    std::atomic<uint64_t> m_TotalDropped{0};
+
+    std::atomic<bool> m_Running{true};
+    std::thread m_Writer;
+
+    static constexpr size_t c_Capacity = 1 << 22;
+    static constexpr size_t c_MaxRecordSize = 128;
+
+    /**
+     * Copy a record into the ring buffer, or drop it if there isn't room.
+     * @param record
+     * @param size
+     */
+    void push(const char* record, size_t size);
+
+    /**
+     * Write whatever is in the ring buffer to the file.
+     */
+    void drain();
+
+    /**
+     * Background thread body.
+     */
+    void run();
 };
 
 
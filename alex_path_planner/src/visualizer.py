@@ -5,6 +5,7 @@ import pygame
 from pygame.locals import *
 import sys
 import math
+import struct
 import numpy as np
 
 Color_line = (0, 0, 0)
@@ -483,12 +484,17 @@ class Visualizer:
                        y / float(self.maxY))
 
     def load(self, file_name):
-        with open(file_name, "r") as input_file:
-            input_lines = input_file.readlines()
+        with open(file_name, "rb") as input_file:
+            contents = input_file.read()
         pygame.display.set_caption('Visualizing ' + file_name)
         self.iterations = []
         self.iteration_index = 0
 
+        if contents[:4] == BINARY_MAGIC:
+            self.load_binary(contents)
+            return
+        input_lines = contents.decode("utf-8").splitlines(True)
+
         # Ribbons need special treatment because they look different than vertices
         adding_ribbons = False
 
@@ -546,6 +552,88 @@ class Visualizer:
                     self.iterations[-1].append(DisplayItem(pointer, x, y, h, cost + heuristic, tag, expanded))
 
 
+    def load_binary(self, contents):
+        for record in decode_binary(contents):
+            if record[0] == "trajectory":
+                if len(self.iterations) != 0:  # make sure there's been a start already
+                    self.iterations[-1].append(DisplayItem(0, 0, 0, 0, 0, "dummy", None))  # append a dummy item to be replaced
+            elif record[0] == "incumbent":
+                if len(self.iterations) != 0:
+                    self.iterations[-1].append(DisplayItem(0, 0, 0, 0, record[1], "incumbent f", None))
+            elif record[0] == "ribbon":
+                if len(self.iterations) != 0:
+                    self.iterations[-1].ribbons.append(list(record[1:]))
+            elif record[0] == "dropped":
+                print ("Planner dropped " + str(record[1]) + " visualization records here")
+            else:
+                tag, kind, x, y, h, speed, time, f, g, heuristic, pointer = record[1:]
+                if kind == "expanded":
+                    # for now, ignore expanded vertices
+                    continue
+                if tag == "start":
+                    self.iterations.append(Iteration(x, y, h))
+                elif len(self.iterations) != 0:
+                    if tag != "vertex" and tag != "lastplanend":
+                        pointer = 0
+                    self.iterations[-1].append(DisplayItem(pointer, x, y, h, g + heuristic, tag, False if kind == "generated" else None))
+
+
+# Binary visualization format, written by Visualizer.cpp: the magic bytes and a uint32 version, then records that each
+# start with a uint8 type. Everything is little-endian.
+BINARY_MAGIC = b"ALXV"
+BINARY_VERSION = 1
+BINARY_TAGS = ["start", "vertex", "lastplanend", "goal", "trajectory", "sample", "plan"]
+BINARY_KINDS = [None, "generated", "expanded"]
+STATE_RECORD = struct.Struct("<BB8dQ")  # tag, kind, x, y, heading, speed, time, f, g, h, id
+INCUMBENT_RECORD = struct.Struct("<d")
+RIBBON_RECORD = struct.Struct("<4d")
+DROPPED_RECORD = struct.Struct("<Q")
+
+
+def decode_binary(contents):
+    """
+    Decode a binary visualization file into tuples, one per record:
+    ("state", tag, kind, x, y, heading, speed, time, f, g, h, id), ("trajectory",), ("incumbent", f),
+    ("ribbon", x1, y1, x2, y2) or ("dropped", count).
+    """
+    if contents[:4] != BINARY_MAGIC:
+        raise ValueError("Not a binary visualization file")
+    version = struct.unpack_from("<I", contents, 4)[0]
+    if version != BINARY_VERSION:
+        raise ValueError("Unsupported visualization format version " + str(version))
+    records = []
+    offset = 8
+    while offset < len(contents):
+        record_type = struct.unpack_from("<B", contents, offset)[0]
+        offset += 1
+        if record_type == 1:
+            if offset + STATE_RECORD.size > len(contents):
+                break  # truncated, probably still being written
+            fields = STATE_RECORD.unpack_from(contents, offset)
+            offset += STATE_RECORD.size
+            records.append(("state", BINARY_TAGS[fields[0]], BINARY_KINDS[fields[1]]) + fields[2:])
+        elif record_type == 2:
+            records.append(("trajectory",))
+        elif record_type == 3:
+            if offset + INCUMBENT_RECORD.size > len(contents):
+                break
+            records.append(("incumbent",) + INCUMBENT_RECORD.unpack_from(contents, offset))
+            offset += INCUMBENT_RECORD.size
+        elif record_type == 4:
+            if offset + RIBBON_RECORD.size > len(contents):
+                break
+            records.append(("ribbon",) + RIBBON_RECORD.unpack_from(contents, offset))
+            offset += RIBBON_RECORD.size
+        elif record_type == 5:
+            if offset + DROPPED_RECORD.size > len(contents):
+                break
+            records.append(("dropped",) + DROPPED_RECORD.unpack_from(contents, offset))
+            offset += DROPPED_RECORD.size
+        else:
+            raise ValueError("Unknown visualization record type " + str(record_type) + " at byte " + str(offset - 1))
+    return records
+
+
 def dist(x, x1, y, y1):
     return (x - x1) ** 2 + (y - y1) ** 2
 
@@ -6,11 +6,22 @@
 #include "../../src/planner/search/Edge.h"
 #include "../../src/planner/SamplingBasedPlanner.h"
 #include "../../src/planner/AStarPlanner.h"
+#include "../../src/planner/LatticePlanner.h"
+#include "../../src/planner/FleetPlanner.h"
+#include "../../src/planner/ContingencyPlanner.h"
+#include "../../src/planner/utilities/ConnectionCache.h"
+#include "../../src/planner/utilities/Roadmap.h"
+#include "../../src/planner/utilities/SampleSet.h"
 #include "../../src/common/map/GeoTiffMap.h"
 #include "../../src/common/map/GridWorldMap.h"
+#include "../../src/common/map/MapCache.h"
+#include "../../src/common/map/DistanceField.h"
 #include "../../src/common/dynamic_obstacles/BinaryDynamicObstaclesManager.h"
 #include "../../src/common/dynamic_obstacles/GaussianDynamicObstaclesManager.h"
+#include "../../src/common/dynamic_obstacles/FleetObstaclesManager.h"
+#include <random>
 #include <thread>
+#include <unistd.h>
 #include <alex_path_planner_common/Plan.h>
 
 using std::vector;
@@ -85,6 +96,37 @@ static alex_path_planner_common::Plan getPlanMsg(const DubinsPlan& plan) {
     return planMsg;
 }
 
+/**
+ * Write a grid world map file. Unless a path is given it goes in a new temporary file, so tests running at the same
+ * time can't clobber each other's maps.
+ * @param resolution size (m) of each cell
+ * @param rows cells from the top of the map down, with '#' for blocked
+ * @param path file to write over, if any
+ * @return path to the file
+ */
+static std::string writeMap(double resolution, const vector<std::string>& rows, std::string path = "") {
+    if (path.empty()) {
+        char name[] = "/tmp/test_planner_XXXXXX.map";
+        auto fd = mkstemps(name, 4);
+        if (fd == -1) throw std::runtime_error("Couldn't make a temporary map file");
+        close(fd);
+        path = name;
+    }
+    std::ofstream out(path);
+    out << resolution << "\n";
+    for (const auto& row : rows) out << row << "\n";
+    return path;
+}
+
+/**
+ * @return a 100m square map with a wall between y = 20 and 30 on the right half
+ */
+static std::string writeWallMap() {
+    vector<std::string> rows(10, "__________");
+    rows[7] = "_____#####";
+    return writeMap(10, rows);
+}
+
 TEST(UnitTests, PlanTransferTest1) {
     RibbonManager ribbonManager;
     ribbonManager.add(0, 20, 20, 20);
@@ -199,6 +241,32 @@ TEST(UnitTests, DynamicObstacleTest1) {
     EXPECT_NEAR(p1, p, 0.00001);
 }
 
+TEST(UnitTests, DynamicObstacleTrackTest) {
+    // uneven spacing, a turn, and a size change, checked against interpolating the distributions directly
+    double sigma[2][2] = {{1, 0}, {0, 1}};
+    double times[] = {2, 2.5, 4, 7, 7.1, 12};
+    std::vector<Distribution> distributions;
+    for (int i = 0; i < 6; i++) {
+        double mean[2] = {3.0 * i, 10 - 2.0 * i * i};
+        distributions.emplace_back(mean, sigma, 5 + i, 10, i * M_PI / 7, times[i]);
+    }
+    DynamicObstacle obstacle(distributions, 10, 5);
+    std::default_random_engine randomEngine(11);
+    std::uniform_real_distribution<> timeDistribution(0, 14), positionDistribution(-20, 20);
+    for (int k = 0; k < 10000; k++) {
+        auto t = timeDistribution(randomEngine);
+        auto x = positionDistribution(randomEngine), y = positionDistribution(randomEngine) - 10;
+        int lower = 0;
+        while (lower < 4 && times[lower + 1] <= t) lower++;
+        auto expected = distributions[lower].interpolate(distributions[lower + 1], t).density(x, y);
+        ASSERT_DOUBLE_EQ(expected, obstacle.collisionDensityAt(x, y, t)) << "at " << x << ", " << y << ", " << t;
+    }
+    // a lone distribution can only be queried at its own time
+    DynamicObstacle single({distributions[0]});
+    EXPECT_DOUBLE_EQ(single.collisionDensityAt(0, 10, 2), 1);
+    EXPECT_THROW(single.collisionDensityAt(0, 10, 3), std::logic_error);
+}
+
 TEST(UnitTests, BinaryDynamicObstaclesTest1) {
     BinaryDynamicObstaclesManager manager;
     manager.update(1, 42, 42, 0, 1, 1, 5, 15);
@@ -237,6 +305,29 @@ TEST(UnitTests, GaussianDynamicObstacleTest1) {
     }
 }
 
+TEST(UnitTests, TimeToPossibleCollisionTest) {
+    GaussianDynamicObstaclesManager gaussian;
+    EXPECT_DOUBLE_EQ(gaussian.timeToPossibleCollision(0, 100, 1, 2.5), DBL_MAX);
+    // obstacle heading north at 2m/s, us heading south at it from 100m away
+    gaussian.update(1, 0, 0, 0, 2, 1);
+    auto t = gaussian.timeToPossibleCollision(0, 100, 1, 2.5);
+    EXPECT_GT(t, 0);
+    EXPECT_LT(t, 100 / 4.5);
+    for (double dt = 0; dt < t; dt += 0.1) {
+        EXPECT_DOUBLE_EQ(gaussian.collisionExists(0, 100 - 2.5 * dt, 1 + dt, true), 0);
+    }
+    EXPECT_DOUBLE_EQ(gaussian.timeToPossibleCollision(0, 0, 1, 2.5), 0);
+
+    BinaryDynamicObstaclesManager binary;
+    binary.update(1, 0, 0, 0, 2, 1, 10, 30);
+    t = binary.timeToPossibleCollision(0, 100, 1, 2.5);
+    EXPECT_GT(t, 0);
+    for (double dt = 0; dt < t; dt += 0.1) {
+        EXPECT_DOUBLE_EQ(binary.collisionExists(0, 100 - 2.5 * dt, 1 + dt, true), 0);
+    }
+    EXPECT_GT(binary.collisionExists(0, 100 - 2.5 * 100 / 4.5, 1 + 100 / 4.5, true), 0);
+}
+
 TEST(UnitTests, GeoTiffMapTest1) {
     GeoTiffMap map("../../../src/mbes_sim/data/US5NH02M.tiff", -70.71054174878898, 43.073397415457535);
 }
@@ -270,6 +361,37 @@ TEST(UnitTests, GridWorldMapTest1) {
     EXPECT_FALSE(map.isBlocked(495, 450));
 }
 
+TEST(UnitTests, MapCacheTest) {
+    auto path1 = writeMap(10, vector<std::string>(10, std::string(30, '_')));
+    auto path2 = writeMap(10, vector<std::string>(20, std::string(30, '_')));
+    int loads = 0;
+    auto loader = [&] (const std::string& path) {
+        return [&loads, path] { loads++; return std::make_shared<GridWorldMap>(path); };
+    };
+    auto one = GridWorldMap(path1).memoryUsage();
+    // room for the first map and a bit, but not both
+    MapCache cache(one + one / 2);
+    auto map1 = cache.get(path1, 0, 0, loader(path1));
+    EXPECT_EQ(map1, cache.get(path1, 0, 0, loader(path1)));
+    EXPECT_EQ(loads, 1);
+    EXPECT_EQ(cache.size(), one);
+    // a different origin is a different map
+    cache.get(path1, 1, 2, loader(path1));
+    EXPECT_EQ(loads, 2);
+    EXPECT_EQ(cache.count(), 1);
+    // the second one is too big to keep anything else around
+    auto map2 = cache.get(path2, 0, 0, loader(path2));
+    EXPECT_EQ(loads, 3);
+    EXPECT_EQ(cache.count(), 1);
+    EXPECT_NE(map1, cache.get(path1, 0, 0, loader(path1)));
+    EXPECT_EQ(loads, 4);
+    // changing the file means loading it again
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    writeMap(10, vector<std::string>(10, std::string(30, '_')), path1);
+    cache.get(path1, 0, 0, loader(path1));
+    EXPECT_EQ(loads, 5);
+}
+
 TEST(UnitTests, PepperrellCoveTest) {
     GridWorldMap map("../../../src/test_scenario_runner/scenarios/pepperrell_cove_6.map");
     EXPECT_FALSE(map.isBlocked(593, 592.76));
@@ -303,12 +425,12 @@ void visualizePath(const State& s1, const State& s2, const State& s3, double tur
     auto v2 = Vertex::connect(v1, s2);
     auto v3 = Vertex::makeRoot(s3, ribbonManager);
     auto v4 = Vertex::connect(v3, s2);
-    visualizer->stream() << v1->toString() << " start" << endl;
+    visualizer->state(v1->state(), v1->f(), v1->currentCost(), v1->approxToGo(), Visualizer::Tag::Start);
     v2->parentEdge()->computeTrueCost(config);
-    visualizer->stream() << v2->toString() << " vertex" << endl;
-    visualizer->stream() << v3->toString() << " vertex" << endl;
+    visualizer->state(v2->state(), v2->f(), v2->currentCost(), v2->approxToGo(), Visualizer::Tag::Vertex);
+    visualizer->state(v3->state(), v3->f(), v3->currentCost(), v3->approxToGo(), Visualizer::Tag::Vertex);
     v4->parentEdge()->computeTrueCost(config);
-    visualizer->stream() << v4->toString() << " vertex" << endl;
+    visualizer->state(v4->state(), v4->f(), v4->currentCost(), v4->approxToGo(), Visualizer::Tag::Vertex);
 }
 
 void visualizePath(const State& s1, const State& s2, double turningRadius) {
@@ -332,12 +454,12 @@ void visualizePath(const State& s1, const State& s2, double turningRadius) {
     auto v2 = Vertex::connect(v1, s2);
 //    auto v3 = Vertex::makeRoot(s3, ribbonManager);
 //    auto v4 = Vertex::connect(v3, s2);
-    visualizer->stream() << v1->toString() << " start" << endl;
+    visualizer->state(v1->state(), v1->f(), v1->currentCost(), v1->approxToGo(), Visualizer::Tag::Start);
     v2->parentEdge()->computeTrueCost(config);
-    visualizer->stream() << v2->toString() << " vertex" << endl;
-//    visualizer->stream() << v3->toString() << " vertex" << endl;
+    visualizer->state(v2->state(), v2->f(), v2->currentCost(), v2->approxToGo(), Visualizer::Tag::Vertex);
+//    visualizer->state(v3->state(), v3->f(), v3->currentCost(), v3->approxToGo(), Visualizer::Tag::Vertex);
 //    v4->parentEdge()->computeTrueCost(config);
-//    visualizer->stream() << v4->toString() << " vertex" << endl;
+//    visualizer->state(v4->state(), v4->f(), v4->currentCost(), v4->approxToGo(), Visualizer::Tag::Vertex);
 }
 
 TEST(UnitTests, DubinsSuffixTest) {
@@ -741,6 +863,80 @@ TEST(UnitTests, RibbonManagerCoverBetweenTest) {
     ribbonManager.coverBetween(134.778, 62.1946, 133.708, 61.8953, false);
 }
 
+TEST(UnitTests, RibbonManagerVersionTest) {
+    RibbonManager ribbonManager(RibbonManager::TspDubinsNoSplitAllRibbons, 8);
+    ribbonManager.add(0, 0, 0, 50);
+    ribbonManager.add(20, 0, 20, 50);
+    auto version = ribbonManager.version();
+    auto before = ribbonManager.approximateDistanceUntilDone(10, -10, 0);
+    // covering somewhere off the ribbons doesn't change them
+    auto copy = ribbonManager;
+    copy.cover(10, 25, true);
+    EXPECT_EQ(copy.version(), version);
+    EXPECT_DOUBLE_EQ(copy.approximateDistanceUntilDone(10, -10, 0), before);
+    // but covering a bit of one does, even if another copy changes the same way
+    auto other = ribbonManager;
+    copy.cover(0, 25, true);
+    other.cover(0, 25, true);
+    EXPECT_NE(copy.version(), version);
+    EXPECT_NE(copy.version(), other.version());
+    EXPECT_GT(copy.approximateDistanceUntilDone(10, -10, 0), 0);
+    EXPECT_DOUBLE_EQ(copy.approximateDistanceUntilDone(10, -10, 0), other.approximateDistanceUntilDone(10, -10, 0));
+    // the original's still the same
+    EXPECT_EQ(ribbonManager.version(), version);
+    EXPECT_DOUBLE_EQ(ribbonManager.approximateDistanceUntilDone(10, -10, 0), before);
+    // changing the heuristic keeps the version but not the value
+    ribbonManager.setHeuristic(RibbonManager::MaxDistance);
+    EXPECT_EQ(ribbonManager.version(), version);
+    EXPECT_NE(ribbonManager.approximateDistanceUntilDone(10, -10, 0), before);
+}
+
+TEST(UnitTests, RibbonTourTest) {
+    auto never = [] { return false; };
+    auto always = [] { return true; };
+    // nearest neighbour goes right, right again and then all the way back left
+    RibbonManager inLine;
+    inLine.add(5, 0, 15, 0);
+    inLine.add(-30, 0, -20, 0);
+    inLine.add(40, 0, 50, 0);
+    State origin(0, 0, 0, 0, 0);
+    auto nearest = RibbonTour::plan(inLine.get(), origin, 0, never);
+    EXPECT_NEAR(nearest->cost(), 5 + 25 + 70, 1e-9);
+    // better to do the left one (backwards) first
+    auto tour = RibbonTour::plan(inLine.get(), origin, 0, always);
+    EXPECT_NEAR(tour->cost(), 20 + 35 + 25, 1e-9);
+    EXPECT_EQ(tour->legs().front().RibbonId, inLine.get().begin()->id() + 1);
+    EXPECT_FALSE(tour->legs().front().Forward);
+
+    RibbonManager ribbonManager(RibbonManager::TourGuided);
+    // parallel lines 20m apart, added out of order
+    for (auto y : {0, 60, 20, 80, 40}) ribbonManager.add(0, y, 100, y);
+    State start(-10, 40, 0, 0, 0);
+    tour = RibbonTour::plan(ribbonManager.get(), start, 0, always);
+    ASSERT_EQ(tour->legs().size(), 5);
+    // back and forth
+    for (size_t i = 1; i < tour->legs().size(); i++)
+        EXPECT_NE(tour->legs()[i].Forward, tour->legs()[i - 1].Forward);
+    ribbonManager.setTour(tour);
+    State entry;
+    ASSERT_TRUE(ribbonManager.nextTourEntry(entry));
+    EXPECT_DOUBLE_EQ(entry.x(), tour->legs().front().Forward? 0 : 100);
+    auto expected = tour->cost() + 5 * (100 - 2 * Ribbon::RibbonWidth);
+    EXPECT_NEAR(ribbonManager.approximateDistanceUntilDone(start.x(), start.y(), 0), expected, 1e-6);
+    // covering the middle of a line splits it, but the pieces are still spanned end to end
+    ribbonManager.cover(50, 40, false);
+    EXPECT_EQ(ribbonManager.get().size(), 6);
+    EXPECT_NEAR(ribbonManager.approximateDistanceUntilDone(start.x(), start.y(), 0), expected, 1e-6);
+    // the tour doesn't know about new ribbons, so fall back to max distance
+    ribbonManager.add(0, 100, 100, 100);
+    auto tourDistance = tour->distanceUntilDone(ribbonManager.get(), start.x(), start.y());
+    EXPECT_EQ(tourDistance, -1);
+    // but another tour starting from this one does
+    tour = RibbonTour::plan(ribbonManager.get(), start, 8, always, tour);
+    EXPECT_EQ(tour->legs().size(), 6);
+    EXPECT_GE(tour->distanceUntilDone(ribbonManager.get(), start.x(), start.y()), 0);
+}
+
 TEST(Benchmarks, RibbonsTSPBenhcmark) {
     auto overallStart = std::chrono::system_clock::now();
     StateGenerator generator(-5000, -5000, 5000, 5000, 0, 0, 19);
@@ -1119,6 +1315,639 @@ TEST(UnitTests, DifferentSpeedsCoverageTest) {
     EXPECT_LT(v1->f(), v2->f());
 }
 
+TEST(UnitTests, SharedGeometryTest) {
+    State start(0, 0, 0, plannerConfig.maxSpeed(), 1);
+    RibbonManager ribbonManager;
+    ribbonManager.add(0, 0, 0, 50);
+    plannerConfig.setMap(make_shared<Map>());
+    auto root = Vertex::makeRoot(start, ribbonManager);
+    root->computeApproxToGo(plannerConfig);
+    plannerConfig.setStartStateTime(start.time());
+    DubinsWrapper wrapper(start, State(0, 60, 0, plannerConfig.maxSpeed(), 0), plannerConfig.turningRadius());
+    auto templateVertex = Vertex::connect(root, wrapper, false);
+    for (const auto& speed : {plannerConfig.maxSpeed(), plannerConfig.slowSpeed()}) {
+        wrapper.setSpeed(speed);
+        auto independent = Vertex::connect(root, wrapper, false);
+        independent->parentEdge()->computeTrueCost(plannerConfig);
+        auto shared = Vertex::connect(root, wrapper, false);
+        templateVertex->parentEdge()->shareGeometry(*shared->parentEdge());
+        shared->parentEdge()->computeTrueCost(plannerConfig);
+        // edges sharing the walk along the curve should come out the same as if they'd done it themselves
+        EXPECT_DOUBLE_EQ(independent->currentCost(), shared->currentCost());
+        EXPECT_DOUBLE_EQ(independent->state().time(), shared->state().time());
+        EXPECT_EQ(independent->ribbonManager().done(), shared->ribbonManager().done());
+        EXPECT_DOUBLE_EQ(independent->approxToGo(), shared->approxToGo());
+    }
+}
+
+TEST(UnitTests, CollisionCacheTest) {
+    PlannerConfig config(&std::cerr);
+    config.setMap(make_shared<Map>());
+    auto obstacles = make_shared<GaussianDynamicObstaclesManager>();
+    obstacles->update(1, 0, 20, 0, 0, 1);
+    config.setObstaclesManager(obstacles);
+    config.setStartStateTime(1);
+    auto cache = make_shared<CollisionCache>();
+    State start(0, 0, 0, config.maxSpeed(), 1);
+    RibbonManager ribbonManager;
+    ribbonManager.add(50, 0, 50, 10);
+    auto root = Vertex::makeRoot(start, ribbonManager);
+    root->computeApproxToGo(config);
+    DubinsWrapper segment(start, State(0, 40, 0, config.maxSpeed(), 0), config.turningRadius());
+    auto v1 = Vertex::connect(root, segment, false);
+    v1->parentEdge()->useCollisionCache(cache->get(segment));
+    auto cost = v1->parentEdge()->computeTrueCost(config);
+    EXPECT_TRUE(cache->get(segment)->HasStatic);
+    EXPECT_TRUE(cache->get(segment)->HasDynamic);
+    EXPECT_GT(v1->parentEdge()->getSavedCollisionPenalty(), 0);
+    // nothing changed, so this should come straight out of the cache
+    auto v2 = Vertex::connect(root, segment, false);
+    v2->parentEdge()->useCollisionCache(cache->get(segment));
+    EXPECT_DOUBLE_EQ(cost, v2->parentEdge()->computeTrueCost(config));
+    // moving the obstacle out of the way should make us check again
+    obstacles->update(1, 1000, 1000, 0, 0, 1);
+    auto v3 = Vertex::connect(root, segment, false);
+    v3->parentEdge()->useCollisionCache(cache->get(segment));
+    v3->parentEdge()->computeTrueCost(config);
+    EXPECT_DOUBLE_EQ(v3->parentEdge()->getSavedCollisionPenalty(), 0);
+    EXPECT_EQ(cache->size(), 1);
+    cache->retain(DubinsPlan());
+    EXPECT_EQ(cache->size(), 0);
+}
+
+TEST(UnitTests, CollisionCacheSameStartTest) {
+    // land beyond y = 50
+    struct Land : public Map { bool isBlocked(double x, double y) const override { return y > 50; } };
+    PlannerConfig config(&std::cerr);
+    config.setMap(make_shared<Land>());
+    config.setStartStateTime(1);
+    auto cache = make_shared<CollisionCache>();
+    State start(0, 0, 0, config.maxSpeed(), 1);
+    // the ribbon's well off to the side, so running aground ends the edge
+    RibbonManager ribbonManager;
+    ribbonManager.add(200, 10, 200, 30);
+    auto root = Vertex::makeRoot(start, ribbonManager);
+    root->computeApproxToGo(config);
+    // two curves from the same start with the same radius, speed and type, but one goes twice as far
+    DubinsWrapper clear(start, State(0, 40, 0, config.maxSpeed(), 0), config.turningRadius());
+    auto path = clear.unwrap();
+    path.param[1] *= 2;
+    DubinsWrapper aground;
+    aground.fill(path, config.maxSpeed(), start.time());
+    auto v1 = Vertex::connect(root, clear, false);
+    v1->parentEdge()->useCollisionCache(cache->get(clear));
+    v1->parentEdge()->computeTrueCost(config);
+    EXPECT_FALSE(v1->parentEdge()->infeasible());
+    // the second one mustn't be told it's clear by the first one's results
+    auto v2 = Vertex::connect(root, aground, false);
+    v2->parentEdge()->useCollisionCache(cache->get(aground));
+    v2->parentEdge()->computeTrueCost(config);
+    EXPECT_TRUE(v2->parentEdge()->infeasible());
+    EXPECT_EQ(cache->size(), 2);
+    DubinsPlan plan;
+    plan.append(clear);
+    cache->retain(plan);
+    EXPECT_EQ(cache->size(), 1);
+}
+
+TEST(UnitTests, IntegratedObstaclePenaltyTest) {
+    PlannerConfig config(&std::cerr);
+    config.setMap(make_shared<Map>());
+    auto obstacles = make_shared<GaussianDynamicObstaclesManager>();
+    obstacles->update(1, -10, 20, M_PI_2, 1, 1);
+    config.setObstaclesManager(obstacles);
+    config.setStartStateTime(1);
+    State start(0, 0, 0, config.maxSpeed(), 1);
+    RibbonManager ribbonManager;
+    ribbonManager.add(50, 0, 50, 10);
+    auto root = Vertex::makeRoot(start, ribbonManager);
+    root->computeApproxToGo(config);
+    // one straight edge and one with arcs
+    for (const auto& end : {State(0, 40, 0, config.maxSpeed(), 0), State(20, 30, M_PI_2, config.maxSpeed(), 0)}) {
+        config.setIntegrateObstaclePenalty(false);
+        auto sampled = Vertex::connect(root, end, config.turningRadius(), false);
+        sampled->parentEdge()->computeTrueCost(config);
+        config.setIntegrateObstaclePenalty(true);
+        auto integrated = Vertex::connect(root, end, config.turningRadius(), false);
+        integrated->parentEdge()->computeTrueCost(config);
+        auto expected = sampled->parentEdge()->getSavedCollisionPenalty();
+        EXPECT_GT(expected, 0);
+        EXPECT_NEAR(integrated->parentEdge()->getSavedCollisionPenalty(), expected, expected * 0.05);
+    }
+    // a box crossing the straight edge quickly, covering it for about a third of a second between quadrature points,
+    // still gets sampled
+    auto binary = make_shared<BinaryDynamicObstaclesManager>();
+    binary->update(1, 0, 20.75, M_PI_2, 20, 9.3, 2, 5);
+    config.setObstaclesManager(binary);
+    auto end = State(0, 40, 0, config.maxSpeed(), 0);
+    config.setIntegrateObstaclePenalty(false);
+    auto sampled = Vertex::connect(root, end, config.turningRadius(), false);
+    sampled->parentEdge()->computeTrueCost(config);
+    config.setIntegrateObstaclePenalty(true);
+    auto integrated = Vertex::connect(root, end, config.turningRadius(), false);
+    integrated->parentEdge()->computeTrueCost(config);
+    EXPECT_GT(sampled->parentEdge()->getSavedCollisionPenalty(), 0);
+    EXPECT_DOUBLE_EQ(integrated->parentEdge()->getSavedCollisionPenalty(),
+                     sampled->parentEdge()->getSavedCollisionPenalty());
+}
+
+TEST(UnitTests, SpecializedEdgeEvaluationTest) {
+    auto path = writeMap(10, vector<std::string>(10, "____#_________"));
+    // subclasses don't get a specialization, so these go through the virtual functions
+    struct SomeMap : public GridWorldMap { using GridWorldMap::GridWorldMap; };
+    struct SomeObstacles : public GaussianDynamicObstaclesManager {};
+    auto specialized = make_shared<GaussianDynamicObstaclesManager>();
+    auto general = make_shared<SomeObstacles>();
+    specialized->update(1, 15, 50, 0, 0, 1);
+    general->update(1, 15, 50, 0, 0, 1);
+    PlannerConfig config1(&std::cerr), config2(&std::cerr);
+    config1.setMap(make_shared<GridWorldMap>(path));
+    config1.setObstaclesManager(specialized);
+    config2.setMap(make_shared<SomeMap>(path));
+    config2.setObstaclesManager(general);
+    config1.setStartStateTime(1);
+    config2.setStartStateTime(1);
+    State start(15, 15, 0, config1.maxSpeed(), 1);
+    RibbonManager ribbonManager;
+    ribbonManager.add(20, 10, 20, 90);
+    auto root = Vertex::makeRoot(start, ribbonManager);
+    root->computeApproxToGo(config1);
+    // one past the obstacle and one through the wall
+    for (const auto& end : {State(15, 85, 0, config1.maxSpeed(), 0), State(85, 45, M_PI_2, config1.maxSpeed(), 0)}) {
+        auto v1 = Vertex::connect(root, end, config1.turningRadius(), false);
+        auto v2 = Vertex::connect(root, end, config2.turningRadius(), false);
+        EXPECT_DOUBLE_EQ(v1->parentEdge()->computeTrueCost(config1), v2->parentEdge()->computeTrueCost(config2));
+        EXPECT_EQ(v1->parentEdge()->infeasible(), v2->parentEdge()->infeasible());
+        EXPECT_DOUBLE_EQ(v1->parentEdge()->getSavedCollisionPenalty(), v2->parentEdge()->getSavedCollisionPenalty());
+        EXPECT_EQ(v1->ribbonManager().dumpRibbons(), v2->ribbonManager().dumpRibbons());
+    }
+    EXPECT_GE(config1.edgeEvaluator(), 0);
+    EXPECT_NE(config1.edgeEvaluator(), config2.edgeEvaluator());
+}
+
+TEST(UnitTests, StaticProbeTest) {
+    // land across the top of the map, between y = 80 and 90
+    vector<std::string> rows(10, "__________");
+    rows[1] = "##########";
+    PlannerConfig config(&std::cerr);
+    config.setMap(make_shared<GridWorldMap>(writeMap(10, rows)));
+    config.setStartStateTime(1);
+    State start(15, 5, 0, config.maxSpeed(), 1);
+    State end(15, 95, 0, config.maxSpeed(), 0);
+    // the ribbon's well off to the side, so running aground ends it
+    RibbonManager aside;
+    aside.add(200, 10, 200, 30);
+    auto root = Vertex::makeRoot(start, aside);
+    root->computeApproxToGo(config);
+    auto v = Vertex::connect(root, end, config.turningRadius(), false);
+    v->parentEdge()->computeTrueCost(config);
+    EXPECT_TRUE(v->parentEdge()->infeasible());
+    // but finishing the ribbon on the way ends the edge before it gets there
+    RibbonManager along;
+    along.add(15, 10, 15, 30);
+    root = Vertex::makeRoot(start, along);
+    root->computeApproxToGo(config);
+    v = Vertex::connect(root, end, config.turningRadius(), false);
+    v->parentEdge()->computeTrueCost(config);
+    EXPECT_FALSE(v->parentEdge()->infeasible());
+    EXPECT_TRUE(v->ribbonManager().done());
+    EXPECT_LT(v->state().y(), 80);
+}
+
+TEST(UnitTests, DubinsSamplerTest) {
+    // a spread of ends so we get straights and arcs both ways
+    std::vector<State> ends{State(40, 10, 0, 2.5, 0), State(-30, 5, M_PI, 2.5, 0), State(3, 4, 1, 2.5, 0),
+                            State(20, -20, 4, 2.5, 0), State(-5, 0, 2, 2.5, 0)};
+    State start(0, 0, 0.3, 2.5, 0);
+    for (const auto& end : ends) {
+        DubinsWrapper path(start, end, 8);
+        DubinsWrapper::Sampler sampler(path, 0.25, 0.5);
+        State expected, actual;
+        for (unsigned long i = 0; sampler.distance(i) < path.length(); i++) {
+            // jump ahead partway through
+            auto j = i < 20? i : i + 7;
+            if (sampler.distance(j) >= path.length()) break;
+            path.sampleDistance(sampler.distance(j), expected);
+            sampler.sample(j, actual);
+            EXPECT_NEAR(expected.x(), actual.x(), 1e-9);
+            EXPECT_NEAR(expected.y(), actual.y(), 1e-9);
+            EXPECT_NEAR(expected.heading(), actual.heading(), 1e-9);
+            if (i >= 20) i += 7;
+        }
+    }
+}
+
+TEST(UnitTests, VisualizerTest) {
+    auto path = "/tmp/visualizer_test.bin";
+    {
+        Visualizer visualizer(path);
+        visualizer.state(State(1, 2, 3, 4, 5), 6, 7, 8, Visualizer::Tag::Start);
+        visualizer.trajectory();
+        visualizer.incumbent(9);
+        RibbonManager ribbonManager;
+        ribbonManager.add(0, 0, 10, 0);
+        visualizer.ribbons(ribbonManager);
+        EXPECT_EQ(visualizer.dropped(), 0);
+    }
+    std::ifstream in(path, std::ios::binary);
+    std::string contents((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    // header, state, trajectory, incumbent, ribbon
+    ASSERT_EQ(contents.size(), 8 + 75 + 1 + 9 + 33);
+    EXPECT_EQ(contents.substr(0, 4), "ALXV");
+    EXPECT_EQ(contents[8], (char)Visualizer::Record::State);
+    double x;
+    memcpy(&x, contents.data() + 11, sizeof(x));
+    EXPECT_DOUBLE_EQ(x, 1);
+    EXPECT_EQ(contents[8 + 75], (char)Visualizer::Record::Trajectory);
+    EXPECT_EQ(contents[8 + 75 + 1 + 9], (char)Visualizer::Record::Ribbon);
+}
+
+TEST(UnitTests, MotionPrimitivesTest) {
+    MotionPrimitives primitives;
+    auto library = primitives.get(8, 4, 1, 0.1);
+    // asking again doesn't build another one
+    EXPECT_EQ(library, primitives.get(8, 4, 1, 0.1));
+    ASSERT_EQ(library->ByHeading.size(), MotionPrimitives::c_Headings);
+    for (int i = 0; i < MotionPrimitives::c_Headings; i++) {
+        ASSERT_FALSE(library->ByHeading[i].empty());
+        for (const auto& p : library->ByHeading[i]) {
+            EXPECT_EQ(p->StartHeading, i);
+            // placing it somewhere else should give the same poses as sampling the curve there
+            auto wrapper = p->place(100.5, -20.25, 2.5, 0);
+            State end;
+            wrapper.sampleDistance(wrapper.length(), end);
+            EXPECT_NEAR(end.x(), 100.5 + p->DX * library->Spacing, 1e-6);
+            EXPECT_NEAR(end.y(), -20.25 + p->DY * library->Spacing, 1e-6);
+            State s;
+            for (int k = 0; k < p->Poses.size(); k += 7) {
+                wrapper.sampleDistance(k * library->Increment, s);
+                EXPECT_NEAR(s.x(), 100.5 + p->Poses[k].X, 1e-6);
+                EXPECT_NEAR(s.y(), -20.25 + p->Poses[k].Y, 1e-6);
+            }
+        }
+    }
+}
+
+TEST(PlannerTests, LatticePlannerTest) {
+    RibbonManager ribbonManager;
+    ribbonManager.add(0, 10, 0, 30);
+    PlannerConfig config(&std::cerr);
+    config.setNowFunction([] () -> double {
+        struct timespec t{};
+        clock_gettime(CLOCK_REALTIME, &t);
+        return t.tv_sec + t.tv_nsec * 1e-9;
+    });
+    config.setMap(make_shared<Map>());
+    config.setObstacles(DynamicObstaclesManager1());
+    config.setMaxSpeed(2.5);
+    config.setSlowSpeed(1.5);
+    config.setTurningRadius(8);
+    config.setCoverageTurningRadius(16);
+    config.setMotionPrimitives(make_shared<MotionPrimitives>());
+    LatticePlanner planner;
+    State start(0, 0, 0, 2.5, 1);
+    auto stats = planner.plan(ribbonManager, start, config, DubinsPlan(), 0.95, {});
+    EXPECT_FALSE(stats.Plan.empty());
+    EXPECT_GT(stats.Expanded, 0);
+    // again, now with the previous plan
+    State next;
+    next.time() = 2;
+    stats.Plan.sample(next);
+    auto plan = planner.plan(ribbonManager, next, config, stats.Plan, 0.95, {}).Plan;
+    EXPECT_FALSE(plan.empty());
+}
+
+TEST(PlannerTests, SearchMemoryLimitTest) {
+    RibbonManager ribbonManager(RibbonManager::Heuristic::TspPointRobotNoSplitKRibbons, 16, 2);
+    ribbonManager.add(0, 10, 0, 30);
+    ribbonManager.add(10, 30, 10, 10);
+    PlannerConfig config(&std::cerr);
+    config.setNowFunction([] () -> double {
+        struct timespec t{};
+        clock_gettime(CLOCK_REALTIME, &t);
+        return t.tv_sec + t.tv_nsec * 1e-9;
+    });
+    config.setMap(make_shared<Map>());
+    config.setObstacles(DynamicObstaclesManager1());
+    State start(0, 0, 0, 2.5, 1);
+    // records how long the open list is at each expansion (but the first of each iteration) once the search has had to
+    // drop vertices
+    struct WatchedPlanner : public AStarPlanner {
+        std::vector<size_t> QueueSizes;
+        void expand(const std::shared_ptr<Vertex>& sourceVertex, const DynamicObstaclesManager& obstacles) override {
+            if (m_Stats.Dropped > 0 && !sourceVertex->isRoot()) QueueSizes.push_back(vertexQueueSize());
+            AStarPlanner::expand(sourceVertex, obstacles);
+        }
+    };
+    WatchedPlanner planner;
+    auto stats = planner.plan(ribbonManager, start, config, DubinsPlan(), 0.5, {});
+    EXPECT_EQ(stats.Dropped, 0);
+    EXPECT_GT(stats.PeakVertices, 0);
+    EXPECT_GT(stats.PeakBytes, 0);
+    // with a limit far below that (room for about thirty vertices) it has to drop vertices but still comes up with
+    // something
+    config.setSearchMemoryLimit(stats.PeakBytes / stats.PeakVertices * 30);
+    stats = planner.plan(ribbonManager, start, config, DubinsPlan(), 0.5, {});
+    EXPECT_GT(stats.Dropped, 0);
+    EXPECT_FALSE(stats.Plan.empty());
+    // and it goes on searching with an open list rather than collapsing it to one vertex every time it sheds
+    ASSERT_FALSE(planner.QueueSizes.empty());
+    auto collapsed = std::count_if(planner.QueueSizes.begin(), planner.QueueSizes.end(), [](size_t size) {
+        return size <= 1;
+    });
+    EXPECT_LT(collapsed, planner.QueueSizes.size() / 10);
+}
+
+TEST(PlannerTests, ConnectionCacheTest) {
+    ConnectionCache cache;
+    DubinsWrapper wrapper(State(0, 0, 0, 2.5, 1), State(30, 30, M_PI_2, 2.5, 0), 8);
+    EXPECT_EQ(cache.find(1, 2, 8), nullptr);
+    auto added = cache.add(1, 2, 8, wrapper.unwrap());
+    ASSERT_NE(added, nullptr);
+    EXPECT_EQ(cache.find(1, 2, 8), added);
+    EXPECT_EQ(cache.find(2, 1, 8), nullptr);
+    EXPECT_EQ(cache.find(1, 2, 16), nullptr);
+
+    // a wall across the way
+    PlannerConfig config(&std::cerr);
+    config.setMap(make_shared<GridWorldMap>(writeWallMap()));
+    config.setStartStateTime(1);
+    // a short ribbon on the way, so the walk gets to the wall rather than the probe ruling the edge out first
+    RibbonManager ribbonManager;
+    ribbonManager.add(60, 10, 60, 15);
+    // the same curve from two vertices at the same place but different times: the second one takes the first's curve
+    // and static checks, and comes out the same apart from the time
+    State end(70, 50, 0, config.maxSpeed(), 0);
+    auto first = Vertex::connect(Vertex::makeRoot(State(60, 5, 0, config.maxSpeed(), 1), ribbonManager), end,
+                                 config.turningRadius(), false);
+    first->parentEdge()->computeApproxCost();
+    auto connection = cache.add(3, 4, config.turningRadius(), first->parentEdge()->getPlan(config).unwrap());
+    first->parentEdge()->useStaticCache(connection->Static);
+    first->parentEdge()->start()->computeApproxToGo(config);
+    first->parentEdge()->computeTrueCost(config);
+    EXPECT_TRUE(first->parentEdge()->infeasible());
+    EXPECT_TRUE(connection->Static->HasStatic);
+    auto second = Vertex::connect(Vertex::makeRoot(State(60, 5, 0, config.maxSpeed(), 2), ribbonManager), end,
+                                  config.turningRadius(), false);
+    second->parentEdge()->computeApproxCost(connection->Path);
+    EXPECT_DOUBLE_EQ(second->parentEdge()->approxCost(), first->parentEdge()->approxCost());
+    EXPECT_DOUBLE_EQ(second->parentEdge()->getPlan(config).getStartTime(), 2);
+    second->parentEdge()->useStaticCache(connection->Static);
+    second->parentEdge()->start()->computeApproxToGo(config);
+    second->parentEdge()->computeTrueCost(config);
+    EXPECT_TRUE(second->parentEdge()->infeasible());
+
+    // and the planner re-uses plenty of connections over a cycle
+    RibbonManager ribbons(RibbonManager::Heuristic::TspPointRobotNoSplitKRibbons, 16, 2);
+    ribbons.add(0, 10, 0, 30);
+    ribbons.add(10, 30, 10, 10);
+    PlannerConfig planConfig(&std::cerr);
+    planConfig.setNowFunction([] () -> double {
+        struct timespec t{};
+        clock_gettime(CLOCK_REALTIME, &t);
+        return t.tv_sec + t.tv_nsec * 1e-9;
+    });
+    planConfig.setMap(make_shared<Map>());
+    planConfig.setObstacles(DynamicObstaclesManager1());
+    AStarPlanner planner;
+    auto stats = planner.plan(ribbons, State(0, 0, 0, 2.5, 1), planConfig, DubinsPlan(), 0.5, {});
+    EXPECT_FALSE(stats.Plan.empty());
+    EXPECT_GT(stats.ReusedConnections, 0);
+}
+
+TEST(PlannerTests, RoadmapTest) {
+    // the wall is below the survey
+    auto path = writeWallMap();
+    auto map = make_shared<GridWorldMap>(path);
+    RibbonManager ribbons(RibbonManager::Heuristic::TspPointRobotNoSplitKRibbons, 16, 2);
+    ribbons.add(20, 40, 20, 70);
+    ribbons.add(40, 70, 40, 40);
+    PlannerConfig config(&std::cerr);
+    config.setNowFunction([] () -> double {
+        struct timespec t{};
+        clock_gettime(CLOCK_REALTIME, &t);
+        return t.tv_sec + t.tv_nsec * 1e-9;
+    });
+    config.setMap(map);
+    config.setFootprint(Footprint(4, 2));
+    config.setCollisionCheckingIncrement(0.5);
+    config.setObstacles(DynamicObstaclesManager1());
+    auto roadmap = Roadmap::build(map, ribbons, config.turningRadius(), config.coverageTurningRadius(),
+                                  config.footprint(), config.collisionCheckingIncrement(), 300);
+    ASSERT_NE(roadmap, nullptr);
+    EXPECT_FALSE(roadmap->nodes().empty());
+    EXPECT_GT(roadmap->size(), 0);
+    // every curve kept is shortest first and clear all the way, checked the long way
+    for (uint32_t i = 0; i < roadmap->nodes().size(); i++) {
+        for (int j = 0; j < 2; j++) {
+            double previous = 0;
+            for (const auto& connection : roadmap->connections(i, j)) {
+                EXPECT_GE(connection.Length, previous);
+                previous = connection.Length;
+                DubinsWrapper wrapper;
+                wrapper.fill(connection.Path, config.maxSpeed(), 0);
+                EXPECT_DOUBLE_EQ(wrapper.length(), connection.Length);
+                State s;
+                for (double d = 0; d < connection.Length; d += config.collisionCheckingIncrement()) {
+                    wrapper.sampleDistance(d, s);
+                    ASSERT_FALSE(config.footprint().blocked(*map, s.x(), s.y(), s.heading()));
+                }
+            }
+        }
+    }
+    // it's only good for the map, radii and footprint it was built with
+    EXPECT_TRUE(roadmap->suits(*map, config.turningRadius(), config.coverageTurningRadius(), config.footprint()));
+    EXPECT_FALSE(roadmap->suits(*map, config.turningRadius(), config.coverageTurningRadius(), Footprint()));
+    EXPECT_FALSE(roadmap->suits(*map, 4, config.coverageTurningRadius(), config.footprint()));
+    EXPECT_FALSE(roadmap->suits(GridWorldMap(path), config.turningRadius(),
+                                config.coverageTurningRadius(), config.footprint()));
+
+    // the planner searches it once instead of sampling
+    config.setRoadmap(roadmap);
+    AStarPlanner planner;
+    auto stats = planner.plan(ribbons, State(30, 35, 0, config.maxSpeed(), 1), config, DubinsPlan(), 0.5, {});
+    EXPECT_FALSE(stats.Plan.empty());
+    EXPECT_EQ(stats.Samples, roadmap->nodes().size());
+    EXPECT_EQ(stats.Iterations, 1);
+}
+
+TEST(UnitTests, SampleSetTest) {
+    SampleSet samples;
+    // far from the map origin, where floats alone wouldn't be good to a millimetre
+    EXPECT_EQ(samples.add(State(500000, 4000000, 1, 2.5, 10)), 0);
+    EXPECT_EQ(samples.add(State(500030, 4000040, 2, 2.5, 10)), 1);
+    EXPECT_EQ(samples.size(), 2);
+    auto s = samples.state(1);
+    EXPECT_NEAR(s.x(), 500030, 1e-3);
+    EXPECT_NEAR(s.y(), 4000040, 1e-3);
+    EXPECT_NEAR(s.heading(), 2, 1e-6);
+    // just a pose
+    EXPECT_EQ(s.speed(), 0);
+    EXPECT_EQ(s.time(), 0);
+    std::vector<float> distances;
+    samples.distancesSquared(500000, 4000000, distances);
+    ASSERT_EQ(distances.size(), 2);
+    EXPECT_NEAR(distances[0], 0, 1e-3);
+    EXPECT_NEAR(distances[1], 2500, 1e-2);
+    samples.clear();
+    EXPECT_TRUE(samples.empty());
+}
+
+TEST(UnitTests, FleetObstaclesManagerTest) {
+    DynamicObstaclesManager none;
+    // the other vessel heads east along y = 0 from t = 0
+    DubinsPlan plan(State(0, 0, M_PI_2, 2.5, 0), State(50, 0, M_PI_2, 2.5, 0), 8);
+    FleetObstaclesManager obstacles(none, {FleetObstaclesManager::Vessel(plan, 3, 6)});
+    EXPECT_GT(obstacles.collisionExists(25, 0, 10, false), 0);
+    EXPECT_EQ(obstacles.collisionExists(25, 0, 2, false), 0);
+    // it's a box, longer than it is wide
+    EXPECT_GT(obstacles.collisionExists(27, 0, 10, false), 0);
+    EXPECT_EQ(obstacles.collisionExists(25, 2, 10, false), 0);
+    // and it stays where its plan ends
+    EXPECT_GT(obstacles.collisionExists(50, 0, 100, false), 0);
+    // it can't get to the start of its plan any sooner than the bound says
+    auto t = obstacles.timeToPossibleCollision(-40, 0, 0, 2.5);
+    EXPECT_GT(t, 0);
+    EXPECT_EQ(obstacles.collisionExists(-40 + 2.5 * t, 0, t, true), 0);
+    EXPECT_NE(obstacles.version(), FleetObstaclesManager(none, {}).version());
+}
+
+TEST(UnitTests, DistanceFieldTest) {
+    const int width = 40, height = 30;
+    DistanceField field(width, height, 10);
+    // what it should be, worked out the slow way
+    std::vector<std::vector<bool>> occupied(height, std::vector<bool>(width, false));
+    auto check = [&] {
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                double nearest = INFINITY;
+                for (int oy = 0; oy < height; oy++) {
+                    for (int ox = 0; ox < width; ox++) {
+                        if (occupied[oy][ox]) nearest = fmin(nearest, sqrt((x - ox) * (x - ox) + (y - oy) * (y - oy)));
+                    }
+                }
+                ASSERT_EQ(field.occupied(x, y), occupied[y][x]);
+                auto distance = field.distance(x, y);
+                // it's always the distance to some obstacle, and the brushfire only ever misses the nearest by a bit
+                ASSERT_GE(distance, nearest - 1e-4);
+                if (nearest <= field.maxDistance() - 1) ASSERT_LE(distance, nearest + 1);
+            }
+        }
+    };
+    std::mt19937 random(1);
+    for (int round = 0; round < 20; round++) {
+        for (int i = 0; i < 15; i++) {
+            auto x = (int)(random() % width), y = (int)(random() % height);
+            // mostly adding, so there's a fair bit there to remove
+            bool occupy = random() % 3 != 0;
+            occupied[y][x] = occupy;
+            field.set(x, y, occupy);
+        }
+        if (round % 4 == 3) {
+            // roll the window
+            int dx = (int)(random() % 7) - 3, dy = (int)(random() % 7) - 3;
+            field.update();
+            field.shift(dx, dy);
+            std::vector<std::vector<bool>> shifted(height, std::vector<bool>(width, false));
+            for (int y = 0; y < height; y++) {
+                for (int x = 0; x < width; x++) {
+                    if (x + dx >= 0 && x + dx < width && y + dy >= 0 && y + dy < height) shifted[y][x] = occupied[y + dy][x + dx];
+                }
+            }
+            occupied = shifted;
+        }
+        field.update();
+        check();
+    }
+    // changes only touch the cells around them
+    auto visited = (field.set(20, 15, !field.occupied(20, 15)), field.update());
+    EXPECT_LT(visited, width * height);
+}
+
+TEST(UnitTests, ContingencyPlannerTest) {
+    PlannerConfig config(&std::cerr);
+    config.setMap(make_shared<Map>());
+    // heading north
+    State start(0, 0, 0, 2.5, 1);
+    for (const auto& candidate : ContingencyPlanner::candidates(start, config, 10)) {
+        State s(0, 0, 0, 0, 1);
+        candidate.sample(s);
+        EXPECT_TRUE(s.isCoLocated(start));
+        EXPECT_DOUBLE_EQ(s.speed(), config.slowSpeed());
+    }
+    // nothing around so carry on, slowly
+    auto plan = ContingencyPlanner::plan(start, config, 10);
+    ASSERT_FALSE(plan.empty());
+    State end(0, 0, 0, 0, 11);
+    plan.sample(end);
+    EXPECT_NEAR(end.x(), 0, 1e-6);
+    EXPECT_NEAR(end.y(), config.slowSpeed() * 10, 1e-6);
+    // someone coming straight at us from the north, so get out of the way
+    auto obstacles = make_shared<BinaryDynamicObstaclesManager>();
+    obstacles->update(1, 0, 40, M_PI, 1, 1, 5, 10);
+    config.setObstaclesManager(obstacles);
+    plan = ContingencyPlanner::plan(start, config, 30);
+    ASSERT_FALSE(plan.empty());
+    for (const auto& s : plan.getHalfSecondSamples()) {
+        if (s.time() <= 31) EXPECT_EQ(obstacles->collisionExists(s.x(), s.y(), s.time(), false), 0);
+    }
+    end.time() = 31;
+    plan.sample(end);
+    EXPECT_GT(fabs(end.x()), 5);
+    // nowhere to go
+    struct Blocked : public Map { bool isBlocked(double x, double y) const override { return true; } };
+    config.setMap(make_shared<Blocked>());
+    EXPECT_TRUE(ContingencyPlanner::plan(start, config, 10).empty());
+}
+
+TEST(PlannerTests, FleetPlannerTest) {
+    PlannerConfig config(&std::cerr);
+    config.setNowFunction([] () -> double {
+        struct timespec t{};
+        clock_gettime(CLOCK_REALTIME, &t);
+        return t.tv_sec + t.tv_nsec * 1e-9;
+    });
+    config.setMap(make_shared<Map>());
+    config.setCollisionCache(make_shared<CollisionCache>());
+    // two vessels splitting a survey, and a third that's just passing through, more vessels than threads
+    std::vector<FleetPlanner::Vessel> vessels(3);
+    vessels[0].Start = State(0, 0, 0, 2.5, 1);
+    vessels[0].Ribbons.add(0, 10, 0, 40);
+    vessels[1].Start = State(40, 0, 0, 2.5, 1);
+    vessels[1].Ribbons.add(40, 10, 40, 40);
+    vessels[2].Start = State(20, -20, 0, 2.5, 1);
+    vessels[2].Ribbons.add(20, -10, 20, 60);
+    // remember the time each search is given, so we can tell the batch fits in the time without timing it
+    struct TimedPlanner : public AStarPlanner {
+        std::mutex& Mutex;
+        std::vector<double>& Times;
+        TimedPlanner(std::mutex& mutex, std::vector<double>& times) : Mutex(mutex), Times(times) {}
+        Stats plan(const RibbonManager& ribbonManager, const State& start, PlannerConfig config,
+                   const DubinsPlan& previousPlan, double timeRemaining,
+                   std::unordered_map<uint32_t, GaussianDynamicObstaclesManager::Obstacle> obstacles) override {
+            {
+                std::lock_guard<std::mutex> lock(Mutex);
+                Times.push_back(timeRemaining);
+            }
+            return AStarPlanner::plan(ribbonManager, start, config, previousPlan, timeRemaining, obstacles);
+        }
+    };
+    std::mutex mutex;
+    std::vector<double> times;
+    FleetPlanner planner(2, [&] { return std::unique_ptr<Planner>(new TimedPlanner(mutex, times)); });
+    EXPECT_EQ(planner.threads(), 2);
+    auto results = planner.plan(vessels, config, 0.9);
+    ASSERT_EQ(results.size(), 3);
+    // three vessels on two threads is two rounds, so each search gets half the time
+    ASSERT_EQ(times.size(), 3);
+    for (auto t : times) EXPECT_LE(t, 0.45 + 1e-9);
+    for (const auto& stats : results) EXPECT_FALSE(stats.Plan.empty());
+    // go again following those plans, so they're obstacles for each other
+    for (int i = 0; i < 3; i++) vessels[i].CurrentPlan = results[i].Plan;
+    results = planner.plan(vessels, config, 0.9);
+    for (const auto& stats : results) EXPECT_FALSE(stats.Plan.empty());
+}
+
 TEST(UnitTests, AngleConsistencyTest) {
     auto minAngleChange = 2 * (plannerConfig.collisionCheckingIncrement() / plannerConfig.turningRadius() + 1e-5); // arc length / radius + tolerance
     StateGenerator generator(-50, 50, -50, 50, plannerConfig.maxSpeed(), plannerConfig.maxSpeed(), 7);
@@ -1585,6 +2414,59 @@ TEST(PlannerTests, RandomPointsTest) {
     }
 }
 
+TEST(UnitTests, FootprintTest) {
+    // a wall between x = 20 and 21, all the way up
+    auto map = make_shared<GridWorldMap>(writeMap(1, vector<std::string>(60, std::string(20, '_') + "#" +
+                                                                              std::string(19, '_'))));
+    // clearance never claims more than there is to the wall or the edge of the map
+    for (double x = 0.25; x < 40; x += 0.5) {
+        for (double y = 0.25; y < 60; y += 0.5) {
+            auto distance = fmin(fmin(x, 40 - x), fmin(y, 60 - y));
+            distance = fmin(distance, x < 20? 20 - x : x >= 21? x - 21 : 0);
+            EXPECT_LE(map->clearance(x, y), distance);
+        }
+    }
+    EXPECT_GT(map->clearance(10, 30), 5);
+
+    Footprint point, boat(12, 4);
+    EXPECT_TRUE(point.isPoint());
+    EXPECT_FALSE(boat.isPoint());
+    // heading north alongside the wall fits, but not turned across it
+    EXPECT_FALSE(boat.blocked(*map, 17, 30, 0));
+    EXPECT_TRUE(boat.blocked(*map, 17, 30, M_PI_2));
+    EXPECT_FALSE(point.blocked(*map, 17, 30, M_PI_2));
+    EXPECT_TRUE(boat.blocked(*map, 19, 30, 0));
+    EXPECT_FALSE(boat.blocked(*map, 10, 30, M_PI_4));
+
+    // an edge running along the wall is clear for a point but not for the boat
+    PlannerConfig config(&std::cerr);
+    config.setMap(map);
+    config.setStartStateTime(1);
+    RibbonManager ribbonManager;
+    auto root = Vertex::makeRoot(State(19, 10, 0, config.maxSpeed(), 1), ribbonManager);
+    root->computeApproxToGo(config);
+    auto v = Vertex::connect(root, State(19, 45, 0, config.maxSpeed(), 0), config.turningRadius(), false);
+    v->parentEdge()->computeTrueCost(config);
+    EXPECT_FALSE(v->parentEdge()->infeasible());
+    config.setFootprint(boat);
+    auto w = Vertex::connect(root, State(19, 45, 0, config.maxSpeed(), 0), config.turningRadius(), false);
+    w->parentEdge()->computeTrueCost(config);
+    EXPECT_TRUE(w->parentEdge()->infeasible());
+
+    // and what's cached from checking it with a point doesn't count for the boat
+    auto cache = make_shared<CollisionCache>();
+    DubinsWrapper along(root->state(), State(19, 45, 0, config.maxSpeed(), 0), config.turningRadius());
+    config.setFootprint(point);
+    auto cachedPoint = Vertex::connect(root, along, false);
+    cachedPoint->parentEdge()->useCollisionCache(cache->get(along));
+    cachedPoint->parentEdge()->computeTrueCost(config);
+    EXPECT_FALSE(cachedPoint->parentEdge()->infeasible());
+    config.setFootprint(boat);
+    auto cachedBoat = Vertex::connect(root, along, false);
+    cachedBoat->parentEdge()->useCollisionCache(cache->get(along));
+    cachedBoat->parentEdge()->computeTrueCost(config);
+    EXPECT_TRUE(cachedBoat->parentEdge()->infeasible());
+}
 
 int main(int argc, char **argv){
     auto f = [] () -> double {
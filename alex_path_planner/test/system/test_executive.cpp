@@ -56,6 +56,82 @@ TEST(SystemTests, SimpleTwoLineTest) {
     EXPECT_TRUE(stub.allDoneCalled());
 }
 
+TEST(SystemTests, ContactIngestorTest) {
+    ContactIngestor ingestor;
+    State vessel(0, 0, 0, 2.5, 100);
+    // near, far, and stale
+    ingestor.report(1, State(100, 100, M_PI, 5, 99), 10, 30);
+    ingestor.report(2, State(100000, 0, 0, 5, 99), 10, 30);
+    ingestor.report(3, State(50, 50, 0, 0, 100 - ContactIngestor::c_StaleAge - 1), 10, 30);
+    // older report for 1 shouldn't replace the newer one
+    ingestor.report(1, State(5000, 5000, M_PI, 5, 90), 10, 30);
+    auto changes = ingestor.ingest(vessel, 2.5, 30);
+    ASSERT_EQ(changes.Updated.size(), 1);
+    EXPECT_EQ(changes.Updated[0].Mmsi, 1);
+    EXPECT_DOUBLE_EQ(changes.Updated[0].Report.x(), 100);
+    EXPECT_TRUE(changes.Forgotten.empty());
+    EXPECT_EQ(ingestor.tracked(), 2);
+    EXPECT_EQ(ingestor.relevant(), 1);
+    // no new reports means nothing to do
+    changes = ingestor.ingest(vessel, 2.5, 30);
+    EXPECT_TRUE(changes.Updated.empty());
+    EXPECT_TRUE(changes.Forgotten.empty());
+    // 1 goes stale and gets forgotten, 2 hasn't been passed on so there's nothing to forget
+    vessel = vessel.push(ContactIngestor::c_StaleAge);
+    changes = ingestor.ingest(vessel, 2.5, 30);
+    EXPECT_TRUE(changes.Updated.empty());
+    ASSERT_EQ(changes.Forgotten.size(), 1);
+    EXPECT_EQ(changes.Forgotten[0], 1);
+    EXPECT_EQ(ingestor.tracked(), 0);
+}
+
+TEST(SystemTests, RibbonTourTest) {
+    NodeStub stub;
+    auto executive = new Executive(&stub);
+    executive->setConfiguration(8, 16, 2.5, 0.5, 2, 9, 5, 30, 5, 0.05, 100, false, false, false, Executive::AStar);
+    executive->updateCovered(0, 0, 0, 0, Executive::getCurrentTime());
+    for (int i = 0; i < 4; i++) executive->addRibbon(10, 10 + i * 20, 100, 10 + i * 20);
+    // the tour thread may get in with a tour of the first few before they're all added, so wait for one of all four
+    RibbonTour::SharedPtr tour;
+    for (int i = 0; i < 30 && !((tour = executive->tour()) && tour->legs().size() == 4); i++)
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    ASSERT_TRUE(tour);
+    EXPECT_EQ(tour->legs().size(), 4);
+    // adding a ribbon gets a new tour
+    executive->addRibbon(10, 90, 100, 90);
+    for (int i = 0; i < 30 && executive->tour()->legs().size() != 5; i++)
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    EXPECT_EQ(executive->tour()->legs().size(), 5);
+    delete executive;
+}
+
+TEST(SystemTests, RealTimeProfileTest) {
+    EXPECT_EQ(RealTimeProfile::parseCpus("0,2-4"), (vector<int>{0, 2, 3, 4}));
+    EXPECT_TRUE(RealTimeProfile::parseCpus("").empty());
+    EXPECT_THROW(RealTimeProfile::parseCpus("two"), std::invalid_argument);
+    RealTimeProfile profile;
+    EXPECT_FALSE(profile.enabled());
+    // pin a thread to wherever it already is, which we're always allowed to do
+    std::thread([&] {
+        profile.Cpus = {sched_getcpu()};
+        EXPECT_TRUE(profile.enabled());
+        EXPECT_TRUE(profile.applyToThisThread(false, cerr));
+        EXPECT_EQ(sched_getcpu(), profile.Cpus.front());
+    }).join();
+
+    RealTimeProfile::JitterHistogram histogram;
+    for (int i = 0; i < 98; i++) histogram.record(0.001);
+    histogram.record(0.02);
+    histogram.record(0.5); // off the end
+    EXPECT_EQ(histogram.count(), 100);
+    EXPECT_NEAR(histogram.percentile(0.5), 0.001, 1e-9);
+    EXPECT_NEAR(histogram.percentile(0.99), 0.02, 1e-9);
+    EXPECT_NEAR(histogram.percentile(1), 0.05, 1e-9);
+    EXPECT_DOUBLE_EQ(histogram.max(), 0.5);
+    histogram.clear();
+    EXPECT_EQ(histogram.count(), 0);
+}
+
 int main(int argc, char **argv){
     testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
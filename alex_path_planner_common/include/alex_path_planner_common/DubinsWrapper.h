@@ -56,6 +56,75 @@ public:
      */
     void sample(State& s) const;
 
+    /**
+     * Sets the pose of the given state to be the point the given distance along this path. Unlike sample, this does not
+     * look at or change the state's time or speed, so it is useful for checks that don't depend on speed.
+     * @param distance distance along the path from its (original) start
+     * @param s
+     */
+    void sampleDistance(double distance, State& s) const;
+
+    /**
+     * Samples a path at evenly spaced distances. Stepping to the next sample along a straight is an addition and along
+     * an arc a rotation, which is a lot cheaper than sampleDistance doing the whole thing (trig and all) every time. It
+     * falls back on sampleDistance to start each segment, to jump around, and every so often in between so rounding
+     * doesn't build up.
+     */
+    class Sampler {
+    public:
+        /**
+         * @param wrapper the path, which has to outlive the sampler
+         * @param startDistance distance along the path of the first sample
+         * @param step distance between samples
+         */
+        Sampler(const DubinsWrapper& wrapper, double startDistance, double step);
+
+        /**
+         * @param i
+         * @return distance along the path of the i-th sample
+         */
+        double distance(unsigned long i) const { return m_StartDistance + (double)i * m_Step; }
+
+        /**
+         * Set the pose of the state to the i-th sample, like sampleDistance. This is cheapest when i goes up by one
+         * each time.
+         * @param i
+         * @param s
+         */
+        void sample(unsigned long i, State& s);
+
+    private:
+        const DubinsWrapper* m_Wrapper;
+        double m_StartDistance, m_Step;
+        // turn (radians) and rotation for one step along an arc, going left (going right rotates the other way)
+        double m_Turn, m_Cos, m_Sin;
+
+        // the last sample, or -1 if there hasn't been one
+        long m_Index = -1;
+        // where it was (x, y, yaw) and which segment it was on
+        double m_X = 0, m_Y = 0, m_Yaw = 0;
+        int m_Segment = 0;
+        // 1 if that segment turns left, -1 right, 0 straight, then the centre of the turn or one step along the straight
+        int m_Direction = 0;
+        double m_CentreX = 0, m_CentreY = 0, m_StepX = 0, m_StepY = 0;
+        // steps since the last exact sample
+        int m_Steps = 0;
+
+        /**
+         * Which segment a distance along the path is on, decided the same way the Dubins library does it.
+         * @param distance
+         * @return
+         */
+        int segment(double distance) const;
+
+        /**
+         * Sample the current index exactly.
+         */
+        void resync();
+
+        static constexpr int c_ResyncInterval = 100;
+    };
+
     /**
      * Get samples at a constant time interval, starting at the starting time for this path.
      * @param timeInterval
@@ -1,6 +1,8 @@
 #ifndef SRC_TRAJECTORYDISPLAYERUTILITIES_H
 #define SRC_TRAJECTORYDISPLAYERUTILITIES_H
 
+#include <memory>
+#include <mutex>
 #include <ros/ros.h>
 #include <geographic_msgs/GeoPoint.h>
 #include "State.h"
@@ -37,13 +39,21 @@ public:
 
     /**
      * Display a trajectory to /project11/display. Map coordinates are converted into lat/long with the map_to_wgs84
-     * service.
+     * service. The trajectory is simplified to within the tolerance first, and isn't sent again if it looks the same as
+     * last time (except every so often, for anyone who starts watching late).
      * @param trajectory the trajectory to display
      * @param plannerTrajectory flag determining color and id
      * @param achievable whether this trajectory is achievable
      */
     void displayTrajectory(const std::vector<State>& trajectory, bool plannerTrajectory, bool achievable);
 
+    /**
+     * Set how far (m) displayed trajectories can be from the real ones. Half a meter is too small to see at any zoom
+     * level the display is normally used at.
+     * @param tolerance
+     */
+    void setTolerance(double tolerance);
+
     /**
      * Get the current time.
      * @return the current time in seconds
@@ -51,11 +61,30 @@ public:
     virtual double getTime() const;;
 
     /**
-     * Converts a state (in map coordinates) to a GeoPoint (in LatLong).
+     * Converts a state (in map coordinates) to a GeoPoint (in LatLong). Virtual so tests can convert without a
+     * transform.
      * @param state
      * @return GeoPoint version of the state (LatLong)
      */
-    geographic_msgs::GeoPoint convertToLatLong(const State& state);
+    virtual geographic_msgs::GeoPoint convertToLatLong(const State& state);
+
+    /**
+     * Converts a bunch of states to LatLong at once. Rather than going through the transform for every point, this
+     * uses a linear approximation of it around a nearby point, which is off by well under a tenth of a meter within
+     * the kilometer it's used for.
+     * @param states
+     * @return GeoPoint versions of the states, in the same order
+     */
+    std::vector<geographic_msgs::GeoPoint> convertToLatLong(const std::vector<State>& states);
+
+    /**
+     * Douglas-Peucker simplification: drop points until dropping any more would take the line further than the
+     * tolerance from one of them.
+     * @param trajectory
+     * @param tolerance (m)
+     * @return the points that are left, in order. The first and last are always kept
+     */
+    static std::vector<State> simplify(const std::vector<State>& trajectory, double tolerance);
 
     /**
      * Converts a state to a ROS message.
@@ -75,6 +104,42 @@ protected:
     ros::Publisher* m_display_pub;
     project11::Transformations* m_transformations;
     std::string m_map_frame;
+
+private:
+    // the linear approximation convertToLatLong uses for batches: lat/long of an anchor point and how they change per
+    // meter of x and y from there
+    struct Linearization {
+        bool Valid = false;
+        double X = 0, Y = 0, Time = 0;
+        geographic_msgs::GeoPoint Anchor;
+        double LatitudePerX = 0, LatitudePerY = 0, LongitudePerX = 0, LongitudePerY = 0;
+    };
+
+    // what was last displayed for a trajectory id
+    struct Displayed {
+        std::vector<State> Points;
+        bool Achievable = true;
+        double Time = -1;
+    };
+
+    // state that has to survive this being copied (it's assigned after default construction) and be safe to use from
+    // the planning thread and the node's thread at once
+    struct Cache {
+        std::mutex Mutex;
+        Linearization Local;
+        // by whether it's the planner trajectory
+        Displayed Trajectories[2];
+        double Tolerance = 0.5;
+    };
+    std::shared_ptr<Cache> m_Cache = std::make_shared<Cache>();
+
+    // how far from the anchor the linear approximation is used (m), and how long before it's redone (s) in case the
+    // map frame moves
+    static constexpr double c_LinearizationRadius = 1000;
+    static constexpr double c_LinearizationLifetime = 10;
+
+    // how often (s) an unchanged trajectory is sent anyway
+    static constexpr double c_RefreshInterval = 5;
 };
 
 #endif //SRC_TRAJECTORYDISPLAYERUTILITIES_H
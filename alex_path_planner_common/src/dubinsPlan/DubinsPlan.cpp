@@ -35,9 +35,22 @@ std::vector<State> DubinsPlan::getHalfSecondSamples() const {
     std::vector<State> result;
     if (empty()) return result;
     State s;
-    for (double time = getStartTime(); time < getEndTime(); time += planTimeDensity()) {
-        s.time() = time;
-        sample(s);
+    auto startTime = getStartTime(), endTime = getEndTime();
+    auto path = m_DubinsPaths.begin();
+    DubinsWrapper::Sampler sampler(*path, 0, 0);
+    // first sample on the current path
+    unsigned long first = 0;
+    for (unsigned long i = 0; startTime + (double)i * planTimeDensity() < endTime; i++) {
+        s.time() = startTime + (double)i * planTimeDensity();
+        if (i == 0 || !path->containsTime(s.time())) {
+            while (path != m_DubinsPaths.end() && !path->containsTime(s.time())) path++;
+            if (path == m_DubinsPaths.end()) sample(s); // throws
+            first = i;
+            sampler = DubinsWrapper::Sampler(*path, (s.time() - path->getStartTime()) * path->getSpeed(),
+                                             planTimeDensity() * path->getSpeed());
+        }
+        sampler.sample(i - first, s);
+        s.speed() = path->getSpeed();
         result.push_back(s);
     }
     return result;
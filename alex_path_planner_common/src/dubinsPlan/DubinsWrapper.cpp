@@ -1,6 +1,19 @@
 #include <cassert>
 #include <alex_path_planner_common/DubinsWrapper.h>
 #include <sstream>
+#include <cmath>
+
+namespace {
+// which way each segment of each type of path turns: 1 left, -1 right, 0 straight
+const int c_Directions[6][3] = {
+        {1, 0, 1},   // LSL
+        {1, 0, -1},  // LSR
+        {-1, 0, 1},  // RSL
+        {-1, 0, -1}, // RSR
+        {-1, 1, -1}, // RLR
+        {1, -1, 1},  // LRL
+};
+}
 
 DubinsWrapper::DubinsWrapper(const State& s1, const State& s2, double rho) {
     set(s1, s2, rho);
@@ -33,7 +46,11 @@ void DubinsWrapper::sample(State& s) const {
             << std::to_string(getStartTime()) << " to " << std::to_string(getEndTime());
         throw std::runtime_error(stream.str());
     }
-    double distance = (s.time() - m_StartTime) * m_Speed;
+    sampleDistance((s.time() - m_StartTime) * m_Speed, s);
+    s.speed() = m_Speed; // take note of this
+}
+
+void DubinsWrapper::sampleDistance(double distance, State& s) const {
     // heading comes back as yaw
     int err = dubins_path_sample(&m_DubinsPath, distance, s.pose());
     if (err == EDUBPARAM) {
@@ -45,7 +62,6 @@ void DubinsWrapper::sample(State& s) const {
     }
     // set yaw with heading value to correct things
     s.setYaw(s.heading()); // TODO! -- change state to internally use yaw?
-    s.speed() = m_Speed; // take note of this
 }
 
 bool DubinsWrapper::isInitialized() const {
@@ -122,3 +138,67 @@ void DubinsWrapper::setSpeed(double speed) {
     m_Speed = speed;
     setEndTime();
 }
+
+constexpr int DubinsWrapper::Sampler::c_ResyncInterval;
+
+DubinsWrapper::Sampler::Sampler(const DubinsWrapper& wrapper, double startDistance, double step)
+    : m_Wrapper(&wrapper), m_StartDistance(startDistance), m_Step(step) {
+    auto rho = wrapper.getRho();
+    m_Turn = rho > 0? step / rho : 0;
+    m_Cos = cos(m_Turn);
+    m_Sin = sin(m_Turn);
+}
+
+void DubinsWrapper::Sampler::sample(unsigned long i, State& s) {
+    auto d = distance(i);
+    if (m_Index == -1 || (long)i != m_Index + 1 || segment(d) != m_Segment || ++m_Steps >= c_ResyncInterval) {
+        m_Index = (long)i;
+        resync();
+    } else {
+        m_Index = (long)i;
+        if (m_Direction == 0) {
+            m_X += m_StepX;
+            m_Y += m_StepY;
+        } else {
+            auto dx = m_X - m_CentreX, dy = m_Y - m_CentreY;
+            auto turnSin = m_Direction * m_Sin;
+            m_X = m_CentreX + dx * m_Cos - dy * turnSin;
+            m_Y = m_CentreY + dx * turnSin + dy * m_Cos;
+            m_Yaw += m_Direction * m_Turn;
+        }
+    }
+    s.x() = m_X;
+    s.y() = m_Y;
+    auto yaw = fmod(m_Yaw, 2 * M_PI);
+    if (yaw < 0) yaw += 2 * M_PI;
+    s.setYaw(yaw);
+}
+
+int DubinsWrapper::Sampler::segment(double distance) const {
+    const auto& path = m_Wrapper->unwrap();
+    auto t = distance / path.rho;
+    if (t < path.param[0]) return 0;
+    if (t < path.param[0] + path.param[1]) return 1;
+    return 2;
+}
+
+void DubinsWrapper::Sampler::resync() {
+    m_Steps = 0;
+    auto d = distance((unsigned long)m_Index);
+    const auto& path = m_Wrapper->unwrap();
+    double q[3];
+    // same as sampleDistance
+    int err = dubins_path_sample(&path, d, q);
+    if (err == EDUBPARAM) err = dubins_path_sample(&path, d - 1e-5, q);
+    if (err != EDUBOK) std::cerr << "Encountered error in dubins library" << std::endl;
+    m_X = q[0];
+    m_Y = q[1];
+    m_Yaw = q[2];
+    m_Segment = segment(d);
+    m_Direction = c_Directions[path.type][m_Segment];
+    m_StepX = m_Step * cos(m_Yaw);
+    m_StepY = m_Step * sin(m_Yaw);
+    // the centre is a turning radius off to the side we're turning towards
+    m_CentreX = m_X - m_Direction * path.rho * sin(m_Yaw);
+    m_CentreY = m_Y + m_Direction * path.rho * cos(m_Yaw);
+}
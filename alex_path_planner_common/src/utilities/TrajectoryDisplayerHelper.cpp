@@ -1,6 +1,10 @@
 #include <alex_path_planner_common/TrajectoryDisplayerHelper.h>
 #include <stdio.h> // debug output
 
+constexpr double TrajectoryDisplayerHelper::c_LinearizationRadius;
+constexpr double TrajectoryDisplayerHelper::c_LinearizationLifetime;
+constexpr double TrajectoryDisplayerHelper::c_RefreshInterval;
+
 TrajectoryDisplayerHelper::TrajectoryDisplayerHelper(ros::NodeHandle& nodeHandle, ros::Publisher* displayPub, project11::Transformations &transformations, const std::string & map_frame): m_transformations(&transformations), m_map_frame(map_frame)
 {
     m_display_pub = displayPub;
@@ -41,11 +45,28 @@ void TrajectoryDisplayerHelper::displayTrajectory(const std::vector<State>& traj
             displayPoints.color.r = 1;
         }
     }
-    for (const State& s : trajectory) {
-        // std::cerr << "DEBUG: TrajectoryDisplayerHelper::displayTrajectory() iterating through trajectory samples" << std::endl;
-        geographic_msgs::GeoPoint point;
-        displayPoints.points.push_back(convertToLatLong(s));
+    double tolerance;
+    {
+        std::lock_guard<std::mutex> lock(m_Cache->Mutex);
+        tolerance = m_Cache->Tolerance;
+    }
+    auto simplified = simplify(trajectory, tolerance);
+    auto now = getTime();
+    {
+        // skip it if it's the same as last time (give or take the tolerance) unless it's time for a refresh
+        std::lock_guard<std::mutex> lock(m_Cache->Mutex);
+        auto& displayed = m_Cache->Trajectories[plannerTrajectory? 1 : 0];
+        bool same = displayed.Time >= 0 && now - displayed.Time < c_RefreshInterval &&
+                displayed.Achievable == achievable && displayed.Points.size() == simplified.size();
+        for (size_t i = 0; same && i < simplified.size(); i++) {
+            same = simplified[i].distanceTo(displayed.Points[i]) <= tolerance;
+        }
+        if (same) return;
+        displayed.Points = simplified;
+        displayed.Achievable = achievable;
+        displayed.Time = now;
     }
+    displayPoints.points = convertToLatLong(simplified);
     geographic_visualization_msgs::GeoVizItem geoVizItem;
     if (plannerTrajectory) {
         geoVizItem.id = "planner_trajectory";
@@ -60,6 +81,11 @@ void TrajectoryDisplayerHelper::displayTrajectory(const std::vector<State>& traj
     // std::cerr << "DEBUG: TrajectoryDisplayerHelper::displayTrajectory() just published geoVizItem via m_display_pub" << std::endl;
 }
 
+void TrajectoryDisplayerHelper::setTolerance(double tolerance) {
+    std::lock_guard<std::mutex> lock(m_Cache->Mutex);
+    m_Cache->Tolerance = tolerance;
+}
+
 double TrajectoryDisplayerHelper::getTime() const {
     return ((double)ros::Time::now().toNSec()) / 1e9;
 }
@@ -75,6 +101,79 @@ geographic_msgs::GeoPoint TrajectoryDisplayerHelper::convertToLatLong(const Stat
     return m_transformations->map_to_wgs84(point, m_map_frame);
 }
 
+std::vector<geographic_msgs::GeoPoint> TrajectoryDisplayerHelper::convertToLatLong(const std::vector<State>& states) {
+    std::vector<geographic_msgs::GeoPoint> points;
+    if (states.empty()) return points;
+    points.reserve(states.size());
+    auto now = getTime();
+    std::lock_guard<std::mutex> lock(m_Cache->Mutex);
+    auto& local = m_Cache->Local;
+    for (const auto& s : states) {
+        auto dx = s.x() - local.X, dy = s.y() - local.Y;
+        if (!local.Valid || sqrt(dx * dx + dy * dy) > c_LinearizationRadius ||
+            now - local.Time > c_LinearizationLifetime) {
+            // re-anchor here, with a meter east and a meter north for the rates
+            local.Anchor = convertToLatLong(s);
+            auto east = convertToLatLong(State(s.x() + 1, s.y(), 0, 0, 0));
+            auto north = convertToLatLong(State(s.x(), s.y() + 1, 0, 0, 0));
+            local.LatitudePerX = east.latitude - local.Anchor.latitude;
+            local.LongitudePerX = east.longitude - local.Anchor.longitude;
+            local.LatitudePerY = north.latitude - local.Anchor.latitude;
+            local.LongitudePerY = north.longitude - local.Anchor.longitude;
+            local.X = s.x();
+            local.Y = s.y();
+            local.Time = now;
+            local.Valid = true;
+            dx = dy = 0;
+        }
+        auto point = local.Anchor;
+        point.latitude += local.LatitudePerX * dx + local.LatitudePerY * dy;
+        point.longitude += local.LongitudePerX * dx + local.LongitudePerY * dy;
+        points.push_back(point);
+    }
+    return points;
+}
+
+std::vector<State> TrajectoryDisplayerHelper::simplify(const std::vector<State>& trajectory, double tolerance) {
+    if (trajectory.size() <= 2 || tolerance <= 0) return trajectory;
+    std::vector<bool> keep(trajectory.size(), false);
+    keep.front() = keep.back() = true;
+    // spans still to check, between two points that are being kept
+    std::vector<std::pair<size_t, size_t>> spans{{0, trajectory.size() - 1}};
+    while (!spans.empty()) {
+        auto span = spans.back();
+        spans.pop_back();
+        const auto& a = trajectory[span.first];
+        const auto& b = trajectory[span.second];
+        auto dx = b.x() - a.x(), dy = b.y() - a.y();
+        auto lengthSquared = dx * dx + dy * dy;
+        double worst = 0;
+        size_t worstIndex = span.first;
+        for (auto i = span.first + 1; i < span.second; i++) {
+            const auto& p = trajectory[i];
+            // distance to the segment rather than the line through it, since trajectories can double back
+            auto t = lengthSquared > 0? ((p.x() - a.x()) * dx + (p.y() - a.y()) * dy) / lengthSquared : 0;
+            t = fmin(fmax(t, 0), 1);
+            auto ex = a.x() + t * dx - p.x(), ey = a.y() + t * dy - p.y();
+            auto distance = sqrt(ex * ex + ey * ey);
+            if (distance > worst) {
+                worst = distance;
+                worstIndex = i;
+            }
+        }
+        if (worst > tolerance) {
+            keep[worstIndex] = true;
+            spans.emplace_back(span.first, worstIndex);
+            spans.emplace_back(worstIndex, span.second);
+        }
+    }
+    std::vector<State> simplified;
+    for (size_t i = 0; i < trajectory.size(); i++) {
+        if (keep[i]) simplified.push_back(trajectory[i]);
+    }
+    return simplified;
+}
+
 alex_path_planner_common::StateMsg TrajectoryDisplayerHelper::convertToStateMsg(const State& state) {
     if (!m_display_pub) throw std::runtime_error("Trajectory displayer not properly initialized");
     alex_path_planner_common::StateMsg stateMsg;
@@ -0,0 +1,110 @@
+#include <gtest/gtest.h>
+#include <alex_path_planner_common/TrajectoryDisplayerHelper.h>
+
+using std::vector;
+
+/**
+ * Displayer that converts with an exact spherical projection around a point off the coast of New Hampshire instead of
+ * going through the transform, and never lets time pass.
+ */
+class SphericalDisplayerHelper : public TrajectoryDisplayerHelper {
+public:
+    using TrajectoryDisplayerHelper::convertToLatLong;
+
+    geographic_msgs::GeoPoint convertToLatLong(const State& state) override {
+        geographic_msgs::GeoPoint point;
+        point.latitude = c_Latitude + state.y() / c_EarthRadius * 180 / M_PI;
+        point.longitude = c_Longitude +
+                state.x() / (c_EarthRadius * cos(point.latitude * M_PI / 180)) * 180 / M_PI;
+        return point;
+    }
+
+    double getTime() const override {
+        return 0;
+    }
+
+    /**
+     * @return how far apart two points are (m), near enough for points close together
+     */
+    static double distance(const geographic_msgs::GeoPoint& a, const geographic_msgs::GeoPoint& b) {
+        auto north = (a.latitude - b.latitude) * M_PI / 180 * c_EarthRadius;
+        auto east = (a.longitude - b.longitude) * M_PI / 180 * c_EarthRadius * cos(a.latitude * M_PI / 180);
+        return sqrt(north * north + east * east);
+    }
+
+    static constexpr double c_EarthRadius = 6371000, c_Latitude = 43.07, c_Longitude = -70.71;
+};
+
+constexpr double SphericalDisplayerHelper::c_EarthRadius;
+constexpr double SphericalDisplayerHelper::c_Latitude;
+constexpr double SphericalDisplayerHelper::c_Longitude;
+
+/**
+ * @return how far a point is from the closest segment of a line
+ */
+double distanceToLine(const State& p, const vector<State>& line) {
+    auto best = p.distanceTo(line.front());
+    for (size_t i = 1; i < line.size(); i++) {
+        const auto& a = line[i - 1];
+        const auto& b = line[i];
+        auto dx = b.x() - a.x(), dy = b.y() - a.y();
+        auto lengthSquared = dx * dx + dy * dy;
+        auto t = lengthSquared > 0? ((p.x() - a.x()) * dx + (p.y() - a.y()) * dy) / lengthSquared : 0;
+        t = fmin(fmax(t, 0), 1);
+        best = fmin(best, State(a.x() + t * dx, a.y() + t * dy, 0, 0, 0).distanceTo(p));
+    }
+    return best;
+}
+
+TEST(UnitTests, SimplifyStraightLineTest) {
+    vector<State> line;
+    for (int i = 0; i <= 100; i++) line.emplace_back(i * 0.5, i * 0.25, 0, 0, i);
+    auto simplified = TrajectoryDisplayerHelper::simplify(line, 0.5);
+    ASSERT_EQ(simplified.size(), 2);
+    EXPECT_EQ(simplified.front().time(), line.front().time());
+    EXPECT_EQ(simplified.back().time(), line.back().time());
+    // no tolerance means nothing's dropped
+    EXPECT_EQ(TrajectoryDisplayerHelper::simplify(line, 0).size(), line.size());
+}
+
+TEST(UnitTests, SimplifyToleranceTest) {
+    // a turn of radius 20 sampled every quarter meter, then a straight
+    vector<State> trajectory;
+    for (double a = 0; a < M_PI; a += 0.25 / 20) trajectory.emplace_back(20 * cos(a), 20 * sin(a), 0, 0, a);
+    for (int i = 1; i <= 40; i++) trajectory.emplace_back(-20, -i, 0, 0, M_PI + i);
+    for (auto tolerance : {0.1, 0.5, 2.0}) {
+        auto simplified = TrajectoryDisplayerHelper::simplify(trajectory, tolerance);
+        EXPECT_LT(simplified.size(), trajectory.size());
+        EXPECT_EQ(simplified.front().time(), trajectory.front().time());
+        EXPECT_EQ(simplified.back().time(), trajectory.back().time());
+        for (const auto& s : trajectory) EXPECT_LE(distanceToLine(s, simplified), tolerance);
+    }
+}
+
+TEST(UnitTests, SimplifyDoublingBackTest) {
+    // out ten meters and halfway back, where the far end is on the line through the ends but not between them
+    vector<State> trajectory;
+    for (int i = 0; i <= 10; i++) trajectory.emplace_back(0, i, 0, 0, i);
+    for (int i = 9; i >= 5; i--) trajectory.emplace_back(0, i, 0, 0, 20 - i);
+    auto simplified = TrajectoryDisplayerHelper::simplify(trajectory, 0.5);
+    ASSERT_EQ(simplified.size(), 3);
+    EXPECT_DOUBLE_EQ(simplified[1].y(), 10);
+}
+
+TEST(UnitTests, BatchConversionTest) {
+    // a few kilometers, so the linear approximation is re-anchored along the way
+    SphericalDisplayerHelper displayer;
+    vector<State> states;
+    for (int i = 0; i < 500; i++) states.emplace_back(i * 5.0, i * 3.0, 0, 0, 0);
+    for (int i = 0; i < 500; i++) states.emplace_back(2500 - i * 4.0, 1500 + i * 2.0, 0, 0, 0);
+    auto points = displayer.convertToLatLong(states);
+    ASSERT_EQ(points.size(), states.size());
+    for (size_t i = 0; i < states.size(); i++) {
+        EXPECT_LT(SphericalDisplayerHelper::distance(points[i], displayer.convertToLatLong(states[i])), 0.1);
+    }
+}
+
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}